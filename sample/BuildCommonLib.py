@@ -28,6 +28,7 @@ env.Append(LIBPATH=[lib_path])
 common_sources = [
     join(COMMON_DIR, 'MatViewer.cpp'),
     join(COMMON_DIR, 'TYThread.cpp'),
+    join(COMMON_DIR, 'TYWorkerPool.cpp'),
     join(COMMON_DIR, 'crc32.cpp'),
     join(COMMON_DIR, 'json11.cpp'),
     join(COMMON_DIR, 'ParametersParse.cpp'),
@@ -35,6 +36,14 @@ common_sources = [
     join(COMMON_DIR, 'ImageSpeckleFilter.cpp'),
     join(COMMON_DIR, 'DepthInpainter.cpp'),
     join(COMMON_DIR, 'funny_resize.cpp'),
+    join(COMMON_DIR, 'funny_yuv.cpp'),
+    join(COMMON_DIR, 'TYColorStage.cpp'),
+    join(COMMON_DIR, 'funny_jpeg.cpp'),
+    join(COMMON_DIR, 'funny_csi.cpp'),
+    join(COMMON_DIR, 'funny_bayer.cpp'),
+    join(COMMON_DIR, 'TYHdrStage.cpp'),
+    join(COMMON_DIR, 'TYImageStats.cpp'),
+    join(COMMON_DIR, 'TYAutoExposure.cpp'),
 ]
 
 # 确保所有源文件存在
@@ -0,0 +1,252 @@
+#include "TYAutoExposure.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+// 白平衡统计只用平均亮度在此范围内的区域
+static const float kWbLumaMin = 32.f;
+static const float kWbLumaMax = 224.f;
+
+TYAutoExposure::TYAutoExposure()
+  : _handle(nullptr), _comp(TY_COMPONENT_RGB_CAM), _countdown(0), _measured(0.f)
+  , _host_r(1.f), _host_b(1.f)
+{
+}
+
+bool TYAutoExposure::probe(Control& c, TY_FEATURE_ID id)
+{
+  c = Control();
+  bool has = false;
+  if (TYHasFeature(_handle, _comp, id, &has) != TY_STATUS_OK || !has) {
+    return false;
+  }
+  c.id = id;
+  c.is_float = (TYFeatureType(id) == TY_FEATURE_FLOAT);
+  if (c.is_float) {
+    TY_FLOAT_RANGE range;
+    float v = 0.f;
+    if (TYGetFloatRange(_handle, _comp, id, &range) != TY_STATUS_OK ||
+        TYGetFloat(_handle, _comp, id, &v) != TY_STATUS_OK) {
+      return false;
+    }
+    c.min = range.min;
+    c.max = range.max;
+    c.value = v;
+  } else {
+    TY_INT_RANGE range;
+    int32_t v = 0;
+    if (TYGetIntRange(_handle, _comp, id, &range) != TY_STATUS_OK ||
+        TYGetInt(_handle, _comp, id, &v) != TY_STATUS_OK) {
+      return false;
+    }
+    c.min = range.min;
+    c.max = range.max;
+    c.value = v;
+  }
+  c.valid = c.max > c.min;
+  return c.valid;
+}
+
+TY_STATUS TYAutoExposure::store(Control& c, double value)
+{
+  value = std::min(std::max(value, c.min), c.max);
+  TY_STATUS status;
+  if (c.is_float) {
+    status = TYSetFloat(_handle, _comp, c.id, static_cast<float>(value));
+  } else {
+    value = std::floor(value + 0.5);
+    status = TYSetInt(_handle, _comp, c.id, static_cast<int32_t>(value));
+  }
+  if (status == TY_STATUS_OK) {
+    c.value = value;
+  }
+  return status;
+}
+
+void TYAutoExposure::disableAuto(TY_FEATURE_ID id)
+{
+  bool has = false;
+  if (TYHasFeature(_handle, _comp, id, &has) == TY_STATUS_OK && has) {
+    TYSetBool(_handle, _comp, id, false);
+  }
+}
+
+TY_STATUS TYAutoExposure::attach(TY_DEV_HANDLE handle, TY_COMPONENT_ID comp)
+{
+  if (!handle) {
+    return TY_STATUS_INVALID_HANDLE;
+  }
+  _handle = handle;
+  _comp = comp;
+
+  if (!probe(_exposure, TY_INT_EXPOSURE_TIME)) {
+    probe(_exposure, TY_FLOAT_EXPOSURE_TIME_US);
+  }
+  if (!probe(_gain, TY_INT_GAIN)) {
+    probe(_gain, TY_INT_ANALOG_GAIN);
+  }
+  probe(_wb[0], TY_INT_R_GAIN);
+  probe(_wb[1], TY_INT_G_GAIN);
+  probe(_wb[2], TY_INT_B_GAIN);
+  if (!_exposure.valid && !_gain.valid) {
+    _handle = nullptr;
+    return TY_STATUS_INVALID_FEATURE;
+  }
+
+  if (_options.auto_exposure) {
+    disableAuto(TY_BOOL_AUTO_EXPOSURE);
+  }
+  if (_options.auto_gain) {
+    disableAuto(TY_BOOL_AUTO_GAIN);
+  }
+  if (_options.auto_white_balance && _wb[0].valid && _wb[2].valid) {
+    disableAuto(TY_BOOL_AUTO_AWB);
+  }
+  _countdown = 0;
+  _host_r = _host_b = 1.f;
+  return TY_STATUS_OK;
+}
+
+bool TYAutoExposure::updateExposure()
+{
+  // 中间区域(中心落在图像中间一半范围内)加权的平均亮度
+  const int nx = _stats.zonesX();
+  const int ny = _stats.zonesY();
+  double lsum = 0, wsum = 0;
+  for (int zy = 0; zy < ny; zy++) {
+    for (int zx = 0; zx < nx; zx++) {
+      const TYImageStats::Zone& z = _stats.zone(zx, zy);
+      if (z.count == 0) {
+        continue;
+      }
+      bool center = 4 * (2 * zx + 1) >= 2 * nx && 4 * (2 * zx + 1) <= 6 * nx &&
+                    4 * (2 * zy + 1) >= 2 * ny && 4 * (2 * zy + 1) <= 6 * ny;
+      double w = center ? _options.center_weight : 1.0;
+      lsum += w * z.luma / z.count;
+      wsum += w;
+    }
+  }
+  if (wsum <= 0) {
+    return false;
+  }
+  _measured = static_cast<float>(lsum / wsum);
+
+  const bool use_exp = _options.auto_exposure && _exposure.valid;
+  const bool use_gain = _options.auto_gain && _gain.valid;
+  if (!use_exp && !use_gain) {
+    return false;
+  }
+
+  double ratio = _options.target / std::max(_measured, 1.f);
+  const float clipped = _stats.clippedRatio();
+  if (clipped > _options.highlight) {
+    ratio = std::min(ratio, 1.0);
+  }
+  if (std::fabs(std::log(ratio)) < std::log(1.0 + _options.tolerance)) {
+    return false;
+  }
+  ratio = std::pow(ratio, std::min(std::max(_options.damping, 0.05f), 1.f));
+
+  // 总曝光量 = 曝光时间 * 增益倍数，增益按与数值成正比处理
+  const double gain_base = use_gain ? std::max(_gain.min, 1.0) : 1.0;
+  const double exp_now = use_exp ? std::max(_exposure.value, 1e-3) : 1.0;
+  const double gain_now = use_gain ? std::max(_gain.value, gain_base) : gain_base;
+  const double total = exp_now * gain_now / gain_base * ratio;
+
+  double exp_new = use_exp ? std::min(std::max(total, _exposure.min), _exposure.max) : exp_now;
+  double gain_new = use_gain ? gain_base * total / exp_new : gain_now;
+
+  bool changed = false;
+  if (use_exp) {
+    double before = _exposure.value;
+    if (store(_exposure, exp_new) == TY_STATUS_OK && _exposure.value != before) {
+      changed = true;
+    }
+  }
+  if (use_gain) {
+    double before = _gain.value;
+    if (store(_gain, gain_new) == TY_STATUS_OK && _gain.value != before) {
+      changed = true;
+    }
+  }
+  return changed;
+}
+
+bool TYAutoExposure::updateWhiteBalance()
+{
+  double sum[3] = { 0, 0, 0 };
+  for (int zy = 0; zy < _stats.zonesY(); zy++) {
+    for (int zx = 0; zx < _stats.zonesX(); zx++) {
+      const TYImageStats::Zone& z = _stats.zone(zx, zy);
+      if (z.count == 0 || z.clipped * 20 > z.count) {
+        continue;
+      }
+      float luma = static_cast<float>(z.luma) / z.count;
+      if (luma < kWbLumaMin || luma > kWbLumaMax) {
+        continue;
+      }
+      for (int c = 0; c < 3; c++) {
+        sum[c] += static_cast<double>(z.sum[c]) / z.count;
+      }
+    }
+  }
+  if (sum[0] <= 0 || sum[1] <= 0 || sum[2] <= 0) {
+    return false;
+  }
+
+  const double rg = sum[1] / sum[2];
+  const double bg = sum[1] / sum[0];
+  const double tol = std::log(1.0 + _options.tolerance);
+  const double damping = std::min(std::max(_options.damping, 0.05f), 1.f);
+
+  if (_wb[0].valid && _wb[2].valid) {
+    // 测量值已包含设备端增益，按比例修正
+    bool changed = false;
+    Control* ctl[2] = { &_wb[0], &_wb[2] };
+    const double err[2] = { rg, bg };
+    for (int i = 0; i < 2; i++) {
+      if (std::fabs(std::log(err[i])) < tol) {
+        continue;
+      }
+      double before = ctl[i]->value;
+      double next = std::max(before, 1.0) * std::pow(err[i], damping);
+      if (store(*ctl[i], next) == TY_STATUS_OK && ctl[i]->value != before) {
+        changed = true;
+      }
+    }
+    return changed;
+  }
+
+  // 主机端增益由未经增益的原始数据直接估计
+  _host_r = static_cast<float>(_host_r * std::pow(rg / _host_r, damping));
+  _host_b = static_cast<float>(_host_b * std::pow(bg / _host_b, damping));
+  return false;
+}
+
+TY_STATUS TYAutoExposure::update(const TY_IMAGE_DATA& frame, bool* changed)
+{
+  if (changed) {
+    *changed = false;
+  }
+  if (!_handle) {
+    return TY_STATUS_NOT_INITED;
+  }
+  if (_countdown > 0) {
+    _countdown--;
+    return TY_STATUS_OK;
+  }
+
+  TY_STATUS status = _stats.compute(frame);
+  if (status != TY_STATUS_OK) {
+    return status;
+  }
+  bool c = updateExposure();
+  if (_options.auto_white_balance && updateWhiteBalance()) {
+    c = true;
+  }
+  _countdown = std::max(0, _options.interval - 1);
+  if (changed) {
+    *changed = c;
+  }
+  return TY_STATUS_OK;
+}
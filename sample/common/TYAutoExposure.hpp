@@ -0,0 +1,93 @@
+#ifndef XYZ_TYAutoExposure_HPP_
+#define XYZ_TYAutoExposure_HPP_
+
+#include "TYApi.h"
+#include "TYImageStats.hpp"
+
+// 主机端自动曝光/增益/白平衡闭环：每interval帧用TYImageStats统计一次，
+// 在对数域按目标亮度计算总曝光量(曝光时间 * 增益)的修正倍数，乘damping后写回设备
+// 优先调整曝光时间，曝光时间到达上限后才提高增益，降低时先降增益
+// 修正倍数由测量值直接算出(不是固定步长)，一般3~5次更新即可收敛
+// 白平衡按灰色世界假设，只用亮度适中且没有饱和的区域；设备没有R/G/B增益时只计算主机端增益，
+// 可填入FunnyBayerOptions的gain_r/gain_g/gain_b
+class TYAutoExposure
+{
+public:
+  struct Options {
+    float target;           // 目标平均亮度(8位)
+    float tolerance;        // 亮度相对偏差小于该值时不调整
+    float damping;          // 0~1，每次修正对数域误差的比例，1为一步到位
+    int   interval;         // 每interval帧更新一次，应大于参数生效的延迟帧数，否则会来回振荡
+    float highlight;        // 饱和采样点比例超过该值时不再提高曝光
+    float center_weight;    // 中间区域的权重(四周区域为1)
+    bool  auto_exposure;
+    bool  auto_gain;
+    bool  auto_white_balance;
+
+    Options()
+      : target(110.f), tolerance(0.06f), damping(0.8f), interval(2), highlight(0.02f)
+      , center_weight(2.f), auto_exposure(true), auto_gain(true), auto_white_balance(true) {}
+  };
+
+  TYAutoExposure();
+
+  void setOptions(const Options& options) { _options = options; }
+  const Options& options() const { return _options; }
+  // 统计参数，见TYImageStats::configure
+  void configureStats(int zones_x, int zones_y, int step = 0) { _stats.configure(zones_x, zones_y, step); }
+
+  // 查询组件的曝光时间(TY_INT_EXPOSURE_TIME或TY_FLOAT_EXPOSURE_TIME_US)、增益(TY_INT_GAIN或TY_INT_ANALOG_GAIN)
+  // 和R/G/B增益的范围及当前值，并关闭设备端对应的自动控制
+  // 设备不支持曝光时间也不支持增益时返回TY_STATUS_INVALID_FEATURE
+  TY_STATUS attach(TY_DEV_HANDLE handle, TY_COMPONENT_ID comp = TY_COMPONENT_RGB_CAM);
+
+  // 每收到一帧调用一次；changed非空时返回本次是否写入了新参数
+  TY_STATUS update(const TY_IMAGE_DATA& frame, bool* changed = nullptr);
+
+  // 最近一次统计结果
+  const TYImageStats& stats() const { return _stats; }
+  // 最近一次统计的加权平均亮度
+  float measured() const { return _measured; }
+
+  double exposure() const { return _exposure.value; }
+  double gain() const { return _gain.value; }
+  // 设备不支持R/G/B增益时的主机端白平衡增益，G固定为1
+  float hostGainR() const { return _host_r; }
+  float hostGainG() const { return 1.f; }
+  float hostGainB() const { return _host_b; }
+
+private:
+  // 一个可调的设备参数
+  struct Control {
+    TY_FEATURE_ID id;
+    bool          valid;
+    bool          is_float;
+    double        min;
+    double        max;
+    double        value;
+
+    Control() : id(0), valid(false), is_float(false), min(0), max(0), value(0) {}
+  };
+
+  bool probe(Control& c, TY_FEATURE_ID id);
+  TY_STATUS store(Control& c, double value);
+  void disableAuto(TY_FEATURE_ID id);
+
+  bool updateExposure();
+  bool updateWhiteBalance();
+
+  TY_DEV_HANDLE   _handle;
+  TY_COMPONENT_ID _comp;
+  Options         _options;
+  TYImageStats    _stats;
+  int             _countdown;
+  float           _measured;
+
+  Control         _exposure;
+  Control         _gain;
+  Control         _wb[3];       // R/G/B增益
+  float           _host_r;
+  float           _host_b;
+};
+
+#endif
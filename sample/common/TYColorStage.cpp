@@ -0,0 +1,224 @@
+#include "TYColorStage.hpp"
+#include "TYWorkerPool.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+static const int kFracBits = 5;
+static const int kFracOne  = 1 << kFracBits;
+
+TYColorStage::TYColorStage()
+  : _has_calib(false), _dst_w(0), _dst_h(0), _linear(true)
+  , _map_src_w(0), _map_src_h(0)
+{
+  memset(&_calib, 0, sizeof(_calib));
+}
+
+void TYColorStage::configure(const TY_CAMERA_CALIB_INFO* calib, int dst_w, int dst_h, bool linear)
+{
+  // 参数不变时保留查找表，调用方可以每帧调用
+  if (_has_calib == (calib != nullptr) && (!calib || memcmp(&_calib, calib, sizeof(_calib)) == 0) &&
+      _dst_w == dst_w && _dst_h == dst_h && _linear == linear) {
+    return;
+  }
+  _has_calib = (calib != nullptr);
+  if (calib) {
+    _calib = *calib;
+  }
+  _dst_w = dst_w;
+  _dst_h = dst_h;
+  _linear = linear;
+  // 强制在下一帧重新生成查找表
+  _map_src_w = 0;
+  _map_src_h = 0;
+  _map.clear();
+}
+
+bool TYColorStage::supports(TY_PIXEL_FORMAT format)
+{
+  return format == TY_PIXEL_FORMAT_YUYV || format == TY_PIXEL_FORMAT_YVYU ||
+         format == TY_PIXEL_FORMAT_RGB  || format == TY_PIXEL_FORMAT_BGR;
+}
+
+bool TYColorStage::intrinsic(TY_CAMERA_INTRINSIC& out) const
+{
+  if (!_has_calib || _calib.intrinsicWidth <= 0 || _calib.intrinsicHeight <= 0) {
+    return false;
+  }
+  float sx = static_cast<float>(_dst_w) / _calib.intrinsicWidth;
+  float sy = static_cast<float>(_dst_h) / _calib.intrinsicHeight;
+  out = _calib.intrinsic;
+  out.data[0] *= sx;
+  out.data[2] *= sx;
+  out.data[4] *= sy;
+  out.data[5] *= sy;
+  return true;
+}
+
+void TYColorStage::buildMap(int src_w, int src_h)
+{
+  _map.resize(static_cast<size_t>(_dst_w) * _dst_h);
+  _map_src_w = src_w;
+  _map_src_h = src_h;
+
+  // 源图与输出图的内参都由标定尺寸按比例缩放得到
+  double fxs = 0, fys = 0, cxs = 0, cys = 0, fxd = 1, fyd = 1, cxd = 0, cyd = 0;
+  const float* k = _calib.distortion.data;
+  bool undistort = _has_calib && _calib.intrinsicWidth > 0 && _calib.intrinsicHeight > 0;
+  if (undistort) {
+    const float* K = _calib.intrinsic.data;
+    double ssx = static_cast<double>(src_w) / _calib.intrinsicWidth;
+    double ssy = static_cast<double>(src_h) / _calib.intrinsicHeight;
+    double dsx = static_cast<double>(_dst_w) / _calib.intrinsicWidth;
+    double dsy = static_cast<double>(_dst_h) / _calib.intrinsicHeight;
+    fxs = K[0] * ssx; cxs = K[2] * ssx; fys = K[4] * ssy; cys = K[5] * ssy;
+    fxd = K[0] * dsx; cxd = K[2] * dsx; fyd = K[4] * dsy; cyd = K[5] * dsy;
+  }
+
+  for (int v = 0; v < _dst_h; v++) {
+    for (int u = 0; u < _dst_w; u++) {
+      double sx, sy;
+      if (undistort) {
+        // 畸变模型与OpenCV一致：k1,k2,p1,p2,k3,k4,k5,k6,s1,s2,s3,s4
+        double x = (u - cxd) / fxd;
+        double y = (v - cyd) / fyd;
+        double r2 = x * x + y * y;
+        double r4 = r2 * r2;
+        double r6 = r4 * r2;
+        double radial = (1 + k[0] * r2 + k[1] * r4 + k[4] * r6) / (1 + k[5] * r2 + k[6] * r4 + k[7] * r6);
+        double xd = x * radial + 2 * k[2] * x * y + k[3] * (r2 + 2 * x * x) + k[8] * r2 + k[9] * r4;
+        double yd = y * radial + k[2] * (r2 + 2 * y * y) + 2 * k[3] * x * y + k[10] * r2 + k[11] * r4;
+        sx = fxs * xd + cxs;
+        sy = fys * yd + cys;
+      } else {
+        // 像素中心对齐的缩放
+        sx = std::min(std::max((u + 0.5) * src_w / _dst_w - 0.5, 0.0), src_w - 1.0);
+        sy = std::min(std::max((v + 0.5) * src_h / _dst_h - 0.5, 0.0), src_h - 1.0);
+      }
+
+      Tap& t = _map[static_cast<size_t>(v) * _dst_w + u];
+      if (!(sx >= 0 && sy >= 0 && sx <= src_w - 1 && sy <= src_h - 1)) {
+        t.x = -1;
+        t.y = 0;
+        t.w = 0;
+        continue;
+      }
+      if (!_linear) {
+        t.x = static_cast<int16_t>(std::lround(sx));
+        t.y = static_cast<int16_t>(std::lround(sy));
+        t.w = 0;
+        continue;
+      }
+      int ix = static_cast<int>(sx);
+      int iy = static_cast<int>(sy);
+      int fx = static_cast<int>(std::lround((sx - ix) * kFracOne));
+      int fy = static_cast<int>(std::lround((sy - iy) * kFracOne));
+      if (fx == kFracOne) { ix++; fx = 0; }
+      if (fy == kFracOne) { iy++; fy = 0; }
+      t.x = static_cast<int16_t>(ix);
+      t.y = static_cast<int16_t>(iy);
+      t.w = static_cast<uint16_t>((fy << kFracBits) | fx);
+    }
+  }
+}
+
+static inline uint8_t clampU8(int v)
+{
+  return static_cast<uint8_t>(v < 0 ? 0 : (v > 255 ? 255 : v));
+}
+
+void TYColorStage::processRows(const TY_IMAGE_DATA& src, uint8_t* dst, int begin, int end) const
+{
+  const uint8_t* base = static_cast<const uint8_t*>(src.buffer);
+  const int sw = src.width;
+  const int sh = src.height;
+  const bool yuv = (src.pixelFormat == TY_PIXEL_FORMAT_YUYV || src.pixelFormat == TY_PIXEL_FORMAT_YVYU);
+  const int stride = sw * (yuv ? 2 : 3);
+
+  // YUV：c0/c1为宏像素中第一个/第二个色度字节，系数与funny_yuv一致
+  const bool yvyu = (src.pixelFormat == TY_PIXEL_FORMAT_YVYU);
+  const int r0 = yvyu ? 409 : 0,    r1 = yvyu ? 0 : 409;
+  const int g0 = yvyu ? -208 : -100, g1 = yvyu ? -100 : -208;
+  const int b0 = yvyu ? 0 : 516,    b1 = yvyu ? 516 : 0;
+  // RGB/BGR：输出BGR时各通道的源偏移
+  const int ob = (src.pixelFormat == TY_PIXEL_FORMAT_RGB) ? 2 : 0;
+  const int orr = 2 - ob;
+
+  for (int v = begin; v < end; v++) {
+    const Tap* tap = &_map[static_cast<size_t>(v) * _dst_w];
+    uint8_t* d = dst + static_cast<size_t>(v) * _dst_w * 3;
+    for (int u = 0; u < _dst_w; u++, d += 3) {
+      const Tap& t = tap[u];
+      if (t.x < 0) {
+        d[0] = d[1] = d[2] = 0;
+        continue;
+      }
+
+      // 双线性权重(Q10)；最近邻时权重全部落在左上角
+      int fx = t.w & (kFracOne - 1);
+      int fy = t.w >> kFracBits;
+      int w00 = (kFracOne - fx) * (kFracOne - fy);
+      int w01 = fx * (kFracOne - fy);
+      int w10 = (kFracOne - fx) * fy;
+      int w11 = fx * fy;
+      int x0 = t.x, x1 = t.x + (t.x < sw - 1);
+      const uint8_t* row0 = base + static_cast<size_t>(t.y) * stride;
+      const uint8_t* row1 = base + static_cast<size_t>(t.y + (t.y < sh - 1)) * stride;
+
+      if (yuv) {
+        int p0 = (x0 >> 1) * 4, p1 = (x1 >> 1) * 4;
+        int Y  = row0[x0 * 2] * w00 + row0[x1 * 2] * w01 + row1[x0 * 2] * w10 + row1[x1 * 2] * w11;
+        int c0 = row0[p0 + 1] * w00 + row0[p1 + 1] * w01 + row1[p0 + 1] * w10 + row1[p1 + 1] * w11;
+        // 宽度为奇数时，行末像素缺少的第二个色度分量取128
+        int c1 = (p0 + 3 < stride ? row0[p0 + 3] * w00 + row1[p0 + 3] * w10 : 128 * (w00 + w10))
+               + (p1 + 3 < stride ? row0[p1 + 3] * w01 + row1[p1 + 3] * w11 : 128 * (w01 + w11));
+        int yy = 298 * (Y - (16 << 10)) + (128 << 10);
+        c0 -= 128 << 10;
+        c1 -= 128 << 10;
+        d[0] = clampU8((yy + b0 * c0 + b1 * c1) >> 18);
+        d[1] = clampU8((yy + g0 * c0 + g1 * c1) >> 18);
+        d[2] = clampU8((yy + r0 * c0 + r1 * c1) >> 18);
+      } else {
+        const uint8_t* a = row0 + x0 * 3;
+        const uint8_t* b = row0 + x1 * 3;
+        const uint8_t* c = row1 + x0 * 3;
+        const uint8_t* e = row1 + x1 * 3;
+        d[0] = static_cast<uint8_t>((a[ob] * w00 + b[ob] * w01 + c[ob] * w10 + e[ob] * w11 + 512) >> 10);
+        d[1] = static_cast<uint8_t>((a[1] * w00 + b[1] * w01 + c[1] * w10 + e[1] * w11 + 512) >> 10);
+        d[2] = static_cast<uint8_t>((a[orr] * w00 + b[orr] * w01 + c[orr] * w10 + e[orr] * w11 + 512) >> 10);
+      }
+    }
+  }
+}
+
+TY_STATUS TYColorStage::process(const TY_IMAGE_DATA& src, uint8_t* dst, bool parallel)
+{
+  if (!src.buffer || !dst) {
+    return TY_STATUS_NULL_POINTER;
+  }
+  if (!supports(src.pixelFormat)) {
+    return TY_STATUS_INVALID_PARAMETER;
+  }
+  if (src.width <= 0 || src.height <= 0 || _dst_w <= 0 || _dst_h <= 0 ||
+      src.width > 32767 || src.height > 32767) {
+    return TY_STATUS_INVALID_PARAMETER;
+  }
+
+  if (_map.empty() || _map_src_w != src.width || _map_src_h != src.height) {
+    buildMap(src.width, src.height);
+  }
+
+  if (!parallel) {
+    processRows(src, dst, 0, _dst_h);
+    return TY_STATUS_OK;
+  }
+
+  TYWorkerPool& pool = TYWorkerPool::shared();
+  int bands = static_cast<int>(pool.size() + 1) * 4;
+  int grain = std::max(8, (_dst_h + bands - 1) / bands);
+  pool.parallel_for(0, _dst_h, grain, [&](int begin, int end) {
+    processRows(src, dst, begin, end);
+  });
+  return TY_STATUS_OK;
+}
@@ -0,0 +1,55 @@
+#ifndef XYZ_TYColorStage_HPP_
+#define XYZ_TYColorStage_HPP_
+
+#include <vector>
+#include <stdint.h>
+
+#include "TYDefs.h"
+
+// 彩色图融合处理：解码(YUYV/YVYU/RGB/BGR) + 去畸变 + 缩放在一次遍历中完成，输出BGR
+// 按目标像素预先计算源图采样位置(查找表)，每帧只读一次源图、写一次目标图，
+// 省去解码后和去畸变后两幅全分辨率中间图
+// YUV输入在YUV空间插值后再转换，转换公式与cvtColor一致
+class TYColorStage
+{
+public:
+  TYColorStage();
+
+  // calib为空时只缩放；linear为false时使用最近邻采样
+  // 查找表在下一次process()时按实际输入尺寸生成，之后输入尺寸不变则一直复用；
+  // 参数(包括标定数据)与上次相同时不做任何事，标定或去畸变开关变化时才重新生成
+  void configure(const TY_CAMERA_CALIB_INFO* calib, int dst_w, int dst_h, bool linear = true);
+
+  static bool supports(TY_PIXEL_FORMAT format);
+
+  // dst至少为dst_w * dst_h * 3字节；parallel为true时按行带分给TYWorkerPool::shared()
+  TY_STATUS process(const TY_IMAGE_DATA& src, uint8_t* dst, bool parallel = false);
+
+  int width() const { return _dst_w; }
+  int height() const { return _dst_h; }
+  // 输出图像对应的内参(按目标尺寸缩放)，未设置标定数据时返回false
+  bool intrinsic(TY_CAMERA_INTRINSIC& out) const;
+
+private:
+  // 采样位置：左上角整数坐标与Q5小数部分(fy << 5 | fx)；x为-1表示落在源图外，输出黑色
+  struct Tap {
+    int16_t  x;
+    int16_t  y;
+    uint16_t w;
+  };
+
+  void buildMap(int src_w, int src_h);
+  void processRows(const TY_IMAGE_DATA& src, uint8_t* dst, int begin, int end) const;
+
+  bool                  _has_calib;
+  TY_CAMERA_CALIB_INFO  _calib;
+  int                   _dst_w;
+  int                   _dst_h;
+  bool                  _linear;
+
+  int                   _map_src_w;
+  int                   _map_src_h;
+  std::vector<Tap>      _map;
+};
+
+#endif
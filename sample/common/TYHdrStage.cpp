@@ -0,0 +1,128 @@
+#include "TYHdrStage.hpp"
+#include "TYWorkerPool.hpp"
+#include "funny_csi.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// 每次解包的像素数(4的倍数)，解包结果留在栈上，随即查表
+static const int kChunk = 256;
+
+TYHdrStage::TYHdrStage()
+  : _configured(false), _tone(TONEMAP_LOG)
+{
+  memset(_param, 0, sizeof(_param));
+  memset(_linear, 0, sizeof(_linear));
+  memset(_tone16, 0, sizeof(_tone16));
+  memset(_tone8, 0, sizeof(_tone8));
+}
+
+bool TYHdrStage::configure(const uint32_t param[8], ToneMap tone)
+{
+  const uint32_t p[4] = { param[0], param[1], param[6], param[7] };
+  if (_configured && tone == _tone && memcmp(p, _param, sizeof(p)) == 0) {
+    return false;
+  }
+  memcpy(_param, p, sizeof(p));
+  _tone = tone;
+  _configured = true;
+
+  // 与SimpleView_HDR原先的covertToLinear一致：10位值乘4恢复为12位压缩数据，
+  // 拐点P1之前不变，P1~Pk斜率4*R1，Pk之后斜率4*R1*R2
+  const uint32_t R1 = 1u << (p[0] + 2);
+  const uint32_t R2 = 1u << (p[1] + 2);
+  const uint32_t P1 = 1u << p[2];
+  const uint32_t P2 = 1u << p[3];
+  const uint32_t Pk = static_cast<uint32_t>(static_cast<int>((P2 - P1) / (4.0f * R1))) + P1;
+  for (int v = 0; v < 1024; v++) {
+    uint32_t s = static_cast<uint32_t>(v) * 4;
+    if (s <= P1) {
+      _linear[v] = s;
+    } else if (s <= Pk) {
+      _linear[v] = (s - P1) * 4 * R1 + P1;
+    } else {
+      _linear[v] = (s - Pk) * 4 * R1 * R2 + P2;
+    }
+  }
+
+  const double norm = std::log1p(static_cast<double>(std::max<uint32_t>(_linear[1023], 1)));
+  for (int v = 0; v < 1024; v++) {
+    if (tone == TONEMAP_CLIP) {
+      _tone16[v] = static_cast<uint16_t>(std::min<uint32_t>(_linear[v], 65535));
+      _tone8[v] = static_cast<uint8_t>(_tone16[v] >> 8);
+    } else {
+      double t = std::log1p(static_cast<double>(_linear[v])) / norm;
+      _tone16[v] = static_cast<uint16_t>(std::lround(t * 65535));
+      _tone8[v] = static_cast<uint8_t>(std::lround(t * 255));
+    }
+  }
+  return true;
+}
+
+void TYHdrStage::processRows(const TY_IMAGE_DATA& src, uint32_t* linear, uint16_t* tone16, uint8_t* tone8,
+                             int begin, int end) const
+{
+  const int w = src.width;
+  const int stride = funny_csi_row_bytes(w, 10);
+  const uint8_t* base = static_cast<const uint8_t*>(src.buffer);
+  uint16_t raw[kChunk];
+
+  for (int y = begin; y < end; y++) {
+    const uint8_t* row = base + static_cast<size_t>(y) * stride;
+    size_t o = static_cast<size_t>(y) * w;
+    for (int x = 0; x < w; x += kChunk) {
+      int n = std::min(kChunk, w - x);
+      funny_csi_unpack(row + x / 4 * 5, 0, raw, 0, n, 1, 10);
+      if (linear) {
+        for (int i = 0; i < n; i++) {
+          linear[o + x + i] = _linear[raw[i] & 1023];
+        }
+      }
+      if (tone16) {
+        for (int i = 0; i < n; i++) {
+          tone16[o + x + i] = _tone16[raw[i] & 1023];
+        }
+      }
+      if (tone8) {
+        for (int i = 0; i < n; i++) {
+          tone8[o + x + i] = _tone8[raw[i] & 1023];
+        }
+      }
+    }
+  }
+}
+
+TY_STATUS TYHdrStage::process(const TY_IMAGE_DATA& src, uint32_t* linear, uint16_t* tone16, uint8_t* tone8,
+                              bool parallel) const
+{
+  if (!src.buffer) {
+    return TY_STATUS_NULL_POINTER;
+  }
+  if (!_configured) {
+    return TY_STATUS_NOT_INITED;
+  }
+  if (funny_csi_bits(src.pixelFormat) != 10 || src.width <= 0 || src.height <= 0) {
+    return TY_STATUS_INVALID_PARAMETER;
+  }
+  if (src.size > 0 && static_cast<int64_t>(src.size) <
+      static_cast<int64_t>(funny_csi_row_bytes(src.width, 10)) * src.height) {
+    return TY_STATUS_INVALID_PARAMETER;
+  }
+  if (!linear && !tone16 && !tone8) {
+    return TY_STATUS_OK;
+  }
+
+  if (!parallel) {
+    processRows(src, linear, tone16, tone8, 0, src.height);
+    return TY_STATUS_OK;
+  }
+
+  TYWorkerPool& pool = TYWorkerPool::shared();
+  int bands = static_cast<int>(pool.size() + 1) * 4;
+  int grain = std::max(8, (src.height + bands - 1) / bands);
+  pool.parallel_for(0, src.height, grain, [&](int begin, int end) {
+    processRows(src, linear, tone16, tone8, begin, end);
+  });
+  return TY_STATUS_OK;
+}
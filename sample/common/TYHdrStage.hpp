@@ -0,0 +1,49 @@
+#ifndef XYZ_TYHdrStage_HPP_
+#define XYZ_TYHdrStage_HPP_
+
+#include <stdint.h>
+
+#include "TYDefs.h"
+
+// HDR彩色图(CSI 10位紧凑格式)解码：解包 + 10位恢复为12位压缩数据 + 分段线性还原 + 色调映射在一次遍历中完成
+// 分段线性曲线由TY_BYTEARRAY_HDR_PARAMETER的R1/R2/P1/P2决定，按10位原始值预先生成1024项查找表，
+// 每个像素只做一次解包和查表，不再生成12位和32位中间图
+class TYHdrStage
+{
+public:
+  enum ToneMap {
+    TONEMAP_CLIP,   // 线性值超过输出范围时截断，16位输出与原先convertTo(CV_16U)一致，8位输出再取高8位
+    TONEMAP_LOG     // 按log(1 + L)压缩到输出范围，保留暗部细节
+  };
+
+  TYHdrStage();
+
+  // param为TY_BYTEARRAY_HDR_PARAMETER读回的8个uint32(32字节)
+  // 只有R1/R2/P1/P2或色调映射方式变化时才重建查找表，返回是否重建
+  bool configure(const uint32_t param[8], ToneMap tone = TONEMAP_LOG);
+
+  bool configured() const { return _configured; }
+
+  // src为CSI 10位紧凑格式(CSI_MONO10/CSI_BAYER10*)
+  // linear/tone16/tone8为空的输出不写，非空时至少为width * height个元素，三者可以同时输出
+  // linear为还原后的线性值(最高20位)；parallel为true时按行带分给TYWorkerPool::shared()
+  TY_STATUS process(const TY_IMAGE_DATA& src, uint32_t* linear, uint16_t* tone16, uint8_t* tone8,
+                    bool parallel = false) const;
+
+  // 10位原始值为1023时的线性值
+  uint32_t maxLinear() const { return _linear[1023]; }
+
+private:
+  void processRows(const TY_IMAGE_DATA& src, uint32_t* linear, uint16_t* tone16, uint8_t* tone8,
+                   int begin, int end) const;
+
+  bool      _configured;
+  uint32_t  _param[4];    // R1, R2, P1, P2的原始参数(param[0], param[1], param[6], param[7])
+  ToneMap   _tone;
+
+  uint32_t  _linear[1024];
+  uint16_t  _tone16[1024];
+  uint8_t   _tone8[1024];
+};
+
+#endif
@@ -0,0 +1,261 @@
+#include "TYImageStats.hpp"
+#include "funny_bayer.hpp"
+#include "funny_pixel.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// 自动选择采样间隔时的采样点上限
+static const int kAutoSamples = 16000;
+
+// Packing: 8为逐字节存放，10/12为CSI紧凑打包，只取高8位
+template <int Packing>
+static inline int rawAt(const uint8_t* row, int x)
+{
+  if (Packing == 10) {
+    return row[(x >> 2) * 5 + (x & 3)];
+  } else if (Packing == 12) {
+    return row[(x >> 1) * 3 + (x & 1)];
+  }
+  return row[x];
+}
+
+static inline int clamp8(int v)
+{
+  return v < 0 ? 0 : (v > 255 ? 255 : v);
+}
+
+static inline int lumaOf(int b, int g, int r)
+{
+  return (77 * r + 150 * g + 29 * b + 128) >> 8;
+}
+
+TYImageStats::TYImageStats()
+  : _zones_x(4), _zones_y(4), _step_cfg(0), _clip_level(250)
+  , _step(0), _width(0), _height(0), _zones(16, Zone()), _samples(0)
+{
+  memset(_hist, 0, sizeof(_hist));
+}
+
+void TYImageStats::configure(int zones_x, int zones_y, int step)
+{
+  _zones_x = std::max(1, zones_x);
+  _zones_y = std::max(1, zones_y);
+  _step_cfg = std::max(0, step);
+  _width = 0;
+  _zones.assign(_zones_x * _zones_y, Zone());
+  _samples = 0;
+}
+
+void TYImageStats::prepare(int width, int height, int step_align)
+{
+  int step = _step_cfg;
+  if (step == 0) {
+    step = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(width) * height / kAutoSamples)));
+  }
+  step = std::max(step, step_align);
+  step = (step + step_align - 1) / step_align * step_align;
+
+  if (width != _width || height != _height || step != _step ||
+      _zones.size() != static_cast<size_t>(_zones_x * _zones_y)) {
+    _width = width;
+    _height = height;
+    _step = step;
+    _zones.resize(_zones_x * _zones_y);
+    _col_zone.resize((width + step - 1) / step);
+    for (size_t i = 0; i < _col_zone.size(); i++) {
+      _col_zone[i] = static_cast<int>(i * step * _zones_x / width);
+    }
+  }
+  memset(&_zones[0], 0, _zones.size() * sizeof(Zone));
+  memset(_hist, 0, sizeof(_hist));
+  _samples = 0;
+}
+
+inline void TYImageStats::add(int zone, int b, int g, int r, int y)
+{
+  Zone& z = _zones[zone];
+  z.count++;
+  z.luma += y;
+  z.sum[0] += b;
+  z.sum[1] += g;
+  z.sum[2] += r;
+  if (std::max(b, std::max(g, r)) >= _clip_level) {
+    z.clipped++;
+  }
+  z.hist[y >> 2]++;
+  _hist[y]++;
+}
+
+// 每个采样点取一个2x2单元，r_pos为R在单元内的位置(0:左上 1:右上 2:左下 3:右下)，B在对角
+template <int Packing>
+void TYImageStats::sampleBayer(const TY_IMAGE_DATA& src, int stride, int r_pos)
+{
+  const uint8_t* base = static_cast<const uint8_t*>(src.buffer);
+  const int b_pos = 3 - r_pos;
+  for (int y = 0; y + 1 < src.height; y += _step) {
+    const uint8_t* row[2] = { base + static_cast<size_t>(y) * stride, base + static_cast<size_t>(y + 1) * stride };
+    const int* zx = &_col_zone[0];
+    const int zrow = y * _zones_y / src.height * _zones_x;
+    for (int x = 0; x + 1 < src.width; x += _step, zx++) {
+      int v[4] = { rawAt<Packing>(row[0], x), rawAt<Packing>(row[0], x + 1),
+                   rawAt<Packing>(row[1], x), rawAt<Packing>(row[1], x + 1) };
+      int r = v[r_pos];
+      int b = v[b_pos];
+      int g = (v[0] + v[1] + v[2] + v[3] - r - b + 1) >> 1;
+      add(zrow + *zx, b, g, r, lumaOf(b, g, r));
+    }
+  }
+}
+
+template <int Packing>
+void TYImageStats::sampleMono(const TY_IMAGE_DATA& src, int stride)
+{
+  const uint8_t* base = static_cast<const uint8_t*>(src.buffer);
+  for (int y = 0; y < src.height; y += _step) {
+    const uint8_t* row = base + static_cast<size_t>(y) * stride;
+    const int* zx = &_col_zone[0];
+    const int zrow = y * _zones_y / src.height * _zones_x;
+    for (int x = 0; x < src.width; x += _step, zx++) {
+      int v = rawAt<Packing>(row, x);
+      add(zrow + *zx, v, v, v, v);
+    }
+  }
+}
+
+// 每个采样点取一个宏像素，Y取两个像素的平均，按与funny_yuv422_to_bgr相同的系数转为BGR
+void TYImageStats::sampleYUV(const TY_IMAGE_DATA& src, int stride, bool yvyu)
+{
+  const uint8_t* base = static_cast<const uint8_t*>(src.buffer);
+  for (int y = 0; y < src.height; y += _step) {
+    const uint8_t* row = base + static_cast<size_t>(y) * stride;
+    const int* zx = &_col_zone[0];
+    const int zrow = y * _zones_y / src.height * _zones_x;
+    for (int x = 0; x + 1 < src.width; x += _step, zx++) {
+      const uint8_t* p = row + x * 2;
+      int yy = 298 * (((p[0] + p[2] + 1) >> 1) - 16) + 128;
+      int u = (yvyu ? p[3] : p[1]) - 128;
+      int v = (yvyu ? p[1] : p[3]) - 128;
+      int r = clamp8((yy + 409 * v) >> 8);
+      int g = clamp8((yy - 100 * u - 208 * v) >> 8);
+      int b = clamp8((yy + 516 * u) >> 8);
+      add(zrow + *zx, b, g, r, lumaOf(b, g, r));
+    }
+  }
+}
+
+void TYImageStats::sampleRGB(const TY_IMAGE_DATA& src, int stride, bool rgb_order)
+{
+  const uint8_t* base = static_cast<const uint8_t*>(src.buffer);
+  const int ib = rgb_order ? 2 : 0;
+  const int ir = 2 - ib;
+  for (int y = 0; y < src.height; y += _step) {
+    const uint8_t* row = base + static_cast<size_t>(y) * stride;
+    const int* zx = &_col_zone[0];
+    const int zrow = y * _zones_y / src.height * _zones_x;
+    for (int x = 0; x < src.width; x += _step, zx++) {
+      const uint8_t* p = row + x * 3;
+      add(zrow + *zx, p[ib], p[1], p[ir], lumaOf(p[ib], p[1], p[ir]));
+    }
+  }
+}
+
+TY_STATUS TYImageStats::compute(const TY_IMAGE_DATA& src)
+{
+  if (!src.buffer) {
+    return TY_STATUS_NULL_POINTER;
+  }
+  if (src.width < 2 || src.height < 2) {
+    return TY_STATUS_INVALID_PARAMETER;
+  }
+  const uint32_t fmt = src.pixelFormat;
+  const FunnyPixelTraits& t = funny_pixel_traits(fmt);
+  const int stride = funny_pixel_row_bytes(fmt, src.width);
+  if (stride == 0) {
+    return TY_STATUS_INVALID_PARAMETER;
+  }
+  if (src.size > 0 && static_cast<int64_t>(src.size) < static_cast<int64_t>(stride) * src.height) {
+    return TY_STATUS_INVALID_PARAMETER;
+  }
+
+  BayerPattern pattern;
+  int bits;
+  bool csi_packed;
+  if (funny_bayer_format(fmt, pattern, bits, csi_packed)) {
+    // R在左上2x2单元中的位置取自funny_bayer，与解马赛克保持一致
+    int rx, ry;
+    funny_bayer_red_site(pattern, rx, ry);
+    const int r_pos = ry * 2 + rx;
+    prepare(src.width, src.height, 2);
+    if (bits == 10) {
+      sampleBayer<10>(src, stride, r_pos);
+    } else if (bits == 12) {
+      sampleBayer<12>(src, stride, r_pos);
+    } else {
+      sampleBayer<8>(src, stride, r_pos);
+    }
+  } else if (fmt == TY_PIXEL_FORMAT_MONO) {
+    prepare(src.width, src.height, 1);
+    sampleMono<8>(src, stride);
+  } else if (fmt == TY_PIXEL_FORMAT_CSI_MONO10) {
+    prepare(src.width, src.height, 1);
+    sampleMono<10>(src, stride);
+  } else if (fmt == TY_PIXEL_FORMAT_CSI_MONO12) {
+    prepare(src.width, src.height, 1);
+    sampleMono<12>(src, stride);
+  } else if (t.packing == FunnyPixelPacking::Yuv422) {
+    prepare(src.width, src.height, 2);
+    sampleYUV(src, stride, fmt == TY_PIXEL_FORMAT_YVYU);
+  } else if (fmt == TY_PIXEL_FORMAT_RGB || fmt == TY_PIXEL_FORMAT_BGR) {
+    prepare(src.width, src.height, 1);
+    sampleRGB(src, stride, t.rgb_order);
+  } else {
+    return TY_STATUS_INVALID_PARAMETER;
+  }
+
+  for (size_t i = 0; i < _zones.size(); i++) {
+    _samples += _zones[i].count;
+  }
+  return TY_STATUS_OK;
+}
+
+float TYImageStats::meanLuma() const
+{
+  if (_samples == 0) {
+    return 0.f;
+  }
+  uint64_t sum = 0;
+  for (size_t i = 0; i < _zones.size(); i++) {
+    sum += _zones[i].luma;
+  }
+  return static_cast<float>(sum) / _samples;
+}
+
+int TYImageStats::percentile(float p) const
+{
+  if (_samples == 0) {
+    return 0;
+  }
+  const double target = std::min(std::max(p, 0.f), 1.f) * _samples;
+  double acc = 0;
+  for (int i = 0; i < 256; i++) {
+    acc += _hist[i];
+    if (acc >= target && acc > 0) {
+      return i;
+    }
+  }
+  return 255;
+}
+
+float TYImageStats::clippedRatio() const
+{
+  if (_samples == 0) {
+    return 0.f;
+  }
+  uint32_t clipped = 0;
+  for (size_t i = 0; i < _zones.size(); i++) {
+    clipped += _zones[i].clipped;
+  }
+  return static_cast<float>(clipped) / _samples;
+}
@@ -0,0 +1,76 @@
+#ifndef XYZ_TYImageStats_HPP_
+#define XYZ_TYImageStats_HPP_
+
+#include <vector>
+#include <stdint.h>
+
+#include "TYDefs.h"
+
+// 自动曝光/白平衡用的图像统计：按step间隔的网格抽样，把图像分成zones_x * zones_y个区域，
+// 统计每个区域的亮度直方图、B/G/R和亮度之和，以及全图256级亮度直方图
+// 支持MONO、BAYER8*、CSI_MONO10/12、CSI_BAYER10/12*(原始数据直接抽样，不解马赛克、不解包)、
+// YUYV/YVYU和RGB/BGR(解码后的图像)；所有分量按8位统计，高位宽数据取高8位
+// 1280x960默认参数下约12000个采样点，单线程远小于1ms
+class TYImageStats
+{
+public:
+  enum { ZONE_BINS = 64 };    // 区域直方图按8位亮度的高6位分级
+
+  struct Zone {
+    uint32_t count;           // 采样点数
+    uint32_t luma;            // 亮度之和
+    uint32_t sum[3];          // B/G/R之和
+    uint32_t clipped;         // 任一分量达到饱和阈值的采样点数
+    uint32_t hist[ZONE_BINS];
+  };
+
+  TYImageStats();
+
+  // step为采样间隔(像素，Bayer按2x2单元取偶数)，0时按图像大小自动选择，使采样点不超过约16000个
+  void configure(int zones_x, int zones_y, int step = 0);
+
+  // 不支持的格式(如JPEG)返回TY_STATUS_INVALID_PARAMETER，可先解码为BGR再统计
+  TY_STATUS compute(const TY_IMAGE_DATA& src);
+
+  int zonesX() const { return _zones_x; }
+  int zonesY() const { return _zones_y; }
+  const Zone& zone(int zx, int zy) const { return _zones[zy * _zones_x + zx]; }
+
+  // 以下为最近一次compute()的全图结果
+  uint32_t samples() const { return _samples; }
+  const uint32_t* histogram() const { return _hist; }
+  float meanLuma() const;
+  // 累计采样点比例达到p(0~1)时的亮度
+  int percentile(float p) const;
+  // 饱和采样点所占比例
+  float clippedRatio() const;
+
+  // 饱和阈值(8位)，默认250
+  void setClipLevel(int level) { _clip_level = level; }
+  int clipLevel() const { return _clip_level; }
+
+private:
+  void prepare(int width, int height, int step_align);
+  inline void add(int zone, int b, int g, int r, int y);
+
+  template <int Packing> void sampleBayer(const TY_IMAGE_DATA& src, int stride, int r_pos);
+  template <int Packing> void sampleMono(const TY_IMAGE_DATA& src, int stride);
+  void sampleYUV(const TY_IMAGE_DATA& src, int stride, bool yvyu);
+  void sampleRGB(const TY_IMAGE_DATA& src, int stride, bool rgb_order);
+
+  int                 _zones_x;
+  int                 _zones_y;
+  int                 _step_cfg;
+  int                 _clip_level;
+
+  int                 _step;
+  int                 _width;
+  int                 _height;
+  std::vector<int>    _col_zone;   // 每个采样列所属的区域列
+  std::vector<Zone>   _zones;
+
+  uint32_t            _samples;
+  uint32_t            _hist[256];
+};
+
+#endif
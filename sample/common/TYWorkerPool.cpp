@@ -0,0 +1,141 @@
+#include "TYWorkerPool.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+TYWorkerPool::TYWorkerPool(uint32_t threads)
+  : _stop(false)
+{
+  if (threads == 0) {
+    threads = std::thread::hardware_concurrency();
+    if (threads == 0) {
+      threads = 2;
+    }
+  }
+  for (uint32_t i = 0; i < threads; i++) {
+    _workers.push_back(std::thread(&TYWorkerPool::workerLoop, this));
+  }
+}
+
+TYWorkerPool::~TYWorkerPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(_lock);
+    _stop = true;
+  }
+  _cond.notify_all();
+  for (auto& worker : _workers) {
+    worker.join();
+  }
+}
+
+TYWorkerPool& TYWorkerPool::shared()
+{
+  static TYWorkerPool pool;
+  return pool;
+}
+
+void TYWorkerPool::submit(Task task)
+{
+  {
+    std::lock_guard<std::mutex> lock(_lock);
+    _tasks.push_back(std::move(task));
+  }
+  _cond.notify_one();
+}
+
+bool TYWorkerPool::runOne()
+{
+  Task task;
+  {
+    std::lock_guard<std::mutex> lock(_lock);
+    if (_tasks.empty()) {
+      return false;
+    }
+    task = std::move(_tasks.front());
+    _tasks.pop_front();
+  }
+  task();
+  return true;
+}
+
+void TYWorkerPool::workerLoop()
+{
+  for (;;) {
+    Task task;
+    {
+      std::unique_lock<std::mutex> lock(_lock);
+      _cond.wait(lock, [this] { return _stop || !_tasks.empty(); });
+      if (_stop && _tasks.empty()) {
+        return;
+      }
+      task = std::move(_tasks.front());
+      _tasks.pop_front();
+    }
+    task();
+  }
+}
+
+void TYWorkerPool::parallel_for(int begin, int end, int grain, const std::function<void(int, int)>& fn)
+{
+  if (end <= begin) {
+    return;
+  }
+  if (grain <= 0) {
+    // 默认每个线程约4块，兼顾负载均衡与调度开销
+    int blocks = static_cast<int>(size() + 1) * 4;
+    grain = std::max(1, (end - begin + blocks - 1) / blocks);
+  }
+  if (end - begin <= grain) {
+    fn(begin, end);
+    return;
+  }
+
+  TYTaskGroup group(*this);
+  int first_end = begin + grain;
+  for (int b = first_end; b < end; b += grain) {
+    int e = std::min(end, b + grain);
+    group.run([&fn, b, e] { fn(b, e); });
+  }
+  // 第一块由调用线程执行
+  fn(begin, first_end);
+  group.wait();
+}
+
+TYTaskGroup::TYTaskGroup(TYWorkerPool& pool)
+  : _pool(pool), _pending(0)
+{
+}
+
+TYTaskGroup::~TYTaskGroup()
+{
+  wait();
+}
+
+void TYTaskGroup::run(TYWorkerPool::Task task)
+{
+  _pending++;
+  _pool.submit([this, task] {
+    task();
+    std::lock_guard<std::mutex> lock(_lock);
+    if (--_pending == 0) {
+      _done.notify_all();
+    }
+  });
+}
+
+void TYTaskGroup::wait()
+{
+  for (;;) {
+    // 帮忙执行排队的任务；队列已空时等待其余任务在工作线程上结束
+    if (_pending.load() > 0 && _pool.runOne()) {
+      continue;
+    }
+    // 计数归零须在锁内确认，保证最后一个任务已离开临界区后才允许本对象析构
+    std::unique_lock<std::mutex> lock(_lock);
+    if (_pending.load() == 0) {
+      return;
+    }
+    _done.wait_for(lock, std::chrono::milliseconds(1));
+  }
+}
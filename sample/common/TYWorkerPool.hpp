@@ -0,0 +1,67 @@
+#ifndef XYZ_TYWorkerPool_HPP_
+#define XYZ_TYWorkerPool_HPP_
+
+#include <functional>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <stdint.h>
+
+// 共享工作线程池：用于帧内按分量/按行带的并行处理
+// 等待方(TYTaskGroup::wait / parallel_for)在等待期间会帮忙执行队列中的任务，
+// 因此任务内部再次提交并等待子任务也不会死锁
+class TYWorkerPool
+{
+public:
+  typedef std::function<void()> Task;
+
+  // threads为0时取硬件线程数
+  explicit TYWorkerPool(uint32_t threads = 0);
+  ~TYWorkerPool();
+
+  TYWorkerPool(const TYWorkerPool&) = delete;
+  TYWorkerPool& operator=(const TYWorkerPool&) = delete;
+
+  // 进程内共享的默认线程池，首次使用时创建
+  static TYWorkerPool& shared();
+
+  uint32_t size() const { return static_cast<uint32_t>(_workers.size()); }
+
+  void submit(Task task);
+  // 取出一个排队的任务在当前线程执行，队列为空时返回false
+  bool runOne();
+
+  // 将[begin, end)按grain切块并行执行fn(block_begin, block_end)，调用线程也参与，返回时全部完成
+  void parallel_for(int begin, int end, int grain, const std::function<void(int, int)>& fn);
+
+private:
+  void workerLoop();
+
+  std::vector<std::thread>  _workers;
+  std::deque<Task>          _tasks;
+  std::mutex                _lock;
+  std::condition_variable   _cond;
+  bool                      _stop;
+};
+
+// 一组需要共同等待完成的任务
+class TYTaskGroup
+{
+public:
+  explicit TYTaskGroup(TYWorkerPool& pool = TYWorkerPool::shared());
+  ~TYTaskGroup();
+
+  void run(TYWorkerPool::Task task);
+  void wait();
+
+private:
+  TYWorkerPool&             _pool;
+  std::atomic<int>          _pending;
+  std::mutex                _lock;
+  std::condition_variable   _done;
+};
+
+#endif
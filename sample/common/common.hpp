@@ -7,6 +7,7 @@
 #include "TyIsp.h"
 #include "TYDefs.h"
 #include "funny_Mat.hpp"
+#include "funny_pixel.hpp"
 #else
 // 使用头文件隔离的项目（如sample项目）- 使用前向声明避免重复包含
 #include <cstdint>
@@ -28,6 +29,7 @@
 
 // funny_Mat头文件
 #include "funny_Mat.hpp"
+#include "funny_pixel.hpp"
 // 包含SDK类型定义
 #include "TYApi.h"
 
@@ -53,29 +55,26 @@ typedef void* TY_ISP_HANDLE;
 
 namespace percipio_layer {
 
-// 像素格式定义 - 避免依赖SDK枚举
-const uint32_t MONO = 0x0001;
-const uint32_t MONO16 = 0x0002;
-const uint32_t DEPTH16 = 0x0030;
-const uint32_t TOF_IR_MONO16 = 0x0040;
-const uint32_t JPEG = 0x1000;
-const uint32_t YVYU = 0x0020;
-const uint32_t YUYV = 0x0021;
-const uint32_t RGB = 0x0014;
-const uint32_t BGR = 0x0015;
-const uint32_t BAYER8GBRG = 0x0008;
-const uint32_t BAYER8BGGR = 0x0009;
-const uint32_t BAYER8GRBG = 0x000A;
-const uint32_t BAYER8RGGB = 0x000B;
-const uint32_t CSI_MONO10 = 0x010A;
-const uint32_t CSI_MONO12 = 0x010C;
-const uint32_t XYZ48 = 0x1030;
-
-// 组件ID定义
-const int TY_COMPONENT_RGB_CAM = 0;
-const int TY_COMPONENT_DEPTH_CAM = 1;
-const int TY_COMPONENT_IR_CAM_LEFT = 2;
-const int TY_COMPONENT_IR_CAM_RIGHT = 3;
+// 像素格式定义 - 与SDK的TY_PIXEL_FORMAT_LIST取值一致，特性见funny_pixel.hpp
+const uint32_t MONO = TY_PIXEL_FORMAT_MONO;
+const uint32_t MONO16 = TY_PIXEL_FORMAT_MONO16;
+const uint32_t DEPTH16 = TY_PIXEL_FORMAT_DEPTH16;
+const uint32_t TOF_IR_MONO16 = TY_PIXEL_FORMAT_TOF_IR_MONO16;
+const uint32_t JPEG = TY_PIXEL_FORMAT_JPEG;
+const uint32_t MJPG = TY_PIXEL_FORMAT_MJPG;
+const uint32_t YVYU = TY_PIXEL_FORMAT_YVYU;
+const uint32_t YUYV = TY_PIXEL_FORMAT_YUYV;
+const uint32_t RGB = TY_PIXEL_FORMAT_RGB;
+const uint32_t BGR = TY_PIXEL_FORMAT_BGR;
+const uint32_t BAYER8GBRG = TY_PIXEL_FORMAT_BAYER8GBRG;
+const uint32_t BAYER8BGGR = TY_PIXEL_FORMAT_BAYER8BGGR;
+const uint32_t BAYER8GRBG = TY_PIXEL_FORMAT_BAYER8GRBG;
+const uint32_t BAYER8RGGB = TY_PIXEL_FORMAT_BAYER8RGGB;
+const uint32_t CSI_MONO10 = TY_PIXEL_FORMAT_CSI_MONO10;
+const uint32_t CSI_MONO12 = TY_PIXEL_FORMAT_CSI_MONO12;
+const uint32_t XYZ48 = TY_PIXEL_FORMAT_XYZ48;
+
+// 组件ID直接使用SDK的TY_COMPONENT_*，不再在此重新定义
 
 // 状态码定义
 #ifndef TY_STATUS_OK
@@ -83,10 +82,11 @@ const int TY_COMPONENT_IR_CAM_RIGHT = 3;
 #endif
 
 // 前向声明函数，避免循环依赖
-int parseIrFrame(const TY_IMAGE_DATA* img, funny_Mat* pIr);
-int parseColorFrame(const TY_IMAGE_DATA* img, funny_Mat* pColor, TY_ISP_HANDLE color_isp_handle);
-int parseImage(const TY_IMAGE_DATA* img, funny_Mat* image, TY_ISP_HANDLE color_isp_handle);
-int parseDepthFrame(const TY_IMAGE_DATA* img, funny_Mat* pDepth);
+// copy为false时，无需转换的格式直接返回引用img->buffer的视图，调用方须保证帧缓冲区在使用期间有效
+int parseIrFrame(const TY_IMAGE_DATA* img, funny_Mat* pIr, bool copy = true);
+int parseColorFrame(const TY_IMAGE_DATA* img, funny_Mat* pColor, TY_ISP_HANDLE color_isp_handle, bool copy = true);
+int parseImage(const TY_IMAGE_DATA* img, funny_Mat* image, TY_ISP_HANDLE color_isp_handle, bool copy = true);
+int parseDepthFrame(const TY_IMAGE_DATA* img, funny_Mat* pDepth, bool copy = true);
 int parsePoints(const TY_VECT_3F& pts, int pointSize, funny_Mat* point3f);
 
 // 前向声明辅助函数
@@ -96,239 +96,343 @@ int parseBayer12Frame(const TY_IMAGE_DATA* img, funny_Mat* pColor);
 void parseCsiRaw8(uint8_t* src, funny_Mat& dst, int width, int height);
 int parseCsiRaw10(uint8_t* src, funny_Mat& dst, int width, int height);
 int parseCsiRaw12(uint8_t* src, funny_Mat& dst, int width, int height);
+// 缩小解码彩色图为BGR888，scale为1/2/4；支持YUYV/YVYU、BGR/RGB、BAYER8/CSI_BAYER10/12和JPEG/MJPG
+// 输出(width / scale) x (height / scale)，JPEG为向上取整；只需要低分辨率彩色(如按深度图分辨率配准)时使用
+int parseColorFrameReduced(const TY_IMAGE_DATA* img, funny_Mat* pColor, int scale);
 bool imdecode(const std::vector<uint8_t>& buffer, int flags, funny_Mat& dst);
 void cvtColor(const funny_Mat& src, funny_Mat& dst, int code);
+// 逐级缩小一半的图像金字塔，dst[0]为src的拷贝，dst[i]为(cols_{i-1} / 2) x (rows_{i-1} / 2)
+// 与cv::buildPyramid不同，每级用2x2区域平均(不是高斯滤波)；支持CV_8UC1/CV_8UC3/CV_16U，
+// 尺寸不足2x2时提前停止，返回实际生成的层数(不含第0层)，类型不支持时返回-1
+int buildPyramid(const funny_Mat& src, std::vector<funny_Mat>& dst, int maxlevel, bool parallel = false);
+
+// 转换注册表
+// 每个(像素格式, 用途)组合在编译期由funny_pixel.hpp的格式特性选定转换内核，并实例化为专用函数；
+// 运行时只按像素格式查一次表，同一数据流可用PixelConverter缓存查表结果
+enum class PixelTarget {
+    Color,  // parseColorFrame：彩色输出BGR888
+    Ir,     // parseIrFrame：保持原始位深的灰度图
+    Depth,  // parseDepthFrame：16位深度图
+    Image   // parseImage：彩色格式转BGR888，灰度格式保持原始位深
+};
 
-// 函数实现
-inline int parseIrFrame(const TY_IMAGE_DATA* img, funny_Mat* pIr) {
-    if (!img || !pIr) {
-        return -1;
-    }
-    
-    if (img->pixelFormat == MONO) {
-        *pIr = funny_Mat(img->height, img->width, toInt(PixelFormat::CV_8UC1), img->buffer).clone();
-    }
-    else if (img->pixelFormat == MONO16) {
-        *pIr = funny_Mat(img->height, img->width, toInt(PixelFormat::CV_16U), img->buffer).clone();
+enum class PixelKernel {
+    None,
+    Copy,       // 按原始位深复制
+    SwapRB,     // RGB888转BGR888
+    Gray2BGR,   // 8位灰度扩展为BGR888
+    Yuv422,     // YUYV/YVYU转BGR888
+    Jpeg,       // JPEG/MJPG解码
+    CsiMono,    // CSI RAW10/12解包为16位
+    Bayer       // Bayer解马赛克为BGR888
+};
+
+// copy只影响Copy内核：为false时dst为引用img->buffer的视图
+typedef int (*PixelConvertFn)(const TY_IMAGE_DATA* img, funny_Mat* dst, TY_ISP_HANDLE color_isp_handle, bool copy);
+
+// 按原始位深复制时的funny_Mat类型，无对应类型时为-1
+constexpr int pixelMatType(uint32_t fmt) {
+    return funny_pixel_traits(fmt).channels == 1 && funny_pixel_traits(fmt).sample_bits == 8 ? CV_8UC1
+         : funny_pixel_traits(fmt).channels == 1 && funny_pixel_traits(fmt).sample_bits == 16 ? CV_16U
+         : funny_pixel_traits(fmt).channels == 3 && funny_pixel_traits(fmt).sample_bits == 8 ? CV_8UC3
+         : -1;
+}
+
+constexpr bool pixelPlainCopyable(uint32_t fmt) {
+    return funny_pixel_traits(fmt).packing == FunnyPixelPacking::Plain && !funny_pixel_traits(fmt).bayer &&
+           pixelMatType(fmt) >= 0;
+}
+
+constexpr PixelKernel pixelKernelFor(uint32_t fmt, PixelTarget target) {
+    return funny_pixel_traits(fmt).packing == FunnyPixelPacking::Unknown ? PixelKernel::None
+         // CSI灰度四种用途都解包为16位
+         : funny_pixel_traits(fmt).packing == FunnyPixelPacking::CsiPacked && !funny_pixel_traits(fmt).bayer
+           ? PixelKernel::CsiMono
+         : target == PixelTarget::Color || target == PixelTarget::Image
+           ? (funny_pixel_traits(fmt).bayer ? PixelKernel::Bayer
+            : funny_pixel_traits(fmt).packing == FunnyPixelPacking::Compressed ? PixelKernel::Jpeg
+            : funny_pixel_traits(fmt).packing == FunnyPixelPacking::Yuv422 ? PixelKernel::Yuv422
+            : !pixelPlainCopyable(fmt) ? PixelKernel::None
+            : funny_pixel_traits(fmt).rgb_order ? PixelKernel::SwapRB
+            : target == PixelTarget::Color && funny_pixel_traits(fmt).channels == 1
+              ? (pixelMatType(fmt) == CV_8UC1 ? PixelKernel::Gray2BGR : PixelKernel::None)
+            : PixelKernel::Copy)
+         : target == PixelTarget::Ir
+           ? (pixelPlainCopyable(fmt) && funny_pixel_traits(fmt).channels == 1 && fmt != TY_PIXEL_FORMAT_DEPTH16
+              ? PixelKernel::Copy : PixelKernel::None)
+         : pixelPlainCopyable(fmt) && pixelMatType(fmt) == CV_16U ? PixelKernel::Copy
+         : PixelKernel::None;
+}
+
+// 各转换内核，Src为编译期像素格式
+template<uint32_t Src, PixelKernel K>
+struct PixelKernelImpl {
+    static int run(const TY_IMAGE_DATA*, funny_Mat*, TY_ISP_HANDLE, bool) { return -1; }
+};
+
+// 输出尺寸和类型不变时复用dst的缓冲区；dst为视图时重新分配，不写入被引用的数据
+inline void pixelEnsure(funny_Mat* dst, int rows, int cols, int type) {
+    if (dst->empty() || dst->isView() || dst->rows() != rows || dst->cols() != cols || dst->type() != type) {
+        *dst = funny_Mat(rows, cols, type);
     }
-    else if (img->pixelFormat == CSI_MONO10) {
-        funny_Mat raw16(img->height, img->width, toInt(PixelFormat::CV_16U));
-        int ret = parseCsiRaw10(reinterpret_cast<uint8_t*>(img->buffer), raw16, img->width, img->height);
-        *pIr = raw16.clone();
-        return ret;
+}
+
+template<uint32_t Src>
+struct PixelKernelImpl<Src, PixelKernel::Copy> {
+    static int run(const TY_IMAGE_DATA* img, funny_Mat* dst, TY_ISP_HANDLE, bool copy) {
+        if (!copy) {
+            *dst = funny_Mat(img->height, img->width, pixelMatType(Src), img->buffer);
+            return 0;
+        }
+        pixelEnsure(dst, img->height, img->width, pixelMatType(Src));
+        memcpy(dst->data(), img->buffer, static_cast<size_t>(funny_pixel_row_bytes(Src, img->width)) * img->height);
+        return 0;
     }
-    else if (img->pixelFormat == CSI_MONO12) {
-        funny_Mat raw16(img->height, img->width, toInt(PixelFormat::CV_16U));
-        int ret = parseCsiRaw12(reinterpret_cast<uint8_t*>(img->buffer), raw16, img->width, img->height);
-        *pIr = raw16.clone();
-        return ret;
+};
+
+template<uint32_t Src>
+struct PixelKernelImpl<Src, PixelKernel::SwapRB> {
+    static int run(const TY_IMAGE_DATA* img, funny_Mat* dst, TY_ISP_HANDLE, bool) {
+        pixelEnsure(dst, img->height, img->width, CV_8UC3);
+        const uint8_t* src = static_cast<const uint8_t*>(img->buffer);
+        uint8_t* out = dst->data();
+        for (int i = 0; i < img->height * img->width; ++i) {
+            out[i*3 + 0] = src[i*3 + 2]; // B
+            out[i*3 + 1] = src[i*3 + 1]; // G
+            out[i*3 + 2] = src[i*3 + 0]; // R
+        }
+        return 0;
     }
-    else {
-        return -1;
+};
+
+template<uint32_t Src>
+struct PixelKernelImpl<Src, PixelKernel::Gray2BGR> {
+    static int run(const TY_IMAGE_DATA* img, funny_Mat* dst, TY_ISP_HANDLE, bool) {
+        pixelEnsure(dst, img->height, img->width, CV_8UC3);
+        const uint8_t* gray = static_cast<const uint8_t*>(img->buffer);
+        uint8_t* out = dst->data();
+        for (int i = 0; i < img->height * img->width; i++) {
+            out[i*3] = gray[i];
+            out[i*3 + 1] = gray[i];
+            out[i*3 + 2] = gray[i];
+        }
+        return 0;
     }
-    return 0;
-}
+};
 
-inline int parseColorFrame(const TY_IMAGE_DATA* img, funny_Mat* pColor, TY_ISP_HANDLE color_isp_handle) {
-    int ret = 0;
-    if (!img || !pColor) {
-        return -1;
+template<uint32_t Src>
+struct PixelKernelImpl<Src, PixelKernel::Yuv422> {
+    static int run(const TY_IMAGE_DATA* img, funny_Mat* dst, TY_ISP_HANDLE, bool) {
+        funny_Mat yuv(img->height, img->width, toInt(PixelFormat::CV_8UC2), img->buffer);
+        cvtColor(yuv, *dst, static_cast<int>(Src == TY_PIXEL_FORMAT_YVYU ? ColorConversionCode::YUV2BGR_YVYU
+                                                                        : ColorConversionCode::YUV2BGR_YUYV));
+        return 0;
     }
-    
-    if (img->pixelFormat == JPEG){
+};
+
+template<uint32_t Src>
+struct PixelKernelImpl<Src, PixelKernel::Jpeg> {
+    static int run(const TY_IMAGE_DATA* img, funny_Mat* dst, TY_ISP_HANDLE, bool) {
         std::vector<uint8_t> _v((uint8_t*)img->buffer, (uint8_t*)img->buffer + img->size);
-        bool decode_success = imdecode(_v, 0, *pColor);
-        if (!(decode_success && img->width == pColor->cols() && img->height == pColor->rows())) {
+        bool decode_success = imdecode(_v, 0, *dst);
+        if (!(decode_success && img->width == dst->cols() && img->height == dst->rows())) {
             std::cerr << "JPEG解码失败或尺寸不匹配" << std::endl;
             return -1;
         }
+        return 0;
     }
-    else if (img->pixelFormat == YVYU){
-        funny_Mat yuv(img->height, img->width, toInt(PixelFormat::CV_8UC2), img->buffer);
-        cvtColor(yuv, *pColor, static_cast<int>(ColorConversionCode::YUV2BGR_YVYU));
-    }
-    else if (img->pixelFormat == YUYV){
-        funny_Mat yuv(img->height, img->width, toInt(PixelFormat::CV_8UC2), img->buffer);
-        cvtColor(yuv, *pColor, static_cast<int>(ColorConversionCode::YUV2BGR_YUYV));
-    }
-    else if (img->pixelFormat == RGB){
-        funny_Mat rgb(img->height, img->width, toInt(PixelFormat::CV_8UC3), img->buffer);
-        // 手动将RGB转为BGR
-        *pColor = funny_Mat(img->height, img->width, toInt(PixelFormat::CV_8UC3));
-        uint8_t* src = (uint8_t*)rgb.data();
-        uint8_t* dst = (uint8_t*)pColor->data();
-        for (int i = 0; i < img->height * img->width; ++i) {
-            dst[i*3 + 0] = src[i*3 + 2]; // B
-            dst[i*3 + 1] = src[i*3 + 1]; // G
-            dst[i*3 + 2] = src[i*3 + 0]; // R
-        }
+};
+
+template<uint32_t Src>
+struct PixelKernelImpl<Src, PixelKernel::CsiMono> {
+    static int run(const TY_IMAGE_DATA* img, funny_Mat* dst, TY_ISP_HANDLE, bool) {
+        uint8_t* src = reinterpret_cast<uint8_t*>(img->buffer);
+        return FunnyPixelFormat<Src>::bits == 10 ? parseCsiRaw10(src, *dst, img->width, img->height)
+                                                 : parseCsiRaw12(src, *dst, img->width, img->height);
     }
-    else if (img->pixelFormat == BGR){
-        *pColor = funny_Mat(img->height, img->width, toInt(PixelFormat::CV_8UC3), img->buffer).clone();
+};
+
+template<uint32_t Src>
+struct PixelKernelImpl<Src, PixelKernel::Bayer> {
+    static int run(const TY_IMAGE_DATA* img, funny_Mat* dst, TY_ISP_HANDLE color_isp_handle, bool) {
+        return FunnyPixelFormat<Src>::bits == 8 ? parseBayer8Frame(img, dst, color_isp_handle)
+             : FunnyPixelFormat<Src>::bits == 10 ? parseBayer10Frame(img, dst)
+             : parseBayer12Frame(img, dst);
     }
-    else if (img->pixelFormat == BAYER8GBRG || 
-             img->pixelFormat == BAYER8BGGR || 
-             img->pixelFormat == BAYER8GRBG || 
-             img->pixelFormat == BAYER8RGGB) 
-    {
-        ret = parseBayer8Frame(img, pColor, color_isp_handle);
+};
+
+// 未知格式或不支持的组合在编译期得到空函数指针
+template<uint32_t Src, PixelTarget Dst>
+struct PixelConvert {
+    static const PixelKernel kernel = pixelKernelFor(Src, Dst);
+    static int run(const TY_IMAGE_DATA* img, funny_Mat* dst, TY_ISP_HANDLE color_isp_handle, bool copy) {
+        return PixelKernelImpl<Src, pixelKernelFor(Src, Dst)>::run(img, dst, color_isp_handle, copy);
     }
-    else if (img->pixelFormat == MONO){
-        *pColor = funny_Mat(img->height, img->width, toInt(PixelFormat::CV_8UC3));
-        uint8_t* gray_data = (uint8_t*)img->buffer;
-        uint8_t* color_data = pColor->data();
-        for (int i = 0; i < img->height * img->width; i++) {
-          color_data[i*3] = gray_data[i];
-          color_data[i*3 + 1] = gray_data[i];
-          color_data[i*3 + 2] = gray_data[i];
+    static PixelConvertFn fn() { return kernel == PixelKernel::None ? nullptr : &run; }
+};
+
+struct PixelConvertEntry {
+    uint32_t       format;
+    PixelConvertFn fn[4];   // 按PixelTarget索引
+};
+
+#define PIXEL_CONVERT_ENTRY(fmt) \
+    { fmt, { PixelConvert<fmt, PixelTarget::Color>::fn(), PixelConvert<fmt, PixelTarget::Ir>::fn(), \
+             PixelConvert<fmt, PixelTarget::Depth>::fn(), PixelConvert<fmt, PixelTarget::Image>::fn() } }
+
+inline PixelConvertFn findPixelConvert(uint32_t fmt, PixelTarget target) {
+    static const PixelConvertEntry table[] = {
+        PIXEL_CONVERT_ENTRY(TY_PIXEL_FORMAT_MONO),
+        PIXEL_CONVERT_ENTRY(TY_PIXEL_FORMAT_BAYER8GB),
+        PIXEL_CONVERT_ENTRY(TY_PIXEL_FORMAT_BAYER8BG),
+        PIXEL_CONVERT_ENTRY(TY_PIXEL_FORMAT_BAYER8GR),
+        PIXEL_CONVERT_ENTRY(TY_PIXEL_FORMAT_BAYER8RG),
+        PIXEL_CONVERT_ENTRY(TY_PIXEL_FORMAT_CSI_MONO10),
+        PIXEL_CONVERT_ENTRY(TY_PIXEL_FORMAT_CSI_BAYER10GRBG),
+        PIXEL_CONVERT_ENTRY(TY_PIXEL_FORMAT_CSI_BAYER10RGGB),
+        PIXEL_CONVERT_ENTRY(TY_PIXEL_FORMAT_CSI_BAYER10GBRG),
+        PIXEL_CONVERT_ENTRY(TY_PIXEL_FORMAT_CSI_BAYER10BGGR),
+        PIXEL_CONVERT_ENTRY(TY_PIXEL_FORMAT_CSI_MONO12),
+        PIXEL_CONVERT_ENTRY(TY_PIXEL_FORMAT_CSI_BAYER12GRBG),
+        PIXEL_CONVERT_ENTRY(TY_PIXEL_FORMAT_CSI_BAYER12RGGB),
+        PIXEL_CONVERT_ENTRY(TY_PIXEL_FORMAT_CSI_BAYER12GBRG),
+        PIXEL_CONVERT_ENTRY(TY_PIXEL_FORMAT_CSI_BAYER12BGGR),
+        PIXEL_CONVERT_ENTRY(TY_PIXEL_FORMAT_DEPTH16),
+        PIXEL_CONVERT_ENTRY(TY_PIXEL_FORMAT_YVYU),
+        PIXEL_CONVERT_ENTRY(TY_PIXEL_FORMAT_YUYV),
+        PIXEL_CONVERT_ENTRY(TY_PIXEL_FORMAT_MONO16),
+        PIXEL_CONVERT_ENTRY(TY_PIXEL_FORMAT_TOF_IR_MONO16),
+        PIXEL_CONVERT_ENTRY(TY_PIXEL_FORMAT_RGB),
+        PIXEL_CONVERT_ENTRY(TY_PIXEL_FORMAT_BGR),
+        PIXEL_CONVERT_ENTRY(TY_PIXEL_FORMAT_JPEG),
+        PIXEL_CONVERT_ENTRY(TY_PIXEL_FORMAT_MJPG),
+        PIXEL_CONVERT_ENTRY(TY_PIXEL_FORMAT_RGB48),
+        PIXEL_CONVERT_ENTRY(TY_PIXEL_FORMAT_BGR48),
+        PIXEL_CONVERT_ENTRY(TY_PIXEL_FORMAT_XYZ48),
+    };
+    for (size_t i = 0; i < sizeof(table) / sizeof(table[0]); i++) {
+        if (table[i].format == fmt) {
+            return table[i].fn[static_cast<int>(target)];
         }
     }
-    else if (img->pixelFormat == CSI_MONO10){
-        funny_Mat gray16(img->height, img->width, toInt(PixelFormat::CV_16U));
-        ret = parseCsiRaw10(reinterpret_cast<uint8_t*>(img->buffer), gray16, img->width, img->height);
-        *pColor = gray16.clone();
+    return nullptr;
+}
+
+#undef PIXEL_CONVERT_ENTRY
+
+// 按数据流缓存转换函数，像素格式不变时不再查表
+class PixelConverter {
+public:
+    // copy为false时无需转换的格式输出视图，见parseIrFrame
+    explicit PixelConverter(PixelTarget target, bool copy = true)
+        : _target(target), _copy(copy), _format(TY_PIXEL_FORMAT_UNDEFINED), _fn(nullptr) {}
+
+    int operator()(const TY_IMAGE_DATA* img, funny_Mat* dst, TY_ISP_HANDLE color_isp_handle = nullptr) {
+        if (!img || !dst || !img->buffer) {
+            return -1;
+        }
+        if (img->pixelFormat != _format) {
+            _format = img->pixelFormat;
+            _fn = findPixelConvert(_format, _target);
+        }
+        return _fn ? _fn(img, dst, color_isp_handle, _copy) : -1;
     }
-    else {
+
+    bool supports(uint32_t fmt) const { return findPixelConvert(fmt, _target) != nullptr; }
+
+private:
+    PixelTarget    _target;
+    bool           _copy;
+    uint32_t       _format;
+    PixelConvertFn _fn;
+};
+
+// 函数实现
+inline int parseIrFrame(const TY_IMAGE_DATA* img, funny_Mat* pIr, bool copy) {
+    if (!img || !pIr) {
         return -1;
     }
-    return ret;
+    PixelConvertFn fn = findPixelConvert(img->pixelFormat, PixelTarget::Ir);
+    return fn ? fn(img, pIr, nullptr, copy) : -1;
 }
 
-inline int parseDepthFrame(const TY_IMAGE_DATA* img, funny_Mat* pDepth) {
-    if (!img || !pDepth) {
+inline int parseColorFrame(const TY_IMAGE_DATA* img, funny_Mat* pColor, TY_ISP_HANDLE color_isp_handle, bool copy) {
+    if (!img || !pColor) {
         return -1;
     }
-    
-    if (img->pixelFormat == DEPTH16){
-        *pDepth = funny_Mat(img->height, img->width, toInt(PixelFormat::CV_16U), img->buffer).clone();
-    }
-    else if(img->pixelFormat == MONO16){
-        *pDepth = funny_Mat(img->height, img->width, toInt(PixelFormat::CV_16U), img->buffer).clone();
-    }
-    else if(img->pixelFormat == TOF_IR_MONO16){
-        *pDepth = funny_Mat(img->height, img->width, toInt(PixelFormat::CV_16U), img->buffer).clone();
-    }
-    else if(img->pixelFormat == CSI_MONO10){
-        funny_Mat raw16(img->height, img->width, toInt(PixelFormat::CV_16U));
-        int ret = parseCsiRaw10(reinterpret_cast<uint8_t*>(img->buffer), raw16, img->width, img->height);
-        *pDepth = raw16.clone();
-        return ret;
-    }
-    else if(img->pixelFormat == CSI_MONO12){
-        funny_Mat raw16(img->height, img->width, toInt(PixelFormat::CV_16U));
-        int ret = parseCsiRaw12(reinterpret_cast<uint8_t*>(img->buffer), raw16, img->width, img->height);
-        *pDepth = raw16.clone();
-        return ret;
-    }
-    else {
+    PixelConvertFn fn = findPixelConvert(img->pixelFormat, PixelTarget::Color);
+    return fn ? fn(img, pColor, color_isp_handle, copy) : -1;
+}
+
+inline int parseDepthFrame(const TY_IMAGE_DATA* img, funny_Mat* pDepth, bool copy) {
+    if (!img || !pDepth) {
         return -1;
     }
-    return 0;
+    PixelConvertFn fn = findPixelConvert(img->pixelFormat, PixelTarget::Depth);
+    return fn ? fn(img, pDepth, nullptr, copy) : -1;
 }
 
-inline int parseImage(const TY_IMAGE_DATA* img, funny_Mat* image, TY_ISP_HANDLE color_isp_handle) {
-    int ret = 0;
+inline int parseImage(const TY_IMAGE_DATA* img, funny_Mat* image, TY_ISP_HANDLE color_isp_handle, bool copy) {
     if (!img || !image) {
         return -1;
     }
-    
-    if (img->pixelFormat == JPEG){
-        std::vector<uint8_t> _v((uint8_t*)img->buffer, (uint8_t*)img->buffer + img->size);
-        bool decode_success = imdecode(_v, 0, *image);
-        if (!(decode_success && img->width == image->cols() && img->height == image->rows())) {
-            std::cerr << "JPEG解码失败或尺寸不匹配" << std::endl;
-            return -1;
-        }
-    }
-    else if (img->pixelFormat == YVYU){
-        funny_Mat yuv(img->height, img->width, toInt(PixelFormat::CV_8UC2), img->buffer);
-        cvtColor(yuv, *image, static_cast<int>(ColorConversionCode::YUV2BGR_YVYU));
-    }
-    else if (img->pixelFormat == YUYV){
-        funny_Mat yuv(img->height, img->width, toInt(PixelFormat::CV_8UC2), img->buffer);
-        cvtColor(yuv, *image, static_cast<int>(ColorConversionCode::YUV2BGR_YUYV));
-    }
-    else if (img->pixelFormat == RGB){
-        funny_Mat rgb(img->height, img->width, toInt(PixelFormat::CV_8UC3), img->buffer);
-        // 手动将RGB转为BGR
-        *image = funny_Mat(img->height, img->width, toInt(PixelFormat::CV_8UC3));
-        uint8_t* src = (uint8_t*)rgb.data();
-        uint8_t* dst = (uint8_t*)image->data();
-        for (int i = 0; i < img->height * img->width; ++i) {
-            dst[i*3 + 0] = src[i*3 + 2]; // B
-            dst[i*3 + 1] = src[i*3 + 1]; // G
-            dst[i*3 + 2] = src[i*3 + 0]; // R
-        }
-    }
-    else if (img->pixelFormat == BGR){
-        *image = funny_Mat(img->height, img->width, toInt(PixelFormat::CV_8UC3), img->buffer).clone();
-    }
-    else if (img->pixelFormat == MONO){
-        *image = funny_Mat(img->height, img->width, toInt(PixelFormat::CV_8UC1), img->buffer).clone();
-    }
-    else if (img->pixelFormat == MONO16){
-        *image = funny_Mat(img->height, img->width, toInt(PixelFormat::CV_16U), img->buffer).clone();
-    }
-    else if (img->pixelFormat == DEPTH16){
-        *image = funny_Mat(img->height, img->width, toInt(PixelFormat::CV_16U), img->buffer).clone();
-    }
-    else if (img->pixelFormat == TOF_IR_MONO16){
-        *image = funny_Mat(img->height, img->width, toInt(PixelFormat::CV_16U), img->buffer).clone();
-    }
-    else if (img->pixelFormat == CSI_MONO10){
-        funny_Mat gray16(img->height, img->width, toInt(PixelFormat::CV_16U));
-        ret = parseCsiRaw10(reinterpret_cast<uint8_t*>(img->buffer), gray16, img->width, img->height);
-        *image = gray16.clone();
-    }
-    else if (img->pixelFormat == CSI_MONO12) {
-        funny_Mat gray16(img->height, img->width, toInt(PixelFormat::CV_16U));
-        ret = parseCsiRaw12(reinterpret_cast<uint8_t*>(img->buffer), gray16, img->width, img->height);
-        *image = gray16.clone();
-    } 
-    else if (img->pixelFormat == MONO16 || img->pixelFormat==TOF_IR_MONO16){
-        *image = funny_Mat(img->height, img->width, toInt(PixelFormat::CV_16U), img->buffer).clone();
-    }
-    else {
+    PixelConvertFn fn = findPixelConvert(img->pixelFormat, PixelTarget::Image);
+    if (!fn) {
         std::cout << "警告: parseImage中不支持的像素格式: " << img->pixelFormat << std::endl;
-        ret = -1;
+        return -1;
     }
+    return fn(img, image, color_isp_handle, copy);
+}
 
-    return ret;
+// TY_IMAGE_DATA转funny_Mat视图，不复制数据；keeper为数据的所有者，可为空(由调用方保证缓冲区有效)
+// 只支持无需转换的格式(8/16位灰度、BGR/RGB原样)，其他格式返回空矩阵
+inline funny_Mat imageView(const TY_IMAGE_DATA& img, std::shared_ptr<void> keeper = nullptr) {
+    const FunnyPixelTraits& t = funny_pixel_traits(img.pixelFormat);
+    if (!img.buffer || t.packing != FunnyPixelPacking::Plain || t.bayer || pixelMatType(img.pixelFormat) < 0) {
+        return funny_Mat();
+    }
+    return funny_Mat(img.height, img.width, pixelMatType(img.pixelFormat), img.buffer, std::move(keeper));
 }
 
-// 解析帧数据
+// 缩小解码可用的最大倍数(1/2/4)：缩小后宽高仍不小于min_w x min_h
+inline int reducedScaleFor(int src_w, int src_h, int min_w, int min_h) {
+    int scale = 4;
+    while (scale > 1 && (src_w / scale < min_w || src_h / scale < min_h)) {
+        scale /= 2;
+    }
+    return scale;
+}
+
+// 解析帧数据；copy为false时深度图和灰度IR图为引用frame缓冲区的视图，见parseIrFrame
 inline int parseFrame(const TY_FRAME_DATA& frame, funny_Mat* pDepth
                              , funny_Mat* pLeftIR, funny_Mat* pRightIR
-                             , funny_Mat* pColor, TY_ISP_HANDLE color_isp_handle)
+                             , funny_Mat* pColor, TY_ISP_HANDLE color_isp_handle
+                             , bool copy = true)
 {
     for (int i = 0; i < frame.validCount; i++){
         if (frame.image[i].status != TY_STATUS_OK) continue;
 
         // get depth image
         if (pDepth && frame.image[i].componentID == TY_COMPONENT_DEPTH_CAM){
+                funny_Mat temp(frame.image[i].height, frame.image[i].width
+                          , toInt(PixelFormat::CV_16U), frame.image[i].buffer);
                 if (frame.image[i].pixelFormat == XYZ48) {
                 // 注意：XYZ48格式需要自定义实现
-                funny_Mat temp(frame.image[i].height, frame.image[i].width, toInt(PixelFormat::CV_16U), frame.image[i].buffer);
-                *pDepth = temp.clone();
                 std::cout << "警告: parseFrame中XYZ48格式处理需要自定义实现" << std::endl;
                 }
-                else {
-                funny_Mat temp(frame.image[i].height, frame.image[i].width
-                          , toInt(PixelFormat::CV_16U), frame.image[i].buffer);
-                *pDepth = temp.clone();
-                }
+                *pDepth = copy ? temp.clone() : std::move(temp);
         }
         // get left ir image
         if (pLeftIR && frame.image[i].componentID == TY_COMPONENT_IR_CAM_LEFT){
-            parseIrFrame(&frame.image[i], pLeftIR);
+            parseIrFrame(&frame.image[i], pLeftIR, copy);
         }
         // get right ir image
         if (pRightIR && frame.image[i].componentID == TY_COMPONENT_IR_CAM_RIGHT){
-            parseIrFrame(&frame.image[i], pRightIR);
+            parseIrFrame(&frame.image[i], pRightIR, copy);
         }
         // get BGR
         if (pColor && frame.image[i].componentID == TY_COMPONENT_RGB_CAM){
-            parseColorFrame(&frame.image[i], pColor, color_isp_handle);
+            parseColorFrame(&frame.image[i], pColor, color_isp_handle, copy);
         }
     }
 
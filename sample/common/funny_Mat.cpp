@@ -1,6 +1,13 @@
 // funny_Mat.cpp - 自定义矩阵类的实现
 
 #include "funny_Mat.hpp"
+#include "funny_yuv.hpp"
+#include "funny_jpeg.hpp"
+#include "funny_csi.hpp"
+#include "funny_bayer.hpp"
+#include "funny_pixel.hpp"
+#include "funny_resize.hpp"
+#include "TyIsp.h"
 #include <cstring>
 #include <iostream>
 
@@ -14,183 +21,204 @@ void cvtColor(const funny_Mat& src, funny_Mat& dst, int code) {
         return;
     }
     
-    // 根据转换代码执行不同的转换
+    YUV422Layout layout;
     switch (code) {
-        case static_cast<int>(ColorConversionCode::YUV2BGR_YVYU): {
-            // 确保源图像是8UC2类型
-            if (src.type() != CV_8UC2) {
-                std::cerr << "错误: YVYU转换需要8UC2类型的源图像" << std::endl;
-                return;
-            }
-            
-            // 创建目标图像
-            if (dst.rows() != src.rows() || dst.cols() != src.cols() || dst.type() != CV_8UC3) {
-                dst = funny_Mat(src.rows(), src.cols(), CV_8UC3);
-            }
-            
-            // YVYU到BGR的转换
-            const uint8_t* yvyu_data = src.data();
-            uint8_t* bgr_data = dst.data();
-            
-            for (int i = 0; i < src.rows(); ++i) {
-                for (int j = 0; j < src.cols(); ++j) {
-                    // YVYU格式是: Y0 V0 Y1 U0 Y2 V1 Y3 U1 ...
-                    int idx = i * src.cols() + j;
-                    int yvyu_idx = idx * 2;
-                    int bgr_idx = idx * 3;
-                    
-                    // 提取YUV分量
-                    uint8_t Y, U, V;
-                    if (j % 2 == 0) {
-                        Y = yvyu_data[yvyu_idx];
-                        V = yvyu_data[yvyu_idx + 1];
-                        // 对于偶数列，U来自下一个像素对的U分量
-                        if (j + 1 < src.cols()) {
-                            U = yvyu_data[yvyu_idx + 3];
-                        } else {
-                            U = 128; // 默认值
-                        }
-                    } else {
-                        Y = yvyu_data[yvyu_idx];
-                        U = yvyu_data[yvyu_idx + 1];
-                        // 对于奇数列，V来自上一个像素对的V分量
-                        V = yvyu_data[yvyu_idx - 1];
-                    }
-                    
-                    // YUV到BGR的转换
-                    // 公式参考: https://en.wikipedia.org/wiki/YUV
-                    int C = Y - 16;
-                    int D = U - 128;
-                    int E = V - 128;
-                    
-                    int R = (298 * C + 409 * E + 128) >> 8;
-                    int G = (298 * C - 100 * D - 208 * E + 128) >> 8;
-                    int B = (298 * C + 516 * D + 128) >> 8;
-                    
-                    // 确保值在0-255范围内
-                    R = (R < 0) ? 0 : (R > 255) ? 255 : R;
-                    G = (G < 0) ? 0 : (G > 255) ? 255 : G;
-                    B = (B < 0) ? 0 : (B > 255) ? 255 : B;
-                    
-                    // 存储BGR值
-                    bgr_data[bgr_idx] = static_cast<uint8_t>(B);
-                    bgr_data[bgr_idx + 1] = static_cast<uint8_t>(G);
-                    bgr_data[bgr_idx + 2] = static_cast<uint8_t>(R);
-                }
-            }
+        case static_cast<int>(ColorConversionCode::YUV2BGR_YVYU):
+            layout = YUV422Layout::YVYU;
             break;
-        }
-        
-        case static_cast<int>(ColorConversionCode::YUV2BGR_YUYV): {
-            // 确保源图像是8UC2类型
-            if (src.type() != CV_8UC2) {
-                std::cerr << "错误: YUYV转换需要8UC2类型的源图像" << std::endl;
-                return;
-            }
-            
-            // 创建目标图像
-            if (dst.rows() != src.rows() || dst.cols() != src.cols() || dst.type() != CV_8UC3) {
-                dst = funny_Mat(src.rows(), src.cols(), CV_8UC3);
-            }
-            
-            // YUYV到BGR的转换
-            const uint8_t* yuyv_data = src.data();
-            uint8_t* bgr_data = dst.data();
-            
-            for (int i = 0; i < src.rows(); ++i) {
-                for (int j = 0; j < src.cols(); ++j) {
-                    // YUYV格式是: Y0 U0 Y1 V0 Y2 U1 Y3 V1 ...
-                    int idx = i * src.cols() + j;
-                    int yuyv_idx = idx * 2;
-                    int bgr_idx = idx * 3;
-                    
-                    // 提取YUV分量
-                    uint8_t Y, U, V;
-                    if (j % 2 == 0) {
-                        Y = yuyv_data[yuyv_idx];
-                        U = yuyv_data[yuyv_idx + 1];
-                        // 对于偶数列，V来自下一个像素对的V分量
-                        if (j + 1 < src.cols()) {
-                            V = yuyv_data[yuyv_idx + 3];
-                        } else {
-                            V = 128; // 默认值
-                        }
-                    } else {
-                        Y = yuyv_data[yuyv_idx];
-                        V = yuyv_data[yuyv_idx + 1];
-                        // 对于奇数列，U来自上一个像素对的U分量
-                        U = yuyv_data[yuyv_idx - 1];
-                    }
-                    
-                    // YUV到BGR的转换
-                    int C = Y - 16;
-                    int D = U - 128;
-                    int E = V - 128;
-                    
-                    int R = (298 * C + 409 * E + 128) >> 8;
-                    int G = (298 * C - 100 * D - 208 * E + 128) >> 8;
-                    int B = (298 * C + 516 * D + 128) >> 8;
-                    
-                    // 确保值在0-255范围内
-                    R = (R < 0) ? 0 : (R > 255) ? 255 : R;
-                    G = (G < 0) ? 0 : (G > 255) ? 255 : G;
-                    B = (B < 0) ? 0 : (B > 255) ? 255 : B;
-                    
-                    // 存储BGR值
-                    bgr_data[bgr_idx] = static_cast<uint8_t>(B);
-                    bgr_data[bgr_idx + 1] = static_cast<uint8_t>(G);
-                    bgr_data[bgr_idx + 2] = static_cast<uint8_t>(R);
-                }
-            }
+        case static_cast<int>(ColorConversionCode::YUV2BGR_YUYV):
+            layout = YUV422Layout::YUYV;
             break;
-        }
-        
         default:
             std::cerr << "错误: 不支持的颜色转换代码" << std::endl;
             return;
     }
+
+    // 确保源图像是8UC2类型
+    if (src.type() != CV_8UC2) {
+        std::cerr << "错误: YUV422转换需要8UC2类型的源图像" << std::endl;
+        return;
+    }
+    
+    // 创建目标图像
+    if (dst.isView() || dst.rows() != src.rows() || dst.cols() != src.cols() || dst.type() != CV_8UC3) {
+        dst = funny_Mat(src.rows(), src.cols(), CV_8UC3);
+    }
+    
+    // 按宏像素向量化转换；需要按行带并行时直接调用funny_yuv422_to_bgr
+    funny_yuv422_to_bgr(src.data(), src.cols() * 2, dst.data(), dst.cols() * 3,
+                        src.cols(), src.rows(), layout);
 }
 
 // 图像解码函数实现
+// 支持8位顺序编码的JPEG/MJPG；flags为IMREAD_REDUCED_COLOR_2/4/8时在DCT域直接缩小
 bool imdecode(const std::vector<uint8_t>& buf, int flags, funny_Mat& dst) {
-    // 注意：这是一个简化实现，实际项目中可能需要使用第三方库或系统API来解码JPEG图像
-    // 这里我们假设输入是JPEG格式，并模拟解码过程
-    
     if (buf.empty()) {
         std::cerr << "错误: 输入缓冲区为空" << std::endl;
         return false;
     }
-    
-    // 检查是否为JPEG格式（简化检查）
-    if (buf.size() < 2 || buf[0] != 0xFF || buf[1] != 0xD8) {
-        std::cerr << "错误: 不是有效的JPEG图像" << std::endl;
+
+    FunnyJpegInfo info;
+    if (!funny_jpeg_info(buf.data(), buf.size(), info)) {
+        std::cerr << "错误: 不是有效的JPEG图像或编码方式不受支持" << std::endl;
         return false;
     }
-    
-    // 注意：在实际应用中，这里需要使用真正的JPEG解码库
-    // 这里我们只是创建一个模拟的RGB图像
-    // 实际项目中，建议使用libjpeg、stb_image等轻量级库
-    
-    // 为了演示，我们创建一个固定大小的RGB图像
-    // 注意：这只是一个占位符实现
-    int width = 640;  // 假设宽度
-    int height = 480; // 假设高度
-    
-    dst = funny_Mat(height, width, CV_8UC3);
-    
-    // 填充一些测试数据（渐变）
-    uint8_t* data = dst.data();
-    for (int i = 0; i < height; ++i) {
-        for (int j = 0; j < width; ++j) {
-            int idx = i * width * 3 + j * 3;
-            data[idx] = static_cast<uint8_t>((i * 255) / height);     // B
-            data[idx + 1] = static_cast<uint8_t>((j * 255) / width);  // G
-            data[idx + 2] = static_cast<uint8_t>(((i + j) * 255) / (height + width)); // R
+
+    int scale = 1;
+    if (flags & 64) {
+        scale = 8;
+    } else if (flags & 32) {
+        scale = 4;
+    } else if (flags & 16) {
+        scale = 2;
+    }
+    int width = funny_jpeg_scaled_size(info.width, scale);
+    int height = funny_jpeg_scaled_size(info.height, scale);
+
+    // 尺寸和类型不变时复用目标缓冲(视图除外)，连续解码视频流时不必每帧重新分配
+    if (dst.isView() || dst.rows() != height || dst.cols() != width || dst.type() != CV_8UC3) {
+        dst = funny_Mat(height, width, CV_8UC3);
+    }
+    return funny_jpeg_decode(buf.data(), buf.size(), scale, dst.data(), width * 3, info.restart_interval > 0);
+}
+
+// CSI打包格式解码为16位，数值保持原始位宽(低位对齐)，深度图仍以毫米为单位
+// dst尺寸和类型不变且不是视图时直接复用
+static int parseCsiRaw(uint8_t* src, funny_Mat& dst, int width, int height, int bits) {
+    if (!src || width <= 0 || height <= 0) {
+        return -1;
+    }
+    if (dst.isView() || dst.rows() != height || dst.cols() != width || dst.type() != CV_16U) {
+        dst = funny_Mat(height, width, CV_16U);
+    }
+    bool ok = funny_csi_unpack(src, 0, reinterpret_cast<uint16_t*>(dst.data()), 0,
+                               width, height, bits, 0);
+    return ok ? 0 : -1;
+}
+
+void parseCsiRaw8(uint8_t* src, funny_Mat& dst, int width, int height) {
+    dst = funny_Mat(height, width, CV_8UC1, src).clone();
+}
+
+int parseCsiRaw10(uint8_t* src, funny_Mat& dst, int width, int height) {
+    return parseCsiRaw(src, dst, width, height, 10);
+}
+
+int parseCsiRaw12(uint8_t* src, funny_Mat& dst, int width, int height) {
+    return parseCsiRaw(src, dst, width, height, 12);
+}
+
+// Bayer原始图像在主机端解马赛克为BGR(边缘自适应，按行带并行)，BAYER8与CSI_BAYER10/12共用
+// color_isp_handle只为保持接口不变，不经过SDK ISP；需要ISP的黑电平/自动白平衡时直接调用TYISPProcessImage
+static int parseBayerFrame(const TY_IMAGE_DATA* img, funny_Mat* pColor) {
+    BayerPattern pattern;
+    int bits = 0;
+    bool packed = false;
+    if (!img || !pColor || !funny_bayer_format(img->pixelFormat, pattern, bits, packed)) {
+        return -1;
+    }
+    if (pColor->isView() || pColor->rows() != img->height || pColor->cols() != img->width || pColor->type() != CV_8UC3) {
+        *pColor = funny_Mat(img->height, img->width, CV_8UC3);
+    }
+    FunnyBayerOptions options;
+    options.method = BayerDemosaic::EdgeAware;
+    options.parallel = true;
+    bool ok = funny_bayer_to_bgr(img->buffer, 0, pColor->data(), 0, img->width, img->height,
+                                 pattern, bits, packed, options);
+    return ok ? 0 : -1;
+}
+
+int parseBayer8Frame(const TY_IMAGE_DATA* img, funny_Mat* pColor, TY_ISP_HANDLE color_isp_handle) {
+    (void)color_isp_handle;
+    return parseBayerFrame(img, pColor);
+}
+
+int parseBayer10Frame(const TY_IMAGE_DATA* img, funny_Mat* pColor) {
+    return parseBayerFrame(img, pColor);
+}
+
+int parseBayer12Frame(const TY_IMAGE_DATA* img, funny_Mat* pColor) {
+    return parseBayerFrame(img, pColor);
+}
+
+// 缩小解码：在解码/解马赛克的同时按块平均，直接得到1/scale尺寸的BGR，不生成全分辨率中间图
+int parseColorFrameReduced(const TY_IMAGE_DATA* img, funny_Mat* pColor, int scale) {
+    if (!img || !pColor || !img->buffer || (scale != 1 && scale != 2 && scale != 4)) {
+        return -1;
+    }
+    const FunnyPixelTraits& t = funny_pixel_traits(img->pixelFormat);
+    if (t.packing == FunnyPixelPacking::Compressed) {
+        // JPEG按DCT域缩小，尺寸为向上取整
+        int flags = scale == 4 ? IMREAD_REDUCED_COLOR_4 : (scale == 2 ? IMREAD_REDUCED_COLOR_2 : IMREAD_COLOR);
+        std::vector<uint8_t> buf(static_cast<const uint8_t*>(img->buffer),
+                                 static_cast<const uint8_t*>(img->buffer) + img->size);
+        return imdecode(buf, flags, *pColor) ? 0 : -1;
+    }
+
+    const int w = img->width / scale;
+    const int h = img->height / scale;
+    if (w <= 0 || h <= 0) {
+        return -1;
+    }
+    if (pColor->isView() || pColor->rows() != h || pColor->cols() != w || pColor->type() != CV_8UC3) {
+        *pColor = funny_Mat(h, w, CV_8UC3);
+    }
+
+    if (t.packing == FunnyPixelPacking::Yuv422) {
+        YUV422Layout layout = img->pixelFormat == TY_PIXEL_FORMAT_YVYU ? YUV422Layout::YVYU : YUV422Layout::YUYV;
+        funny_yuv422_to_bgr_reduced(static_cast<const uint8_t*>(img->buffer), img->width * 2,
+                                    pColor->data(), w * 3, img->width, img->height, layout, scale, true);
+        return 0;
+    }
+    if (t.bayer) {
+        BayerPattern pattern;
+        int bits = 0;
+        bool packed = false;
+        if (!funny_bayer_format(img->pixelFormat, pattern, bits, packed)) {
+            return -1;
         }
+        FunnyBayerOptions options;
+        options.method = BayerDemosaic::EdgeAware;
+        options.parallel = true;
+        return funny_bayer_to_bgr_reduced(img->buffer, 0, pColor->data(), 0, img->width, img->height,
+                                          pattern, bits, packed, scale, options) ? 0 : -1;
     }
-    
-    std::cout << "警告: imdecode是简化实现，仅用于演示。实际项目中需要使用真正的JPEG解码库。" << std::endl;
-    return true;
+    if (t.packing == FunnyPixelPacking::Plain && t.channels == 3 && t.sample_bits == 8) {
+        funny_downscale_box(static_cast<const uint8_t*>(img->buffer), 0, 3, pColor->data(), 0,
+                            img->width, img->height, scale, t.rgb_order);
+        return 0;
+    }
+    return -1;
+}
+
+int buildPyramid(const funny_Mat& src, std::vector<funny_Mat>& dst, int maxlevel, bool parallel) {
+    const int type = src.type();
+    if (src.empty() || (type != CV_8UC1 && type != CV_8UC3 && type != CV_16U)) {
+        dst.clear();
+        return -1;
+    }
+
+    dst.resize(1);
+    dst[0] = src;
+    int level = 0;
+    while (level < maxlevel && dst[level].cols() >= 2 && dst[level].rows() >= 2) {
+        const funny_Mat& prev = dst[level];
+        funny_Mat next(prev.rows() / 2, prev.cols() / 2, type);
+        if (type == CV_16U) {
+            // 奇数宽高时按区域平均覆盖全部源像素
+            funny_resize_16bit(prev.cols(), prev.rows(), reinterpret_cast<const uint16_t*>(prev.data()),
+                               next.cols(), next.rows(), reinterpret_cast<uint16_t*>(next.data()),
+                               InterpolationMethod::AREA, parallel);
+        } else {
+            // 奇数宽高时舍弃最后一行/列
+            const int cn = (type == CV_8UC3) ? 3 : 1;
+            funny_downscale_box(prev.data(), prev.cols() * cn, cn, next.data(), 0,
+                                prev.cols(), prev.rows(), 2, false, parallel);
+        }
+        dst.push_back(std::move(next));
+        level++;
+    }
+    return level;
 }
 
 } // namespace percipio_layer
\ No newline at end of file
@@ -41,6 +41,14 @@ enum ColorConversionCode {
     YUV2BGR_YUYV = 1
 };
 
+// imdecode标志；缩小解码的取值与OpenCV的IMREAD_REDUCED_COLOR_*一致，0表示按原尺寸解码为BGR
+enum ImreadFlags {
+    IMREAD_COLOR = 0,
+    IMREAD_REDUCED_COLOR_2 = 17,
+    IMREAD_REDUCED_COLOR_4 = 33,
+    IMREAD_REDUCED_COLOR_8 = 65
+};
+
 // 3D点结构体
 struct funny_Point3f {
     float x, y, z;
@@ -65,7 +73,7 @@ public:
     funny_Mat(int rows, int cols, int type) 
         : rows_(rows), cols_(cols), type_(type), owns_data_(true) {
         int channels = getChannels(type);
-        data_size_ = static_cast<size_t>(rows) * static_cast<size_t>(cols) * static_cast<size_t>(channels);
+        data_size_ = static_cast<size_t>(rows) * static_cast<size_t>(cols) * static_cast<size_t>(channels) * getDepthBytes(type);
         data_ = new uint8_t[data_size_];
         memset(data_, 0, data_size_);
     }
@@ -73,10 +81,16 @@ public:
     funny_Mat(int rows, int cols, int type, void* data) 
         : rows_(rows), cols_(cols), type_(type), data_(reinterpret_cast<uint8_t*>(data)), owns_data_(false) {
         int channels = getChannels(type);
-        data_size_ = static_cast<size_t>(rows) * static_cast<size_t>(cols) * static_cast<size_t>(channels);
+        data_size_ = static_cast<size_t>(rows) * static_cast<size_t>(cols) * static_cast<size_t>(channels) * getDepthBytes(type);
+    }
+
+    // 非拥有视图，不复制数据；keeper持有数据的所有者(TYImage、TYFrame、cv::Mat等)，视图存活期间数据保持有效
+    funny_Mat(int rows, int cols, int type, void* data, std::shared_ptr<void> keeper)
+        : funny_Mat(rows, cols, type, data) {
+        keeper_ = std::move(keeper);
     }
     
-    // 拷贝构造函数
+    // 拷贝构造函数(总是深拷贝，得到的对象拥有数据)
     funny_Mat(const funny_Mat& other) 
         : rows_(other.rows_), cols_(other.cols_), type_(other.type_), data_size_(other.data_size_), owns_data_(true) {
         data_ = new uint8_t[data_size_];
@@ -84,6 +98,16 @@ public:
             memcpy(data_, other.data_, data_size_);
         }
     }
+
+    // 移动构造函数：转移缓冲区(或视图及其keeper)，不复制数据
+    funny_Mat(funny_Mat&& other) noexcept
+        : rows_(other.rows_), cols_(other.cols_), type_(other.type_), data_(other.data_),
+          owns_data_(other.owns_data_), data_size_(other.data_size_), keeper_(std::move(other.keeper_)) {
+        other.rows_ = other.cols_ = 0;
+        other.data_ = nullptr;
+        other.owns_data_ = false;
+        other.data_size_ = 0;
+    }
     
     // 析构函数
     ~funny_Mat() {
@@ -106,6 +130,8 @@ public:
             data_size_ = other.data_size_;
             owns_data_ = true;
             
+            keeper_.reset();
+            
             data_ = new uint8_t[data_size_];
             if (other.data_) {
                 memcpy(data_, other.data_, data_size_);
@@ -113,6 +139,30 @@ public:
         }
         return *this;
     }
+
+    funny_Mat& operator=(funny_Mat&& other) noexcept {
+        if (this != &other) {
+            if (owns_data_ && data_) {
+                delete[] data_;
+            }
+            rows_ = other.rows_;
+            cols_ = other.cols_;
+            type_ = other.type_;
+            data_ = other.data_;
+            owns_data_ = other.owns_data_;
+            data_size_ = other.data_size_;
+            keeper_ = std::move(other.keeper_);
+
+            other.rows_ = other.cols_ = 0;
+            other.data_ = nullptr;
+            other.owns_data_ = false;
+            other.data_size_ = 0;
+        }
+        return *this;
+    }
+
+    // 是否为不拥有数据的视图
+    bool isView() const { return data_ != nullptr && !owns_data_; }
     
     // 获取行数
     int rows() const { return rows_; }
@@ -149,6 +199,17 @@ public:
         else if (type == toInt(PixelFormat::CV_64FC1)) return 1;
         else return 1;
     }
+
+    // 每个通道的字节数，16/32/64位图像按元素大小分配缓冲
+    static int getDepthBytes(int type) {
+        if (type == toInt(PixelFormat::CV_16U) || type == toInt(PixelFormat::CV_16UC1) ||
+            type == toInt(PixelFormat::CV_16S) || type == toInt(PixelFormat::CV_16SC1)) return 2;
+        else if (type == toInt(PixelFormat::CV_32S) || type == toInt(PixelFormat::CV_32SC1) ||
+                 type == toInt(PixelFormat::CV_32F) || type == toInt(PixelFormat::CV_32FC1) ||
+                 type == toInt(PixelFormat::CV_32FC3)) return 4;
+        else if (type == toInt(PixelFormat::CV_64F) || type == toInt(PixelFormat::CV_64FC1)) return 8;
+        else return 1;
+    }
     
     // 矩阵乘法操作符重载
     funny_Mat operator*(float scalar) const {
@@ -219,9 +280,10 @@ public:
         cols_ = cols;
         type_ = type;
         owns_data_ = true;
+        keeper_.reset();
         
         int channels = getChannels(type);
-        data_size_ = static_cast<size_t>(rows) * static_cast<size_t>(cols) * static_cast<size_t>(channels);
+        data_size_ = static_cast<size_t>(rows) * static_cast<size_t>(cols) * static_cast<size_t>(channels) * getDepthBytes(type);
         data_ = new uint8_t[data_size_];
         memset(data_, 0, data_size_);
     }
@@ -233,6 +295,7 @@ private:
     uint8_t* data_;    // 数据指针
     bool owns_data_;   // 是否拥有数据
     size_t data_size_; // 数据大小
+    std::shared_ptr<void> keeper_; // 视图所引用数据的所有者
 };
 
 // 自定义点数据结构
@@ -0,0 +1,638 @@
+#include "funny_bayer.hpp"
+#include "funny_csi.hpp"
+#include "TYWorkerPool.hpp"
+#include "TYDefs.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FUNNY_BAYER_SSE2 1
+#include <emmintrin.h>
+#endif
+#endif
+
+#if !defined(FUNNY_BAYER_SSE2) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#define FUNNY_BAYER_NEON 1
+#include <arm_neon.h>
+#endif
+
+// ---------------------------------------------------------------------------
+// int16向量的薄封装：插值代码只写一份，SSE2/NEON每次处理8个元素，标量版本每次1个
+// 所有中间值不超过±32760(12位数据的4倍加4倍色差)，不会溢出
+
+#if defined(FUNNY_BAYER_SSE2)
+
+typedef __m128i vec;
+typedef __m128i vmask;
+static const int kLanes = 8;
+
+static inline vec vload(const int16_t* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+static inline void vstore(int16_t* p, vec v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+static inline vec vdup(int v) { return _mm_set1_epi16(static_cast<int16_t>(v)); }
+static inline vec vadd(vec a, vec b) { return _mm_add_epi16(a, b); }
+static inline vec vsub(vec a, vec b) { return _mm_sub_epi16(a, b); }
+template <int N> static inline vec vsra(vec a) { return _mm_srai_epi16(a, N); }
+static inline vec vmin(vec a, vec b) { return _mm_min_epi16(a, b); }
+static inline vec vmax(vec a, vec b) { return _mm_max_epi16(a, b); }
+static inline vec vabs(vec a) { return _mm_max_epi16(a, _mm_sub_epi16(_mm_setzero_si128(), a)); }
+static inline vmask vless(vec a, vec b) { return _mm_cmplt_epi16(a, b); }
+static inline vec vselect(vmask m, vec a, vec b) { return _mm_or_si128(_mm_and_si128(m, a), _mm_andnot_si128(m, b)); }
+
+#elif defined(FUNNY_BAYER_NEON)
+
+typedef int16x8_t vec;
+typedef uint16x8_t vmask;
+static const int kLanes = 8;
+
+static inline vec vload(const int16_t* p) { return vld1q_s16(p); }
+static inline void vstore(int16_t* p, vec v) { vst1q_s16(p, v); }
+static inline vec vdup(int v) { return vdupq_n_s16(static_cast<int16_t>(v)); }
+static inline vec vadd(vec a, vec b) { return vaddq_s16(a, b); }
+static inline vec vsub(vec a, vec b) { return vsubq_s16(a, b); }
+template <int N> static inline vec vsra(vec a) { return vshrq_n_s16(a, N); }
+static inline vec vmin(vec a, vec b) { return vminq_s16(a, b); }
+static inline vec vmax(vec a, vec b) { return vmaxq_s16(a, b); }
+static inline vec vabs(vec a) { return vabsq_s16(a); }
+static inline vmask vless(vec a, vec b) { return vcltq_s16(a, b); }
+static inline vec vselect(vmask m, vec a, vec b) { return vbslq_s16(m, a, b); }
+
+#else
+
+typedef int vec;
+typedef bool vmask;
+static const int kLanes = 1;
+
+static inline vec vload(const int16_t* p) { return *p; }
+static inline void vstore(int16_t* p, vec v) { *p = static_cast<int16_t>(v); }
+static inline vec vdup(int v) { return v; }
+static inline vec vadd(vec a, vec b) { return a + b; }
+static inline vec vsub(vec a, vec b) { return a - b; }
+template <int N> static inline vec vsra(vec a) { return a >> N; }
+static inline vec vmin(vec a, vec b) { return a < b ? a : b; }
+static inline vec vmax(vec a, vec b) { return a > b ? a : b; }
+static inline vec vabs(vec a) { return a < 0 ? -a : a; }
+static inline vmask vless(vec a, vec b) { return a < b; }
+static inline vec vselect(vmask m, vec a, vec b) { return m ? a : b; }
+
+#endif
+
+static inline vec avg2(vec a, vec b)
+{
+    return vsra<1>(vadd(vadd(a, b), vdup(1)));
+}
+
+static inline vec avg4(vec a, vec b, vec c, vec d)
+{
+    return vsra<2>(vadd(vadd(vadd(a, b), vadd(c, d)), vdup(2)));
+}
+
+// ---------------------------------------------------------------------------
+// 每行按列的奇偶拆成两个半行，同一半行内同色，插值变成连续下标上的运算
+// 半行左右各留kPad个元素，按reflect-101镜像填充(镜像不改变奇偶，因此不改变排列)
+
+static const int kPad = 2;
+static const int kGainBits = 12;
+
+static inline int reflect101(int x, int n)
+{
+    while (x < 0 || x >= n) {
+        x = x < 0 ? -x : 2 * (n - 1) - x;
+    }
+    return x;
+}
+
+struct BayerLayout {
+    int rx, ry;     // R在2x2中的位置，B在(1-rx, 1-ry)
+};
+
+static BayerLayout layoutOf(BayerPattern pattern)
+{
+    switch (pattern) {
+    case BayerPattern::GRBG: return BayerLayout{1, 0};
+    case BayerPattern::RGGB: return BayerLayout{0, 0};
+    case BayerPattern::GBRG: return BayerLayout{0, 1};
+    default:                 return BayerLayout{1, 1};
+    }
+}
+
+struct BayerJob {
+    const uint8_t* src;
+    int src_stride;
+    uint8_t* dst;
+    int dst_stride;
+    int width;
+    int height;
+    int bits;
+    bool csi_packed;
+    BayerLayout layout;
+    BayerDemosaic method;
+    int gain[3];    // B/G/R，Q12
+
+    int half() const { return width / 2; }
+    int halfStride() const { return kPad + (half() + kLanes - 1) / kLanes * kLanes + kPad + kLanes; }
+
+    // 第y行中G所在列的奇偶
+    int greenParity(int y) const { return ((y & 1) == layout.ry) ? 1 - layout.rx : layout.rx; }
+    // 第y行中非G像素是否为R
+    bool rowHasRed(int y) const { return (y & 1) == layout.ry; }
+};
+
+// 按reflect-101填充半行两侧的kPad个元素
+static void mirrorPads(int16_t* even, int16_t* odd, int width)
+{
+    const int n = width / 2;
+    for (int j = -kPad; j < 0; j++) {
+        even[j] = even[reflect101(2 * j, width) / 2];
+        odd[j]  = odd[reflect101(2 * j + 1, width) / 2];
+    }
+    for (int j = n; j < n + kPad; j++) {
+        even[j] = even[reflect101(2 * j, width) / 2];
+        odd[j]  = odd[reflect101(2 * j + 1, width) / 2];
+    }
+}
+
+// 读入一行原始数据，乘白平衡增益后拆成偶/奇列两个半行
+static void loadRow(const BayerJob& job, int y, int16_t* even, int16_t* odd, std::vector<uint16_t>& tmp)
+{
+    const int w = job.width;
+    const int n = job.half();
+    const int maxv = (1 << job.bits) - 1;
+    const uint8_t* row = job.src + static_cast<size_t>(y) * job.src_stride;
+
+    int gp = job.greenParity(y);
+    int gc = job.rowHasRed(y) ? job.gain[2] : job.gain[0];
+    int g0 = (gp == 0) ? job.gain[1] : gc;
+    int g1 = (gp == 1) ? job.gain[1] : gc;
+    const int round = 1 << (kGainBits - 1);
+
+    if (job.bits == 8) {
+        for (int i = 0; i < n; i++) {
+            even[i] = static_cast<int16_t>(std::min((row[2 * i] * g0 + round) >> kGainBits, maxv));
+            odd[i]  = static_cast<int16_t>(std::min((row[2 * i + 1] * g1 + round) >> kGainBits, maxv));
+        }
+    } else {
+        const uint16_t* s = reinterpret_cast<const uint16_t*>(row);
+        if (job.csi_packed) {
+            funny_csi_unpack(row, 0, tmp.data(), 0, w, 1, job.bits);
+            s = tmp.data();
+        }
+        for (int i = 0; i < n; i++) {
+            int a = std::min<int>(s[2 * i], maxv);
+            int b = std::min<int>(s[2 * i + 1], maxv);
+            even[i] = static_cast<int16_t>(std::min((a * g0 + round) >> kGainBits, maxv));
+            odd[i]  = static_cast<int16_t>(std::min((b * g1 + round) >> kGainBits, maxv));
+        }
+    }
+
+    mirrorPads(even, odd, w);
+}
+
+// 一个行带的工作缓冲：原始半行(带上下halo行)、EdgeAware模式的完整G半行、输出通道半行
+struct BandBuffers {
+    int y0;
+    int halo;
+    int hs;
+    std::vector<int16_t> raw;
+    std::vector<int16_t> green;
+    std::vector<int16_t> out;
+    std::vector<uint16_t> tmp;
+
+    int16_t* rawHalf(int y, int parity) { return &raw[(static_cast<size_t>(y - y0 + halo) * 2 + parity) * hs + kPad]; }
+    int16_t* greenHalf(int y, int parity) { return &green[(static_cast<size_t>(y - y0 + 1) * 2 + parity) * hs + kPad]; }
+    // chan: 0/1/2为B/G/R
+    int16_t* outHalf(int chan, int parity) { return &out[(static_cast<size_t>(chan) * 2 + parity) * hs + kPad]; }
+};
+
+// 双线性：G位置的C取左右平均、C'取上下平均；C位置的G取四邻平均、C'取四个对角平均
+// C为本行的非G颜色，C'为另一种颜色
+static void bilinearRow(const BayerJob& job, BandBuffers& b, int y, int16_t* outG[2], int16_t* outC[2], int16_t* outP[2])
+{
+    const int n = job.half();
+    const int gx = job.greenParity(y);
+    const int16_t* g  = b.rawHalf(y, gx);
+    const int16_t* c  = b.rawHalf(y, 1 - gx);
+    const int16_t* ug = b.rawHalf(y - 1, gx);
+    const int16_t* dg = b.rawHalf(y + 1, gx);
+    const int16_t* uc = b.rawHalf(y - 1, 1 - gx);
+    const int16_t* dc = b.rawHalf(y + 1, 1 - gx);
+
+    for (int i = 0; i < n; i += kLanes) {
+        vstore(outG[gx] + i, vload(g + i));
+        vstore(outC[gx] + i, avg2(vload(c + i + gx - 1), vload(c + i + gx)));
+        vstore(outP[gx] + i, avg2(vload(ug + i), vload(dg + i)));
+
+        vstore(outC[1 - gx] + i, vload(c + i));
+        vstore(outG[1 - gx] + i, avg4(vload(g + i - gx), vload(g + i + 1 - gx), vload(uc + i), vload(dc + i)));
+        vstore(outP[1 - gx] + i, avg4(vload(ug + i - gx), vload(ug + i + 1 - gx),
+                                      vload(dg + i - gx), vload(dg + i + 1 - gx)));
+    }
+}
+
+// EdgeAware第一步：在C位置按水平/垂直方向的梯度(G差加C的二阶差)选插值方向，
+// 沿梯度小的方向取G平均并用C的二阶差做校正，两方向相当时取两者平均
+static void greenRow(const BayerJob& job, BandBuffers& b, int y)
+{
+    const int n = job.half();
+    const int gx = job.greenParity(y);
+    const vec zero = vdup(0);
+    const vec maxv = vdup((1 << job.bits) - 1);
+    const int16_t* g  = b.rawHalf(y, gx);
+    const int16_t* c  = b.rawHalf(y, 1 - gx);
+    const int16_t* uc = b.rawHalf(y - 1, 1 - gx);
+    const int16_t* dc = b.rawHalf(y + 1, 1 - gx);
+    const int16_t* uuc = b.rawHalf(y - 2, 1 - gx);
+    const int16_t* ddc = b.rawHalf(y + 2, 1 - gx);
+    int16_t* og = b.greenHalf(y, gx);
+    int16_t* oc = b.greenHalf(y, 1 - gx);
+
+    for (int i = 0; i < n; i += kLanes) {
+        vstore(og + i, vload(g + i));
+
+        vec cc = vload(c + i);
+        vec c2 = vadd(cc, cc);
+        vec gl = vload(g + i - gx);
+        vec gr = vload(g + i + 1 - gx);
+        vec gu = vload(uc + i);
+        vec gd = vload(dc + i);
+        vec lapH = vsub(c2, vadd(vload(c + i - 1), vload(c + i + 1)));
+        vec lapV = vsub(c2, vadd(vload(uuc + i), vload(ddc + i)));
+
+        vec dH = vadd(vabs(vsub(gl, gr)), vabs(lapH));
+        vec dV = vadd(vabs(vsub(gu, gd)), vabs(lapV));
+        vec sH = vadd(gl, gr);
+        vec sV = vadd(gu, gd);
+        vec eH = vsra<2>(vadd(vadd(vadd(sH, sH), lapH), vdup(2)));
+        vec eV = vsra<2>(vadd(vadd(vadd(sV, sV), lapV), vdup(2)));
+        vec eA = avg2(eH, eV);
+
+        vec v = vselect(vless(dH, dV), eH, vselect(vless(dV, dH), eV, eA));
+        vstore(oc + i, vmin(vmax(v, zero), maxv));
+    }
+}
+
+// EdgeAware第二步：红蓝按色差(C - G)双线性插值，G取第一步的结果
+static void colorDiffRow(const BayerJob& job, BandBuffers& b, int y, int16_t* outG[2], int16_t* outC[2], int16_t* outP[2])
+{
+    const int n = job.half();
+    const int gx = job.greenParity(y);
+    const vec zero = vdup(0);
+    const vec maxv = vdup((1 << job.bits) - 1);
+    const int16_t* c  = b.rawHalf(y, 1 - gx);
+    const int16_t* ug = b.rawHalf(y - 1, gx);
+    const int16_t* dg = b.rawHalf(y + 1, gx);
+    const int16_t* G0 = b.greenHalf(y, gx);
+    const int16_t* G1 = b.greenHalf(y, 1 - gx);
+    const int16_t* Gu = b.greenHalf(y - 1, gx);
+    const int16_t* Gd = b.greenHalf(y + 1, gx);
+
+    for (int i = 0; i < n; i += kLanes) {
+        // G位置
+        vec g0 = vload(G0 + i);
+        vec dl = vsub(vload(c + i + gx - 1), vload(G1 + i + gx - 1));
+        vec dr = vsub(vload(c + i + gx), vload(G1 + i + gx));
+        vec du = vsub(vload(ug + i), vload(Gu + i));
+        vec dd = vsub(vload(dg + i), vload(Gd + i));
+        vstore(outG[gx] + i, g0);
+        vstore(outC[gx] + i, vmin(vmax(vsra<1>(vadd(vadd(vadd(g0, g0), vadd(dl, dr)), vdup(1))), zero), maxv));
+        vstore(outP[gx] + i, vmin(vmax(vsra<1>(vadd(vadd(vadd(g0, g0), vadd(du, dd)), vdup(1))), zero), maxv));
+
+        // C位置
+        vec g1 = vload(G1 + i);
+        vec d0 = vsub(vload(ug + i - gx), vload(Gu + i - gx));
+        vec d1 = vsub(vload(ug + i + 1 - gx), vload(Gu + i + 1 - gx));
+        vec d2 = vsub(vload(dg + i - gx), vload(Gd + i - gx));
+        vec d3 = vsub(vload(dg + i + 1 - gx), vload(Gd + i + 1 - gx));
+        vec g4 = vadd(vadd(g1, g1), vadd(g1, g1));
+        vstore(outG[1 - gx] + i, g1);
+        vstore(outC[1 - gx] + i, vload(c + i));
+        vstore(outP[1 - gx] + i, vmin(vmax(vsra<2>(vadd(vadd(g4, vadd(vadd(d0, d1), vadd(d2, d3))), vdup(2))), zero), maxv));
+    }
+}
+
+// 把B/G/R的偶/奇半行合成为一行BGR888，高于8位时舍入
+static inline uint8_t toByte(int v, int shift)
+{
+    v = shift ? (v + (1 << (shift - 1))) >> shift : v;
+    return static_cast<uint8_t>(v < 0 ? 0 : (v > 255 ? 255 : v));
+}
+
+static void packRow(BandBuffers& b, int width, int bits, uint8_t* dst)
+{
+    const int n = width / 2;
+    const int shift = bits - 8;
+    const int16_t* ch[3][2];
+    for (int k = 0; k < 3; k++) {
+        ch[k][0] = b.outHalf(k, 0);
+        ch[k][1] = b.outHalf(k, 1);
+    }
+
+    int i = 0;
+#if defined(FUNNY_BAYER_SSE2)
+    const __m128i cnt = _mm_cvtsi32_si128(shift);
+    const __m128i bias = _mm_set1_epi16(static_cast<int16_t>(shift ? 1 << (shift - 1) : 0));
+    const __m128i zero = _mm_setzero_si128();
+    // 每次16个像素；每个像素按4字节(BGR0)写出，后一个像素覆盖前一个的第4字节，
+    // 因此块后至少保留一个像素给标量部分，避免写出行尾
+    for (; i + 8 < n; i += 8) {
+        __m128i px8[3];
+        for (int k = 0; k < 3; k++) {
+            __m128i e = _mm_sra_epi16(_mm_add_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ch[k][0] + i)), bias), cnt);
+            __m128i o = _mm_sra_epi16(_mm_add_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ch[k][1] + i)), bias), cnt);
+            px8[k] = _mm_unpacklo_epi8(_mm_packus_epi16(e, e), _mm_packus_epi16(o, o));
+        }
+        __m128i bg[2] = { _mm_unpacklo_epi8(px8[0], px8[1]), _mm_unpackhi_epi8(px8[0], px8[1]) };
+        __m128i r0[2] = { _mm_unpacklo_epi8(px8[2], zero), _mm_unpackhi_epi8(px8[2], zero) };
+        uint8_t* d = dst + i * 6;
+        for (int h = 0; h < 2; h++) {
+            __m128i px[2] = { _mm_unpacklo_epi16(bg[h], r0[h]), _mm_unpackhi_epi16(bg[h], r0[h]) };
+            for (int q = 0; q < 2; q++) {
+                for (int j = 0; j < 4; j++, d += 3) {
+                    int32_t v = _mm_cvtsi128_si32(px[q]);
+                    memcpy(d, &v, 4);
+                    px[q] = _mm_srli_si128(px[q], 4);
+                }
+            }
+        }
+    }
+#elif defined(FUNNY_BAYER_NEON)
+    const int16x8_t sh = vdupq_n_s16(static_cast<int16_t>(-shift));
+    const int16x8_t bias = vdupq_n_s16(static_cast<int16_t>(shift ? 1 << (shift - 1) : 0));
+    for (; i + 8 <= n; i += 8) {
+        uint8x16x3_t bgr;
+        for (int k = 0; k < 3; k++) {
+            uint8x8_t e = vqmovun_s16(vshlq_s16(vaddq_s16(vld1q_s16(ch[k][0] + i), bias), sh));
+            uint8x8_t o = vqmovun_s16(vshlq_s16(vaddq_s16(vld1q_s16(ch[k][1] + i), bias), sh));
+            uint8x8x2_t z = vzip_u8(e, o);
+            bgr.val[k] = vcombine_u8(z.val[0], z.val[1]);
+        }
+        vst3q_u8(dst + i * 6, bgr);
+    }
+#endif
+    for (; i < n; i++) {
+        uint8_t* d = dst + i * 6;
+        for (int k = 0; k < 3; k++) {
+            d[k]     = toByte(ch[k][0][i], shift);
+            d[k + 3] = toByte(ch[k][1][i], shift);
+        }
+    }
+}
+
+static void processBand(const BayerJob& job, int y0, int y1)
+{
+    const bool edge = (job.method == BayerDemosaic::EdgeAware);
+    BandBuffers b;
+    b.y0 = y0;
+    b.halo = edge ? 3 : 1;
+    b.hs = job.halfStride();
+    b.raw.assign(static_cast<size_t>(y1 - y0 + 2 * b.halo) * 2 * b.hs, 0);
+    b.out.assign(static_cast<size_t>(3) * 2 * b.hs, 0);
+    if (edge) {
+        b.green.assign(static_cast<size_t>(y1 - y0 + 2) * 2 * b.hs, 0);
+    }
+    if (job.csi_packed) {
+        b.tmp.resize(job.width);
+    }
+
+    // halo行按reflect-101取源行，镜像保持行的奇偶，因此保持排列
+    for (int y = y0 - b.halo; y < y1 + b.halo; y++) {
+        int sy = reflect101(y, job.height);
+        loadRow(job, sy, b.rawHalf(y, 0), b.rawHalf(y, 1), b.tmp);
+    }
+    if (edge) {
+        for (int y = y0 - 1; y < y1 + 1; y++) {
+            greenRow(job, b, y);
+            mirrorPads(b.greenHalf(y, 0), b.greenHalf(y, 1), job.width);
+        }
+    }
+
+    for (int y = y0; y < y1; y++) {
+        // 本行非G颜色为R时C=R、C'=B，否则C=B、C'=R
+        bool red = job.rowHasRed(y);
+        int16_t* outG[2] = { b.outHalf(1, 0), b.outHalf(1, 1) };
+        int16_t* outC[2] = { b.outHalf(red ? 2 : 0, 0), b.outHalf(red ? 2 : 0, 1) };
+        int16_t* outP[2] = { b.outHalf(red ? 0 : 2, 0), b.outHalf(red ? 0 : 2, 1) };
+        if (edge) {
+            colorDiffRow(job, b, y, outG, outC, outP);
+        } else {
+            bilinearRow(job, b, y, outG, outC, outP);
+        }
+        packRow(b, job.width, job.bits, job.dst + static_cast<size_t>(y) * job.dst_stride);
+    }
+}
+
+const char* funny_bayer_kernel()
+{
+#if defined(FUNNY_BAYER_SSE2)
+    return "sse2";
+#elif defined(FUNNY_BAYER_NEON)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
+
+bool funny_bayer_format(uint32_t pixel_format, BayerPattern& pattern, int& bits, bool& csi_packed)
+{
+    switch (pixel_format) {
+    case TY_PIXEL_FORMAT_BAYER8GRBG:      pattern = BayerPattern::GRBG; bits = 8;  csi_packed = false; return true;
+    case TY_PIXEL_FORMAT_BAYER8RGGB:      pattern = BayerPattern::RGGB; bits = 8;  csi_packed = false; return true;
+    case TY_PIXEL_FORMAT_BAYER8GBRG:      pattern = BayerPattern::GBRG; bits = 8;  csi_packed = false; return true;
+    case TY_PIXEL_FORMAT_BAYER8BGGR:      pattern = BayerPattern::BGGR; bits = 8;  csi_packed = false; return true;
+    case TY_PIXEL_FORMAT_CSI_BAYER10GRBG: pattern = BayerPattern::GRBG; bits = 10; csi_packed = true;  return true;
+    case TY_PIXEL_FORMAT_CSI_BAYER10RGGB: pattern = BayerPattern::RGGB; bits = 10; csi_packed = true;  return true;
+    case TY_PIXEL_FORMAT_CSI_BAYER10GBRG: pattern = BayerPattern::GBRG; bits = 10; csi_packed = true;  return true;
+    case TY_PIXEL_FORMAT_CSI_BAYER10BGGR: pattern = BayerPattern::BGGR; bits = 10; csi_packed = true;  return true;
+    case TY_PIXEL_FORMAT_CSI_BAYER12GRBG: pattern = BayerPattern::GRBG; bits = 12; csi_packed = true;  return true;
+    case TY_PIXEL_FORMAT_CSI_BAYER12RGGB: pattern = BayerPattern::RGGB; bits = 12; csi_packed = true;  return true;
+    case TY_PIXEL_FORMAT_CSI_BAYER12GBRG: pattern = BayerPattern::GBRG; bits = 12; csi_packed = true;  return true;
+    case TY_PIXEL_FORMAT_CSI_BAYER12BGGR: pattern = BayerPattern::BGGR; bits = 12; csi_packed = true;  return true;
+    default:
+        return false;
+    }
+}
+
+void funny_bayer_red_site(BayerPattern pattern, int& rx, int& ry)
+{
+    BayerLayout layout = layoutOf(pattern);
+    rx = layout.rx;
+    ry = layout.ry;
+}
+
+static int gainQ12(float g)
+{
+    // 增益限制在[0, 16)，保证乘积不超过32位
+    float v = std::min(std::max(g, 0.f), 15.99f);
+    return static_cast<int>(v * (1 << kGainBits) + 0.5f);
+}
+
+// 检查参数并填写job；out_w为输出宽度，用于检查dst_stride
+static bool setupJob(BayerJob& job, const void* src, int src_stride, uint8_t* dst, int dst_stride,
+                     int width, int height, int out_w, BayerPattern pattern, int bits, bool csi_packed,
+                     const FunnyBayerOptions& options)
+{
+    if (!src || !dst || (width & 1) || (height & 1)) {
+        return false;
+    }
+    if (bits != 8 && bits != 10 && bits != 12) {
+        return false;
+    }
+    if (bits == 8 && csi_packed) {
+        return false;
+    }
+
+    int rowBytes = csi_packed ? funny_csi_row_bytes(width, bits) : width * (bits == 8 ? 1 : 2);
+    if (src_stride == 0) {
+        src_stride = rowBytes;
+    }
+    if (dst_stride == 0) {
+        dst_stride = out_w * 3;
+    }
+    if (src_stride < rowBytes || dst_stride < out_w * 3) {
+        return false;
+    }
+
+    job.src = static_cast<const uint8_t*>(src);
+    job.src_stride = src_stride;
+    job.dst = dst;
+    job.dst_stride = dst_stride;
+    job.width = width;
+    job.height = height;
+    job.bits = bits;
+    job.csi_packed = csi_packed;
+    job.layout = layoutOf(pattern);
+    job.method = options.method;
+    job.gain[0] = gainQ12(options.gain_b);
+    job.gain[1] = gainQ12(options.gain_g);
+    job.gain[2] = gainQ12(options.gain_r);
+    return true;
+}
+
+bool funny_bayer_to_bgr(
+    const void* src, int src_stride,
+    uint8_t* dst, int dst_stride,
+    int width, int height,
+    BayerPattern pattern, int bits, bool csi_packed,
+    const FunnyBayerOptions& options)
+{
+    if (width < 4 || height < 4) {
+        return false;
+    }
+    BayerJob job;
+    if (!setupJob(job, src, src_stride, dst, dst_stride, width, height, width, pattern, bits, csi_packed, options)) {
+        return false;
+    }
+
+    if (!options.parallel) {
+        processBand(job, 0, height);
+        return true;
+    }
+
+    // 每个行带要多读上下halo行，行带不宜太窄
+    TYWorkerPool& pool = TYWorkerPool::shared();
+    int bands = static_cast<int>(pool.size() + 1) * 4;
+    int grain = std::max(32, (height + bands - 1) / bands);
+    pool.parallel_for(0, height, grain, [&](int begin, int end) {
+        processBand(job, begin, end);
+    });
+    return true;
+}
+
+// 缩小解码的输出行[oy0, oy1)：逐行把块内偶/奇列像素累加到B/G/R三个平面，再按个数取平均
+// 块内R、B各(S / 2)^2个，G为其两倍，都是2的幂，平均与增益(Q12)合并为一次乘法和移位
+template <int S, typename T>
+static void reducedBand(const BayerJob& job, int oy0, int oy1)
+{
+    const int ow = job.width / S;
+    const int maxv = (1 << job.bits) - 1;
+    const int shift = job.bits - 8;
+    const int cellShift = (S == 2) ? 0 : 2;
+    std::vector<uint16_t> tmp(job.csi_packed ? job.width : 0);
+    std::vector<uint32_t> planes(static_cast<size_t>(ow) * 3);
+    uint32_t* plane[3] = { &planes[0], &planes[ow], &planes[2 * ow] };
+
+    for (int oy = oy0; oy < oy1; oy++) {
+        std::fill(planes.begin(), planes.end(), 0u);
+        for (int r = 0; r < S; r++) {
+            const int y = oy * S + r;
+            const uint8_t* row = job.src + static_cast<size_t>(y) * job.src_stride;
+            const T* s = reinterpret_cast<const T*>(row);
+            if (job.csi_packed) {
+                funny_csi_unpack(row, 0, tmp.data(), 0, job.width, 1, job.bits);
+                s = reinterpret_cast<const T*>(tmp.data());
+            }
+            // 偶/奇列像素所属通道(0:B 1:G 2:R)
+            const int other = job.rowHasRed(y) ? 2 : 0;
+            uint32_t* pe = plane[job.greenParity(y) == 0 ? 1 : other];
+            uint32_t* po = plane[job.greenParity(y) == 1 ? 1 : other];
+            for (int ox = 0; ox < ow; ox++, s += S) {
+                uint32_t e = 0, o = 0;
+                for (int x = 0; x < S; x += 2) {
+                    // 8位数据不会越界，不必限制
+                    e += sizeof(T) == 1 ? s[x] : std::min<uint32_t>(s[x], maxv);
+                    o += sizeof(T) == 1 ? s[x + 1] : std::min<uint32_t>(s[x + 1], maxv);
+                }
+                pe[ox] += e;
+                po[ox] += o;
+            }
+        }
+
+        uint8_t* d = job.dst + static_cast<size_t>(oy) * job.dst_stride;
+        for (int c = 0; c < 3; c++) {
+            const uint32_t gain = static_cast<uint32_t>(job.gain[c]);
+            const int sh = kGainBits + cellShift + (c == 1 ? 1 : 0);
+            const uint32_t round = 1u << (sh - 1);
+            const uint32_t* p = plane[c];
+            for (int ox = 0; ox < ow; ox++) {
+                // 与全分辨率解码一样先限制在原始位宽内再舍入到8位
+                uint32_t v = std::min<uint32_t>((p[ox] * gain + round) >> sh, maxv);
+                d[ox * 3 + c] = toByte(static_cast<int>(v), shift);
+            }
+        }
+    }
+}
+
+static void reducedRows(const BayerJob& job, int scale, int oy0, int oy1)
+{
+    if (job.bits == 8) {
+        scale == 2 ? reducedBand<2, uint8_t>(job, oy0, oy1) : reducedBand<4, uint8_t>(job, oy0, oy1);
+    } else {
+        scale == 2 ? reducedBand<2, uint16_t>(job, oy0, oy1) : reducedBand<4, uint16_t>(job, oy0, oy1);
+    }
+}
+
+bool funny_bayer_to_bgr_reduced(
+    const void* src, int src_stride,
+    uint8_t* dst, int dst_stride,
+    int width, int height,
+    BayerPattern pattern, int bits, bool csi_packed, int scale,
+    const FunnyBayerOptions& options)
+{
+    if (scale == 1) {
+        return funny_bayer_to_bgr(src, src_stride, dst, dst_stride, width, height, pattern, bits, csi_packed, options);
+    }
+    if ((scale != 2 && scale != 4) || width < scale || height < scale) {
+        return false;
+    }
+    BayerJob job;
+    if (!setupJob(job, src, src_stride, dst, dst_stride, width, height, width / scale,
+                  pattern, bits, csi_packed, options)) {
+        return false;
+    }
+
+    const int oh = height / scale;
+    if (!options.parallel) {
+        reducedRows(job, scale, 0, oh);
+        return true;
+    }
+
+    TYWorkerPool& pool = TYWorkerPool::shared();
+    int bands = static_cast<int>(pool.size() + 1) * 4;
+    int grain = std::max(8, (oh + bands - 1) / bands);
+    pool.parallel_for(0, oh, grain, [&](int begin, int end) {
+        reducedRows(job, scale, begin, end);
+    });
+    return true;
+}
@@ -0,0 +1,65 @@
+#ifndef FUNNY_BAYER_HPP_
+#define FUNNY_BAYER_HPP_
+
+#include <stdint.h>
+
+// Bayer排列，按左上角2x2的顺序命名
+enum class BayerPattern {
+    GRBG,
+    RGGB,
+    GBRG,
+    BGGR
+};
+
+enum class BayerDemosaic {
+    Bilinear,   // 双线性，每个缺失分量取相邻同色像素的平均
+    EdgeAware   // 绿色按水平/垂直梯度择向插值(Hamilton-Adams)，红蓝按色差插值，边缘处伪彩少
+};
+
+struct FunnyBayerOptions {
+    BayerDemosaic method;
+    // 白平衡增益，在解马赛克前作用于原始数据，与插值在同一遍完成
+    float gain_r;
+    float gain_g;
+    float gain_b;
+    // 为true时按行带分给TYWorkerPool::shared()并行处理
+    bool parallel;
+
+    FunnyBayerOptions()
+        : method(BayerDemosaic::Bilinear), gain_r(1.f), gain_g(1.f), gain_b(1.f), parallel(false) {}
+};
+
+// TY_PIXEL_FORMAT_BAYER8*、CSI_BAYER10*、CSI_BAYER12*对应的排列和位数，其他格式返回false
+// csi_packed为true表示数据为CSI紧凑打包格式(见funny_csi.hpp)
+bool funny_bayer_format(uint32_t pixel_format, BayerPattern& pattern, int& bits, bool& csi_packed);
+
+// R在左上2x2单元中的列rx和行ry(0或1)，B在(1 - rx, 1 - ry)，与解马赛克使用同一张表
+void funny_bayer_red_site(BayerPattern pattern, int& rx, int& ry);
+
+// Bayer原始数据转BGR888，高于8位的数据在输出时舍入到8位
+// bits为8时src为uint8；为10/12时src为低位对齐的uint16，csi_packed为true时为CSI紧凑打包格式
+// src_stride/dst_stride为行字节数，src_stride为0时按紧凑行计算，dst_stride为0时取width * 3
+// 宽高须为不小于4的偶数；插值和格式转换按编译目标使用SSE2/NEON内核，与标量实现逐位一致
+bool funny_bayer_to_bgr(
+    const void* src, int src_stride,
+    uint8_t* dst, int dst_stride,
+    int width, int height,
+    BayerPattern pattern, int bits, bool csi_packed,
+    const FunnyBayerOptions& options = FunnyBayerOptions()
+);
+
+// 缩小解码：直接输出(width / scale) x (height / scale)的BGR888，scale为1/2/4，1时同funny_bayer_to_bgr
+// 每个输出像素对应scale x scale的原始块，R/B取块内同色像素的平均，G取块内全部G的平均，不做插值，
+// options.method不起作用；宽高须为不小于scale的偶数
+bool funny_bayer_to_bgr_reduced(
+    const void* src, int src_stride,
+    uint8_t* dst, int dst_stride,
+    int width, int height,
+    BayerPattern pattern, int bits, bool csi_packed, int scale,
+    const FunnyBayerOptions& options = FunnyBayerOptions()
+);
+
+// 当前选用的内核名称("sse2"/"neon"/"scalar")
+const char* funny_bayer_kernel();
+
+#endif
@@ -0,0 +1,317 @@
+#include "funny_csi.hpp"
+#include "TYWorkerPool.hpp"
+#include "TYDefs.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FUNNY_CSI_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define FUNNY_CSI_NEON 1
+#include <arm_neon.h>
+#endif
+
+#if defined(FUNNY_CSI_X86) && (defined(__GNUC__) || defined(__clang__))
+#define FUNNY_TARGET_SSSE3 __attribute__((target("ssse3")))
+#else
+#define FUNNY_TARGET_SSSE3
+#endif
+
+typedef void (*CsiRowKernel)(const uint8_t* src, uint16_t* dst, int width, int shift);
+
+static inline uint16_t shifted(int v, int shift)
+{
+    return static_cast<uint16_t>(shift >= 0 ? v << shift : v >> -shift);
+}
+
+// 从第x个像素(4的倍数)开始处理到行尾
+static void row10Scalar(const uint8_t* src, uint16_t* dst, int x, int width, int shift)
+{
+    for (; x < width; x += 4) {
+        const uint8_t* g = src + x / 4 * 5;
+        int n = std::min(4, width - x);
+        for (int i = 0; i < n; i++) {
+            dst[x + i] = shifted((g[i] << 2) | ((g[4] >> (2 * i)) & 3), shift);
+        }
+    }
+}
+
+// 从第x个像素(偶数)开始处理到行尾
+static void row12Scalar(const uint8_t* src, uint16_t* dst, int x, int width, int shift)
+{
+    for (; x < width; x += 2) {
+        const uint8_t* g = src + x / 2 * 3;
+        dst[x] = shifted((g[0] << 4) | (g[2] & 15), shift);
+        if (x + 1 < width) {
+            dst[x + 1] = shifted((g[1] << 4) | (g[2] >> 4), shift);
+        }
+    }
+}
+
+static void row10KernelScalar(const uint8_t* src, uint16_t* dst, int width, int shift)
+{
+    row10Scalar(src, dst, 0, width, shift);
+}
+
+static void row12KernelScalar(const uint8_t* src, uint16_t* dst, int width, int shift)
+{
+    row12Scalar(src, dst, 0, width, shift);
+}
+
+#ifdef FUNNY_CSI_X86
+
+// 8个像素：pshufb把高8位和低位所在字节分别扩展到16位通道，
+// 低位字节乘以2的幂把各像素的低位移到同一位置后统一右移、取掩码
+FUNNY_TARGET_SSSE3
+static inline __m128i unpack8SSSE3(__m128i v, __m128i hiIdx, __m128i loIdx, __m128i loMul,
+                                   int loBits, __m128i loMask, __m128i sl, __m128i sr)
+{
+    __m128i hi = _mm_sll_epi16(_mm_shuffle_epi8(v, hiIdx), _mm_cvtsi32_si128(loBits));
+    __m128i lo = _mm_and_si128(_mm_srl_epi16(_mm_mullo_epi16(_mm_shuffle_epi8(v, loIdx), loMul),
+                                             _mm_cvtsi32_si128(8 - loBits)), loMask);
+    return _mm_srl_epi16(_mm_sll_epi16(_mm_or_si128(hi, lo), sl), sr);
+}
+
+FUNNY_TARGET_SSSE3
+static void row10KernelSSSE3(const uint8_t* src, uint16_t* dst, int width, int shift)
+{
+    const __m128i hiIdx = _mm_setr_epi8(0, -1, 1, -1, 2, -1, 3, -1, 5, -1, 6, -1, 7, -1, 8, -1);
+    const __m128i loIdx = _mm_setr_epi8(4, -1, 4, -1, 4, -1, 4, -1, 9, -1, 9, -1, 9, -1, 9, -1);
+    const __m128i loMul = _mm_setr_epi16(64, 16, 4, 1, 64, 16, 4, 1);
+    const __m128i loMask = _mm_set1_epi16(3);
+    const __m128i sl = _mm_cvtsi32_si128(std::max(shift, 0));
+    const __m128i sr = _mm_cvtsi32_si128(std::max(-shift, 0));
+    const int bytes = funny_csi_row_bytes(width, 10);
+
+    int x = 0;
+    // 每次16个像素(20字节)，分两次读入16字节，第二次从第10字节开始
+    for (; x + 16 <= width && x / 4 * 5 + 26 <= bytes; x += 16) {
+        const uint8_t* s = src + x / 4 * 5;
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 10));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), unpack8SSSE3(a, hiIdx, loIdx, loMul, 2, loMask, sl, sr));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x + 8), unpack8SSSE3(b, hiIdx, loIdx, loMul, 2, loMask, sl, sr));
+    }
+    row10Scalar(src, dst, x, width, shift);
+}
+
+FUNNY_TARGET_SSSE3
+static void row12KernelSSSE3(const uint8_t* src, uint16_t* dst, int width, int shift)
+{
+    const __m128i hiIdx = _mm_setr_epi8(0, -1, 1, -1, 3, -1, 4, -1, 6, -1, 7, -1, 9, -1, 10, -1);
+    const __m128i loIdx = _mm_setr_epi8(2, -1, 2, -1, 5, -1, 5, -1, 8, -1, 8, -1, 11, -1, 11, -1);
+    const __m128i loMul = _mm_setr_epi16(16, 1, 16, 1, 16, 1, 16, 1);
+    const __m128i loMask = _mm_set1_epi16(15);
+    const __m128i sl = _mm_cvtsi32_si128(std::max(shift, 0));
+    const __m128i sr = _mm_cvtsi32_si128(std::max(-shift, 0));
+    const int bytes = funny_csi_row_bytes(width, 12);
+
+    int x = 0;
+    // 每次16个像素(24字节)，分两次读入16字节，第二次从第12字节开始
+    for (; x + 16 <= width && x / 2 * 3 + 28 <= bytes; x += 16) {
+        const uint8_t* s = src + x / 2 * 3;
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 12));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), unpack8SSSE3(a, hiIdx, loIdx, loMul, 4, loMask, sl, sr));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x + 8), unpack8SSSE3(b, hiIdx, loIdx, loMul, 4, loMask, sl, sr));
+    }
+    row12Scalar(src, dst, x, width, shift);
+}
+
+static bool cpuHasSSSE3()
+{
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] & (1 << 9)) != 0;
+#elif defined(__GNUC__) || defined(__clang__)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("ssse3") != 0;
+#else
+    return false;
+#endif
+}
+
+#endif // FUNNY_CSI_X86
+
+#ifdef FUNNY_CSI_NEON
+
+// 16字节查表取8字节；ARMv7没有vqtbl1，用两个8字节表的vtbl2代替
+static inline uint8x8_t neonLookup(uint8x16_t t, uint8x8_t idx)
+{
+#if defined(__aarch64__)
+    return vqtbl1_u8(t, idx);
+#else
+    uint8x8x2_t tt;
+    tt.val[0] = vget_low_u8(t);
+    tt.val[1] = vget_high_u8(t);
+    return vtbl2_u8(tt, idx);
+#endif
+}
+
+// 低位字节按像素右移不同位数(vshl的负移位量)后取掩码；最终移位同样用vshl，负数即右移
+static inline uint16x8_t unpack8NEON(uint8x16_t v, uint8x8_t hiIdx, uint8x8_t loIdx, int8x8_t loShift,
+                                     uint8x8_t loMask, int hiShift, int16x8_t shift)
+{
+    uint16x8_t hi = vshlq_u16(vmovl_u8(neonLookup(v, hiIdx)), vdupq_n_s16(static_cast<int16_t>(hiShift)));
+    uint8x8_t lo = vand_u8(vshl_u8(neonLookup(v, loIdx), loShift), loMask);
+    return vshlq_u16(vorrq_u16(hi, vmovl_u8(lo)), shift);
+}
+
+static void row10KernelNEON(const uint8_t* src, uint16_t* dst, int width, int shift)
+{
+    static const uint8_t kHi[8] = {0, 1, 2, 3, 5, 6, 7, 8};
+    static const uint8_t kLo[8] = {4, 4, 4, 4, 9, 9, 9, 9};
+    static const int8_t kLoShift[8] = {0, -2, -4, -6, 0, -2, -4, -6};
+    const uint8x8_t hiIdx = vld1_u8(kHi);
+    const uint8x8_t loIdx = vld1_u8(kLo);
+    const int8x8_t loShift = vld1_s8(kLoShift);
+    const uint8x8_t loMask = vdup_n_u8(3);
+    const int16x8_t sh = vdupq_n_s16(static_cast<int16_t>(shift));
+    const int bytes = funny_csi_row_bytes(width, 10);
+
+    int x = 0;
+    // 每次8个像素(10字节)，读入16字节
+    for (; x + 8 <= width && x / 4 * 5 + 16 <= bytes; x += 8) {
+        uint8x16_t v = vld1q_u8(src + x / 4 * 5);
+        vst1q_u16(dst + x, unpack8NEON(v, hiIdx, loIdx, loShift, loMask, 2, sh));
+    }
+    row10Scalar(src, dst, x, width, shift);
+}
+
+static void row12KernelNEON(const uint8_t* src, uint16_t* dst, int width, int shift)
+{
+    static const uint8_t kHi[8] = {0, 1, 3, 4, 6, 7, 9, 10};
+    static const uint8_t kLo[8] = {2, 2, 5, 5, 8, 8, 11, 11};
+    static const int8_t kLoShift[8] = {0, -4, 0, -4, 0, -4, 0, -4};
+    const uint8x8_t hiIdx = vld1_u8(kHi);
+    const uint8x8_t loIdx = vld1_u8(kLo);
+    const int8x8_t loShift = vld1_s8(kLoShift);
+    const uint8x8_t loMask = vdup_n_u8(15);
+    const int16x8_t sh = vdupq_n_s16(static_cast<int16_t>(shift));
+    const int bytes = funny_csi_row_bytes(width, 12);
+
+    int x = 0;
+    // 每次8个像素(12字节)，读入16字节
+    for (; x + 8 <= width && x / 2 * 3 + 16 <= bytes; x += 8) {
+        uint8x16_t v = vld1q_u8(src + x / 2 * 3);
+        vst1q_u16(dst + x, unpack8NEON(v, hiIdx, loIdx, loShift, loMask, 4, sh));
+    }
+    row12Scalar(src, dst, x, width, shift);
+}
+
+#endif // FUNNY_CSI_NEON
+
+struct CsiKernel {
+    CsiRowKernel row10;
+    CsiRowKernel row12;
+    const char*  name;
+};
+
+static CsiKernel selectKernel()
+{
+#ifdef FUNNY_CSI_X86
+    if (cpuHasSSSE3()) {
+        return CsiKernel{row10KernelSSSE3, row12KernelSSSE3, "ssse3"};
+    }
+#elif defined(FUNNY_CSI_NEON)
+    return CsiKernel{row10KernelNEON, row12KernelNEON, "neon"};
+#endif
+    return CsiKernel{row10KernelScalar, row12KernelScalar, "scalar"};
+}
+
+static const CsiKernel& kernel()
+{
+    static const CsiKernel k = selectKernel();
+    return k;
+}
+
+const char* funny_csi_kernel()
+{
+    return kernel().name;
+}
+
+int funny_csi_bits(uint32_t pixel_format)
+{
+    switch (pixel_format) {
+    case TY_PIXEL_FORMAT_CSI_MONO10:
+    case TY_PIXEL_FORMAT_CSI_BAYER10GRBG:
+    case TY_PIXEL_FORMAT_CSI_BAYER10RGGB:
+    case TY_PIXEL_FORMAT_CSI_BAYER10GBRG:
+    case TY_PIXEL_FORMAT_CSI_BAYER10BGGR:
+        return 10;
+    case TY_PIXEL_FORMAT_CSI_MONO12:
+    case TY_PIXEL_FORMAT_CSI_BAYER12GRBG:
+    case TY_PIXEL_FORMAT_CSI_BAYER12RGGB:
+    case TY_PIXEL_FORMAT_CSI_BAYER12GBRG:
+    case TY_PIXEL_FORMAT_CSI_BAYER12BGGR:
+        return 12;
+    default:
+        return 0;
+    }
+}
+
+int funny_csi_row_bytes(int width, int bits)
+{
+    if (bits == 10) {
+        return (width + 3) / 4 * 5;
+    }
+    if (bits == 12) {
+        return (width + 1) / 2 * 3;
+    }
+    return 0;
+}
+
+bool funny_csi_unpack(
+    const uint8_t* src, int src_stride,
+    uint16_t* dst, int dst_stride,
+    int width, int height, int bits,
+    int shift, bool parallel)
+{
+    if (!src || !dst || width <= 0 || height <= 0) {
+        return false;
+    }
+    if ((bits != 10 && bits != 12) || shift < -bits || shift > 16 - bits) {
+        return false;
+    }
+    const int rowBytes = funny_csi_row_bytes(width, bits);
+    if (src_stride == 0) {
+        src_stride = rowBytes;
+    }
+    if (dst_stride == 0) {
+        dst_stride = width * 2;
+    }
+    if (src_stride < rowBytes || dst_stride < width * 2) {
+        return false;
+    }
+
+    CsiRowKernel row = (bits == 10) ? kernel().row10 : kernel().row12;
+    uint8_t* out = reinterpret_cast<uint8_t*>(dst);
+
+    auto rows = [&](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            row(src + static_cast<size_t>(i) * src_stride,
+                reinterpret_cast<uint16_t*>(out + static_cast<size_t>(i) * dst_stride), width, shift);
+        }
+    };
+
+    if (!parallel) {
+        rows(0, height);
+        return true;
+    }
+
+    TYWorkerPool& pool = TYWorkerPool::shared();
+    int bands = static_cast<int>(pool.size() + 1) * 4;
+    int grain = std::max(8, (height + bands - 1) / bands);
+    pool.parallel_for(0, height, grain, rows);
+    return true;
+}
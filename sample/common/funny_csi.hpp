@@ -0,0 +1,31 @@
+#ifndef FUNNY_CSI_HPP_
+#define FUNNY_CSI_HPP_
+
+#include <stdint.h>
+
+// MIPI CSI-2紧凑打包格式(TY_PIXEL_FORMAT_CSI_MONO10/12、CSI_BAYER10/12*)
+// RAW10: 每4个像素5字节，前4字节为各像素的高8位，第5字节从低位起依次为4个像素的低2位
+// RAW12: 每2个像素3字节，前2字节为各像素的高8位，第3字节低/高4位为两个像素的低4位
+// Bayer格式与MONO格式打包方式相同，解包后仍为单通道原始数据
+
+// 打包格式的像素位数(10/12)，不是CSI打包格式时返回0
+int funny_csi_bits(uint32_t pixel_format);
+
+// 每行打包后的字节数，行末不足一组的像素按整组计
+int funny_csi_row_bytes(int width, int bits);
+
+// 解包为16位，在同一遍中完成移位：shift>0左移(如10位数据左移6位对齐到高位)，shift<0右移
+// 运行时按CPU选择SSSE3/NEON内核，与标量实现逐位一致
+// src_stride/dst_stride为行字节数，src_stride为0时取funny_csi_row_bytes，dst_stride为0时取width * 2
+// parallel为true时按行带分给TYWorkerPool::shared()；参数无效时返回false
+bool funny_csi_unpack(
+    const uint8_t* src, int src_stride,
+    uint16_t* dst, int dst_stride,
+    int width, int height, int bits,
+    int shift = 0, bool parallel = false
+);
+
+// 当前选用的内核名称("ssse3"/"neon"/"scalar")
+const char* funny_csi_kernel();
+
+#endif
@@ -0,0 +1,985 @@
+#include "funny_jpeg.hpp"
+#include "TYWorkerPool.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FUNNY_JPEG_SSE2 1
+#include <emmintrin.h>
+#endif
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define FUNNY_JPEG_NEON 1
+#include <arm_neon.h>
+#endif
+
+static const int kLookupBits = 9;
+
+// 反变换定点参数：系数为Q13，第一遍保留2位小数，第二遍还原并加上128的电平偏移
+static const int kPass1Shift = 11;
+static const int kPass2Shift = 15;
+static const int kPass1Bias  = 1 << (kPass1Shift - 1);
+static const int kPass2Bias  = (1 << (kPass2Shift - 1)) + (128 << kPass2Shift);
+
+// zigzag序号 -> 自然顺序下标
+static const uint8_t kZigzag[64] = {
+     0,  1,  8, 16,  9,  2,  3, 10, 17, 24, 32, 25, 18, 11,  4,  5,
+    12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13,  6,  7, 14, 21, 28,
+    35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+    58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63
+};
+
+// ITU-T T.81 附录K.3的标准Huffman表，MJPG码流通常省略DHT
+static const uint8_t kStdDcLumaBits[16]   = {0, 1, 5, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0};
+static const uint8_t kStdDcChromaBits[16] = {0, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0};
+static const uint8_t kStdDcVals[12]       = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+
+static const uint8_t kStdAcLumaBits[16]   = {0, 2, 1, 3, 3, 2, 4, 3, 5, 5, 4, 4, 0, 0, 1, 0x7d};
+static const uint8_t kStdAcLumaVals[162]  = {
+    0x01, 0x02, 0x03, 0x00, 0x04, 0x11, 0x05, 0x12, 0x21, 0x31, 0x41, 0x06, 0x13, 0x51, 0x61, 0x07,
+    0x22, 0x71, 0x14, 0x32, 0x81, 0x91, 0xa1, 0x08, 0x23, 0x42, 0xb1, 0xc1, 0x15, 0x52, 0xd1, 0xf0,
+    0x24, 0x33, 0x62, 0x72, 0x82, 0x09, 0x0a, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x25, 0x26, 0x27, 0x28,
+    0x29, 0x2a, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49,
+    0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69,
+    0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89,
+    0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6, 0xa7,
+    0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3, 0xc4, 0xc5,
+    0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda, 0xe1, 0xe2,
+    0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8,
+    0xf9, 0xfa
+};
+
+static const uint8_t kStdAcChromaBits[16] = {0, 2, 1, 2, 4, 4, 3, 4, 7, 5, 4, 4, 0, 1, 2, 0x77};
+static const uint8_t kStdAcChromaVals[162] = {
+    0x00, 0x01, 0x02, 0x03, 0x11, 0x04, 0x05, 0x21, 0x31, 0x06, 0x12, 0x41, 0x51, 0x07, 0x61, 0x71,
+    0x13, 0x22, 0x32, 0x81, 0x08, 0x14, 0x42, 0x91, 0xa1, 0xb1, 0xc1, 0x09, 0x23, 0x33, 0x52, 0xf0,
+    0x15, 0x62, 0x72, 0xd1, 0x0a, 0x16, 0x24, 0x34, 0xe1, 0x25, 0xf1, 0x17, 0x18, 0x19, 0x1a, 0x26,
+    0x27, 0x28, 0x29, 0x2a, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48,
+    0x49, 0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68,
+    0x69, 0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87,
+    0x88, 0x89, 0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5,
+    0xa6, 0xa7, 0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3,
+    0xc4, 0xc5, 0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda,
+    0xe2, 0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8,
+    0xf9, 0xfa
+};
+
+static inline uint8_t clamp8(int v)
+{
+    return static_cast<uint8_t>(v < 0 ? 0 : (v > 255 ? 255 : v));
+}
+
+static inline int16_t sat16(int v)
+{
+    return static_cast<int16_t>(v < -32768 ? -32768 : (v > 32767 ? 32767 : v));
+}
+
+// 两个int16打包成一个32位值(lo在低位)，用于构造madd系数
+static inline int32_t pack16(int16_t lo, int16_t hi)
+{
+    return static_cast<int32_t>((static_cast<uint32_t>(static_cast<uint16_t>(hi)) << 16) | static_cast<uint16_t>(lo));
+}
+
+// ---------------------------------------------------------------------------
+// Huffman解码
+
+struct HuffTable {
+    bool     valid;
+    uint8_t  fast_len[1 << kLookupBits];    // 码长不超过kLookupBits时直接查表，0表示走慢速路径
+    uint8_t  fast_val[1 << kLookupBits];
+    int32_t  maxcode[17];                   // 各码长的最大码值，-1表示没有该长度的码
+    int32_t  valoff[17];                    // 码值 + valoff = vals下标
+    uint8_t  vals[256];
+};
+
+static bool buildHuffTable(HuffTable& t, const uint8_t bits[16], const uint8_t* vals, int count)
+{
+    memset(&t, 0, sizeof(t));
+    memcpy(t.vals, vals, count);
+    int code = 0;
+    int k = 0;
+    for (int len = 1; len <= 16; len++) {
+        int n = bits[len - 1];
+        t.valoff[len] = k - code;
+        if (len <= kLookupBits) {
+            int shift = kLookupBits - len;
+            for (int i = 0; i < n; i++) {
+                int base = (code + i) << shift;
+                for (int j = 0; j < (1 << shift); j++) {
+                    t.fast_len[base + j] = static_cast<uint8_t>(len);
+                    t.fast_val[base + j] = vals[k + i];
+                }
+            }
+        }
+        code += n;
+        k += n;
+        t.maxcode[len] = n ? code - 1 : -1;
+        if (code > (1 << len)) {
+            return false;
+        }
+        code <<= 1;
+    }
+    t.valid = true;
+    return true;
+}
+
+// 熵编码数据读取：去掉0xFF00填充，遇到标记(复位标记/EOI)后一律补0
+struct BitReader {
+    const uint8_t* p;
+    const uint8_t* end;
+    uint64_t       buf;
+    int            bits;
+
+    void reset(const uint8_t* begin, const uint8_t* stop)
+    {
+        p = begin;
+        end = stop;
+        buf = 0;
+        bits = 0;
+    }
+
+    void fill()
+    {
+        while (bits <= 56) {
+            uint32_t b = 0;
+            if (p < end) {
+                b = *p;
+                if (b != 0xFF) {
+                    p++;
+                } else if (p + 1 < end && p[1] == 0x00) {
+                    p += 2;
+                } else {
+                    b = 0;
+                    end = p;
+                }
+            }
+            buf |= static_cast<uint64_t>(b) << (56 - bits);
+            bits += 8;
+        }
+    }
+
+    uint32_t peek(int n) const { return static_cast<uint32_t>(buf >> (64 - n)); }
+    void skip(int n) { buf <<= n; bits -= n; }
+};
+
+static inline int decodeHuff(BitReader& br, const HuffTable& t)
+{
+    if (br.bits < 32) {
+        br.fill();
+    }
+    uint32_t idx = br.peek(kLookupBits);
+    int len = t.fast_len[idx];
+    if (len) {
+        br.skip(len);
+        return t.fast_val[idx];
+    }
+    for (len = kLookupBits + 1; len <= 16; len++) {
+        int32_t code = static_cast<int32_t>(br.peek(len));
+        if (code <= t.maxcode[len]) {
+            br.skip(len);
+            return t.vals[(t.valoff[len] + code) & 0xFF];
+        }
+    }
+    // 非法码字，按0处理
+    br.skip(16);
+    return 0;
+}
+
+static inline int receiveExtend(BitReader& br, int s)
+{
+    if (br.bits < s) {
+        br.fill();
+    }
+    int v = static_cast<int>(br.peek(s));
+    br.skip(s);
+    return v < (1 << (s - 1)) ? v - (1 << s) + 1 : v;
+}
+
+// 解码一个8x8块并反量化到自然顺序；返回最后一个非零系数的zigzag序号(0表示只有DC)
+static int decodeBlock(BitReader& br, const HuffTable& dc, const HuffTable& ac,
+                       int& pred, const uint16_t* q, int16_t* coef)
+{
+    memset(coef, 0, 64 * sizeof(int16_t));
+    int t = decodeHuff(br, dc) & 15;
+    if (t) {
+        pred += receiveExtend(br, t);
+    }
+    // 合法码流的反量化系数不超过±2048左右，限幅保证反变换的中间值不溢出
+    coef[0] = static_cast<int16_t>(std::max(-4096, std::min(4095, pred * q[0])));
+    int last = 0;
+    for (int k = 1; k < 64; k++) {
+        int rs = decodeHuff(br, ac);
+        int r = rs >> 4;
+        int s = rs & 15;
+        if (!s) {
+            if (r != 15) {
+                break;
+            }
+            k += 15;
+            continue;
+        }
+        k += r;
+        if (k > 63) {
+            break;
+        }
+        coef[kZigzag[k]] = static_cast<int16_t>(std::max(-4096, std::min(4095, receiveExtend(br, s) * q[k])));
+        last = k;
+    }
+    return last;
+}
+
+// ---------------------------------------------------------------------------
+// 反变换
+
+// A[u][x] = C(u)/2 * cos((2x+1)uπ/2N) * D(u)，Q13
+// N点反变换只用低频的N个系数，即在DCT域缩小到N/8；D(u)为8/N个像素取平均对该频率的衰减，
+// 使缩小结果接近先全尺寸解码再做区域平均
+struct IdctTables {
+    int16_t a8[8][8];
+    int16_t a4[4][4];
+    int16_t a2[2][2];
+    int16_t a1[1][1];
+    int32_t pairs[4][8];    // pack16(a8[2k][x], a8[2k+1][x])，SIMD内核用
+
+    IdctTables()
+    {
+        fill(&a8[0][0], 8);
+        fill(&a4[0][0], 4);
+        fill(&a2[0][0], 2);
+        fill(&a1[0][0], 1);
+        for (int k = 0; k < 4; k++) {
+            for (int x = 0; x < 8; x++) {
+                pairs[k][x] = pack16(a8[2 * k][x], a8[2 * k + 1][x]);
+            }
+        }
+    }
+
+    const int16_t* table(int n) const
+    {
+        return n == 8 ? &a8[0][0] : n == 4 ? &a4[0][0] : n == 2 ? &a2[0][0] : &a1[0][0];
+    }
+
+    static void fill(int16_t* a, int n)
+    {
+        const double pi = 3.14159265358979323846;
+        const int s = 8 / n;
+        for (int u = 0; u < n; u++) {
+            double c = (u == 0 ? std::sqrt(0.5) : 1.0) * 0.5;
+            if (u > 0 && s > 1) {
+                c *= std::sin(u * s * pi / 16) / (s * std::sin(u * pi / 16));
+            }
+            for (int x = 0; x < n; x++) {
+                a[u * n + x] = static_cast<int16_t>(std::lround(c * std::cos((2 * x + 1) * u * pi / (2 * n)) * 8192));
+            }
+        }
+    }
+};
+
+static const IdctTables& idctTables()
+{
+    static IdctTables tables;
+    return tables;
+}
+
+// 只有DC时整块为同一个值，与完整反变换的结果逐位一致
+static inline uint8_t idctDC(int16_t dc)
+{
+    int t = sat16((dc * idctTables().a8[0][0] + kPass1Bias) >> kPass1Shift);
+    return clamp8((idctTables().a8[0][0] * t + kPass2Bias) >> kPass2Shift);
+}
+
+// NX/NY为水平/垂直方向的反变换点数(8/4/2/1)，做成模板参数让缩小解码时的小尺寸循环完全展开
+template <int NX, int NY>
+static void idctScalar(const int16_t* in, uint8_t* out, int stride)
+{
+    const IdctTables& T = idctTables();
+    const int16_t* ax = T.table(NX);
+    const int16_t* ay = T.table(NY);
+    int16_t t[NX * NY];
+    for (int r = 0; r < NY; r++) {
+        for (int x = 0; x < NX; x++) {
+            int s = kPass1Bias;
+            for (int u = 0; u < NX; u++) {
+                s += in[r * 8 + u] * ax[u * NX + x];
+            }
+            t[r * NX + x] = sat16(s >> kPass1Shift);
+        }
+    }
+    for (int y = 0; y < NY; y++) {
+        for (int x = 0; x < NX; x++) {
+            int s = kPass2Bias;
+            for (int v = 0; v < NY; v++) {
+                s += ay[v * NY + y] * t[v * NX + x];
+            }
+            out[y * stride + x] = clamp8(s >> kPass2Shift);
+        }
+    }
+}
+
+#ifdef FUNNY_JPEG_SSE2
+
+// 第一遍按行：每个双字广播一对系数(F[2k], F[2k+1])与对应的一对基函数做madd
+// 第二遍按列：把相邻两行交织后与广播的(A[2k][y], A[2k+1][y])做madd，不需要转置
+static void idct8SSE2(const int16_t* in, uint8_t* out, int stride)
+{
+    const IdctTables& T = idctTables();
+    __m128i plo[4], phi[4];
+    for (int k = 0; k < 4; k++) {
+        plo[k] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&T.pairs[k][0]));
+        phi[k] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&T.pairs[k][4]));
+    }
+
+    const __m128i bias1 = _mm_set1_epi32(kPass1Bias);
+    __m128i t[8];
+    for (int r = 0; r < 8; r++) {
+        __m128i row = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + r * 8));
+        __m128i p0 = _mm_shuffle_epi32(row, 0x00);
+        __m128i p1 = _mm_shuffle_epi32(row, 0x55);
+        __m128i p2 = _mm_shuffle_epi32(row, 0xAA);
+        __m128i p3 = _mm_shuffle_epi32(row, 0xFF);
+        __m128i lo = _mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(p0, plo[0]), _mm_madd_epi16(p1, plo[1])),
+                                   _mm_add_epi32(_mm_madd_epi16(p2, plo[2]), _mm_madd_epi16(p3, plo[3])));
+        __m128i hi = _mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(p0, phi[0]), _mm_madd_epi16(p1, phi[1])),
+                                   _mm_add_epi32(_mm_madd_epi16(p2, phi[2]), _mm_madd_epi16(p3, phi[3])));
+        lo = _mm_srai_epi32(_mm_add_epi32(lo, bias1), kPass1Shift);
+        hi = _mm_srai_epi32(_mm_add_epi32(hi, bias1), kPass1Shift);
+        t[r] = _mm_packs_epi32(lo, hi);
+    }
+
+    __m128i qlo[4], qhi[4];
+    for (int k = 0; k < 4; k++) {
+        qlo[k] = _mm_unpacklo_epi16(t[2 * k], t[2 * k + 1]);
+        qhi[k] = _mm_unpackhi_epi16(t[2 * k], t[2 * k + 1]);
+    }
+
+    const __m128i bias2 = _mm_set1_epi32(kPass2Bias);
+    for (int y = 0; y < 8; y++) {
+        __m128i lo = bias2;
+        __m128i hi = bias2;
+        for (int k = 0; k < 4; k++) {
+            __m128i c = _mm_set1_epi32(T.pairs[k][y]);
+            lo = _mm_add_epi32(lo, _mm_madd_epi16(qlo[k], c));
+            hi = _mm_add_epi32(hi, _mm_madd_epi16(qhi[k], c));
+        }
+        __m128i v = _mm_packs_epi32(_mm_srai_epi32(lo, kPass2Shift), _mm_srai_epi32(hi, kPass2Shift));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(out + y * stride), _mm_packus_epi16(v, v));
+    }
+}
+
+#endif // FUNNY_JPEG_SSE2
+
+#ifdef FUNNY_JPEG_NEON
+
+#define FUNNY_JPEG_MLA_LANE(acc, a, v, lane) vmlal_lane_s16(acc, a, v, lane)
+
+static void idct8NEON(const int16_t* in, uint8_t* out, int stride)
+{
+    const IdctTables& T = idctTables();
+    int16x4_t alo[8], ahi[8];
+    for (int u = 0; u < 8; u++) {
+        alo[u] = vld1_s16(&T.a8[u][0]);
+        ahi[u] = vld1_s16(&T.a8[u][4]);
+    }
+
+    int16x8_t t[8];
+    for (int r = 0; r < 8; r++) {
+        int16x8_t row = vld1q_s16(in + r * 8);
+        int16x4_t rl = vget_low_s16(row);
+        int16x4_t rh = vget_high_s16(row);
+        int32x4_t lo = vdupq_n_s32(kPass1Bias);
+        int32x4_t hi = vdupq_n_s32(kPass1Bias);
+        lo = FUNNY_JPEG_MLA_LANE(lo, alo[0], rl, 0); hi = FUNNY_JPEG_MLA_LANE(hi, ahi[0], rl, 0);
+        lo = FUNNY_JPEG_MLA_LANE(lo, alo[1], rl, 1); hi = FUNNY_JPEG_MLA_LANE(hi, ahi[1], rl, 1);
+        lo = FUNNY_JPEG_MLA_LANE(lo, alo[2], rl, 2); hi = FUNNY_JPEG_MLA_LANE(hi, ahi[2], rl, 2);
+        lo = FUNNY_JPEG_MLA_LANE(lo, alo[3], rl, 3); hi = FUNNY_JPEG_MLA_LANE(hi, ahi[3], rl, 3);
+        lo = FUNNY_JPEG_MLA_LANE(lo, alo[4], rh, 0); hi = FUNNY_JPEG_MLA_LANE(hi, ahi[4], rh, 0);
+        lo = FUNNY_JPEG_MLA_LANE(lo, alo[5], rh, 1); hi = FUNNY_JPEG_MLA_LANE(hi, ahi[5], rh, 1);
+        lo = FUNNY_JPEG_MLA_LANE(lo, alo[6], rh, 2); hi = FUNNY_JPEG_MLA_LANE(hi, ahi[6], rh, 2);
+        lo = FUNNY_JPEG_MLA_LANE(lo, alo[7], rh, 3); hi = FUNNY_JPEG_MLA_LANE(hi, ahi[7], rh, 3);
+        t[r] = vcombine_s16(vqmovn_s32(vshrq_n_s32(lo, kPass1Shift)), vqmovn_s32(vshrq_n_s32(hi, kPass1Shift)));
+    }
+
+    for (int y = 0; y < 8; y++) {
+        int32x4_t lo = vdupq_n_s32(kPass2Bias);
+        int32x4_t hi = vdupq_n_s32(kPass2Bias);
+        for (int v = 0; v < 8; v++) {
+            lo = vmlal_n_s16(lo, vget_low_s16(t[v]), T.a8[v][y]);
+            hi = vmlal_n_s16(hi, vget_high_s16(t[v]), T.a8[v][y]);
+        }
+        int16x8_t r = vcombine_s16(vqmovn_s32(vshrq_n_s32(lo, kPass2Shift)), vqmovn_s32(vshrq_n_s32(hi, kPass2Shift)));
+        vst1_u8(out + y * stride, vqmovun_s16(r));
+    }
+}
+
+#undef FUNNY_JPEG_MLA_LANE
+
+#endif // FUNNY_JPEG_NEON
+
+// nx/ny为反变换尺寸(8/4/2/1)，last为decodeBlock的返回值
+static inline void idctBlock(const int16_t* coef, int last, uint8_t* out, int stride, int nx, int ny)
+{
+    if (last == 0 || (nx == 1 && ny == 1)) {
+        uint8_t v = idctDC(coef[0]);
+        for (int y = 0; y < ny; y++) {
+            memset(out + y * stride, v, nx);
+        }
+        return;
+    }
+    if (nx == 8 && ny == 8) {
+#if defined(FUNNY_JPEG_SSE2)
+        idct8SSE2(coef, out, stride);
+#elif defined(FUNNY_JPEG_NEON)
+        idct8NEON(coef, out, stride);
+#else
+        idctScalar<8, 8>(coef, out, stride);
+#endif
+        return;
+    }
+    // 色度块的水平/垂直点数可以不同(如4:2:2缩小时为4x2)
+    switch (nx * 16 + ny) {
+    case 0x84: idctScalar<8, 4>(coef, out, stride); break;
+    case 0x48: idctScalar<4, 8>(coef, out, stride); break;
+    case 0x44: idctScalar<4, 4>(coef, out, stride); break;
+    case 0x42: idctScalar<4, 2>(coef, out, stride); break;
+    case 0x24: idctScalar<2, 4>(coef, out, stride); break;
+    case 0x22: idctScalar<2, 2>(coef, out, stride); break;
+    case 0x82: idctScalar<8, 2>(coef, out, stride); break;
+    case 0x28: idctScalar<2, 8>(coef, out, stride); break;
+    case 0x81: idctScalar<8, 1>(coef, out, stride); break;
+    case 0x18: idctScalar<1, 8>(coef, out, stride); break;
+    case 0x41: idctScalar<4, 1>(coef, out, stride); break;
+    case 0x14: idctScalar<1, 4>(coef, out, stride); break;
+    case 0x21: idctScalar<2, 1>(coef, out, stride); break;
+    default:   idctScalar<1, 2>(coef, out, stride); break;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// YCbCr(JFIF全范围) -> BGR，Q14定点：
+// R = Y + 1.402*Cr，G = Y - 0.34414*Cb - 0.71414*Cr，B = Y + 1.772*Cb
+
+static const int16_t kCrR = 22970;
+static const int16_t kCbG = -5638;
+static const int16_t kCrG = -11700;
+static const int16_t kCbB = 29032;
+
+static inline void ycc2bgr(uint8_t* d, int y, int cb, int cr)
+{
+    cb -= 128;
+    cr -= 128;
+    d[0] = clamp8(y + ((kCbB * cb + 8192) >> 14));
+    d[1] = clamp8(y + ((kCbG * cb + kCrG * cr + 8192) >> 14));
+    d[2] = clamp8(y + ((kCrR * cr + 8192) >> 14));
+}
+
+static void colorRow(const uint8_t* y, const uint8_t* cb, const uint8_t* cr, uint8_t* dst, int width)
+{
+    int x = 0;
+#if defined(FUNNY_JPEG_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i c128 = _mm_set1_epi16(128);
+    const __m128i kr = _mm_set1_epi32(pack16(0, kCrR));
+    const __m128i kg = _mm_set1_epi32(pack16(kCbG, kCrG));
+    const __m128i kb = _mm_set1_epi32(pack16(kCbB, 0));
+    const __m128i half = _mm_set1_epi32(8192);
+    // 每次8个像素，按4字节重叠写出，最后一组留给标量处理以免越界
+    for (; x + 8 < width; x += 8) {
+        __m128i yy = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(y + x)), zero);
+        __m128i u = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(cb + x)), zero), c128);
+        __m128i v = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(cr + x)), zero), c128);
+        __m128i uvlo = _mm_unpacklo_epi16(u, v);
+        __m128i uvhi = _mm_unpackhi_epi16(u, v);
+        __m128i r = _mm_packs_epi32(_mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(uvlo, kr), half), 14),
+                                    _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(uvhi, kr), half), 14));
+        __m128i g = _mm_packs_epi32(_mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(uvlo, kg), half), 14),
+                                    _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(uvhi, kg), half), 14));
+        __m128i b = _mm_packs_epi32(_mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(uvlo, kb), half), 14),
+                                    _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(uvhi, kb), half), 14));
+        r = _mm_packus_epi16(_mm_add_epi16(yy, r), zero);
+        g = _mm_packus_epi16(_mm_add_epi16(yy, g), zero);
+        b = _mm_packus_epi16(_mm_add_epi16(yy, b), zero);
+        __m128i bg = _mm_unpacklo_epi8(b, g);
+        __m128i r0 = _mm_unpacklo_epi8(r, zero);
+        __m128i p[2] = {_mm_unpacklo_epi16(bg, r0), _mm_unpackhi_epi16(bg, r0)};
+        uint8_t* d = dst + x * 3;
+        for (int h = 0; h < 2; h++, d += 12) {
+            uint32_t px[4];
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(px), p[h]);
+            memcpy(d, &px[0], 4);
+            memcpy(d + 3, &px[1], 4);
+            memcpy(d + 6, &px[2], 4);
+            memcpy(d + 9, &px[3], 4);
+        }
+    }
+#elif defined(FUNNY_JPEG_NEON)
+    const int16x8_t c128 = vdupq_n_s16(128);
+    const int32x4_t half = vdupq_n_s32(8192);
+    for (; x + 8 <= width; x += 8) {
+        int16x8_t yy = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(y + x)));
+        int16x8_t u = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vld1_u8(cb + x))), c128);
+        int16x8_t v = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vld1_u8(cr + x))), c128);
+        int32x4_t rl = vmlal_n_s16(half, vget_low_s16(v), kCrR);
+        int32x4_t rh = vmlal_n_s16(half, vget_high_s16(v), kCrR);
+        int32x4_t gl = vmlal_n_s16(vmlal_n_s16(half, vget_low_s16(u), kCbG), vget_low_s16(v), kCrG);
+        int32x4_t gh = vmlal_n_s16(vmlal_n_s16(half, vget_high_s16(u), kCbG), vget_high_s16(v), kCrG);
+        int32x4_t bl = vmlal_n_s16(half, vget_low_s16(u), kCbB);
+        int32x4_t bh = vmlal_n_s16(half, vget_high_s16(u), kCbB);
+        uint8x8x3_t out;
+        out.val[0] = vqmovun_s16(vaddq_s16(yy, vcombine_s16(vqmovn_s32(vshrq_n_s32(bl, 14)), vqmovn_s32(vshrq_n_s32(bh, 14)))));
+        out.val[1] = vqmovun_s16(vaddq_s16(yy, vcombine_s16(vqmovn_s32(vshrq_n_s32(gl, 14)), vqmovn_s32(vshrq_n_s32(gh, 14)))));
+        out.val[2] = vqmovun_s16(vaddq_s16(yy, vcombine_s16(vqmovn_s32(vshrq_n_s32(rl, 14)), vqmovn_s32(vshrq_n_s32(rh, 14)))));
+        vst3_u8(dst + x * 3, out);
+    }
+#endif
+    for (; x < width; x++) {
+        ycc2bgr(dst + x * 3, y[x], cb[x], cr[x]);
+    }
+}
+
+// 分量直接是RGB时只交换到BGR顺序
+static void rgbRow(const uint8_t* r, const uint8_t* g, const uint8_t* b, uint8_t* dst, int width)
+{
+    int x = 0;
+#if defined(FUNNY_JPEG_NEON)
+    for (; x + 16 <= width; x += 16) {
+        uint8x16x3_t out;
+        out.val[0] = vld1q_u8(b + x);
+        out.val[1] = vld1q_u8(g + x);
+        out.val[2] = vld1q_u8(r + x);
+        vst3q_u8(dst + x * 3, out);
+    }
+#endif
+    for (; x < width; x++) {
+        dst[3 * x]     = b[x];
+        dst[3 * x + 1] = g[x];
+        dst[3 * x + 2] = r[x];
+    }
+}
+
+// ---------------------------------------------------------------------------
+// 帧头解析
+
+struct JpegComponent {
+    int id;
+    int h, v;
+    int tq;
+    int td, ta;
+};
+
+struct JpegDecoder {
+    int width;
+    int height;
+    int ncomp;
+    JpegComponent comp[3];
+    int hmax, vmax;
+    int mcux, mcuy;
+    int restart_interval;
+    bool adobe;                 // 码流带Adobe APP14
+    int transform;              // APP14中的颜色变换：0为RGB/CMYK，1为YCbCr，2为YCCK
+    bool rgb;                   // 3个分量直接是RGB
+    uint16_t quant[4][64];      // zigzag顺序
+    bool quant_valid[4];
+    HuffTable dc[4];
+    HuffTable ac[4];
+    const uint8_t* scan;        // 熵编码数据起点
+    const uint8_t* end;
+    std::vector<const uint8_t*> segments;   // 各复位段的起点
+};
+
+static bool parseSOF(JpegDecoder& d, const uint8_t* p, const uint8_t* end)
+{
+    if (end - p < 6 || p[0] != 8) {
+        return false;
+    }
+    d.height = (p[1] << 8) | p[2];
+    d.width  = (p[3] << 8) | p[4];
+    d.ncomp  = p[5];
+    // 高度为0需要DNL标记，不支持
+    if (d.width == 0 || d.height == 0 || (d.ncomp != 1 && d.ncomp != 3) || end - p < 6 + 3 * d.ncomp) {
+        return false;
+    }
+    d.hmax = d.vmax = 1;
+    for (int i = 0; i < d.ncomp; i++) {
+        JpegComponent& c = d.comp[i];
+        c.id = p[6 + 3 * i];
+        c.h  = p[7 + 3 * i] >> 4;
+        c.v  = p[7 + 3 * i] & 15;
+        c.tq = p[8 + 3 * i];
+        if (c.h < 1 || c.h > 4 || c.v < 1 || c.v > 4 || c.tq > 3) {
+            return false;
+        }
+        if (d.ncomp == 1) {
+            // 单分量扫描不交织，MCU固定为一个8x8块
+            c.h = c.v = 1;
+        }
+        d.hmax = std::max(d.hmax, c.h);
+        d.vmax = std::max(d.vmax, c.v);
+    }
+    for (int i = 0; i < d.ncomp; i++) {
+        // 色度按整数倍复制上采样
+        if (d.hmax % d.comp[i].h || d.vmax % d.comp[i].v) {
+            return false;
+        }
+    }
+    d.mcux = (d.width + 8 * d.hmax - 1) / (8 * d.hmax);
+    d.mcuy = (d.height + 8 * d.vmax - 1) / (8 * d.vmax);
+    return true;
+}
+
+static bool parseDHT(JpegDecoder& d, const uint8_t* p, const uint8_t* end)
+{
+    while (p < end) {
+        if (end - p < 17) {
+            return false;
+        }
+        int tc = p[0] >> 4;
+        int th = p[0] & 15;
+        if (tc > 1 || th > 3) {
+            return false;
+        }
+        int count = 0;
+        for (int i = 0; i < 16; i++) {
+            count += p[1 + i];
+        }
+        if (count > 256 || end - p < 17 + count) {
+            return false;
+        }
+        if (!buildHuffTable(tc ? d.ac[th] : d.dc[th], p + 1, p + 17, count)) {
+            return false;
+        }
+        p += 17 + count;
+    }
+    return true;
+}
+
+static bool parseDQT(JpegDecoder& d, const uint8_t* p, const uint8_t* end)
+{
+    while (p < end) {
+        int pq = p[0] >> 4;
+        int tq = p[0] & 15;
+        int n = pq ? 128 : 64;
+        if (pq > 1 || tq > 3 || end - p < 1 + n) {
+            return false;
+        }
+        for (int k = 0; k < 64; k++) {
+            d.quant[tq][k] = pq ? static_cast<uint16_t>((p[1 + 2 * k] << 8) | p[2 + 2 * k]) : p[1 + k];
+        }
+        d.quant_valid[tq] = true;
+        p += 1 + n;
+    }
+    return true;
+}
+
+static bool parseSOS(JpegDecoder& d, const uint8_t* p, const uint8_t* end)
+{
+    // 只支持包含全部分量的单次交织扫描
+    if (end - p < 1 || p[0] != d.ncomp || end - p < 1 + 2 * d.ncomp) {
+        return false;
+    }
+    for (int i = 0; i < d.ncomp; i++) {
+        int id = p[1 + 2 * i];
+        int j = 0;
+        while (j < d.ncomp && d.comp[j].id != id) {
+            j++;
+        }
+        if (j == d.ncomp) {
+            return false;
+        }
+        JpegComponent& c = d.comp[j];
+        c.td = p[2 + 2 * i] >> 4;
+        c.ta = p[2 + 2 * i] & 15;
+        if (c.td > 3 || c.ta > 3 || !d.dc[c.td].valid || !d.ac[c.ta].valid || !d.quant_valid[c.tq]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool parseHeaders(JpegDecoder& d, const uint8_t* src, size_t size)
+{
+    if (!src || size < 4 || src[0] != 0xFF || src[1] != 0xD8) {
+        return false;
+    }
+    buildHuffTable(d.dc[0], kStdDcLumaBits, kStdDcVals, 12);
+    buildHuffTable(d.dc[1], kStdDcChromaBits, kStdDcVals, 12);
+    buildHuffTable(d.ac[0], kStdAcLumaBits, kStdAcLumaVals, 162);
+    buildHuffTable(d.ac[1], kStdAcChromaBits, kStdAcChromaVals, 162);
+
+    const uint8_t* p = src + 2;
+    const uint8_t* end = src + size;
+    bool sof = false;
+    for (;;) {
+        while (p < end && *p != 0xFF) {
+            p++;
+        }
+        while (p < end && *p == 0xFF) {
+            p++;
+        }
+        if (p >= end) {
+            return false;
+        }
+        uint8_t m = *p++;
+        if (m == 0xD8 || m == 0x01 || (m >= 0xD0 && m <= 0xD7)) {
+            continue;
+        }
+        if (m == 0xD9 || end - p < 2) {
+            return false;
+        }
+        int len = (p[0] << 8) | p[1];
+        if (len < 2 || end - p < len) {
+            return false;
+        }
+        const uint8_t* seg = p + 2;
+        const uint8_t* segEnd = p + len;
+        p = segEnd;
+
+        bool ok = true;
+        switch (m) {
+            case 0xC0:
+            case 0xC1:
+                ok = parseSOF(d, seg, segEnd);
+                sof = ok;
+                break;
+            case 0xC4:
+                ok = parseDHT(d, seg, segEnd);
+                break;
+            case 0xDB:
+                ok = parseDQT(d, seg, segEnd);
+                break;
+            case 0xDD:
+                ok = (segEnd - seg >= 2);
+                if (ok) {
+                    d.restart_interval = (seg[0] << 8) | seg[1];
+                }
+                break;
+            case 0xEE:
+                // "Adobe" + version(2) + flags0(2) + flags1(2) + transform(1)
+                if (segEnd - seg >= 12 && memcmp(seg, "Adobe", 5) == 0) {
+                    d.adobe = true;
+                    d.transform = seg[11];
+                }
+                break;
+            case 0xDA:
+                if (!sof || !parseSOS(d, seg, segEnd)) {
+                    return false;
+                }
+                // 与libjpeg的判断一致：有APP14时以transform为准，否则分量ID为'R','G','B'时视为RGB
+                d.rgb = d.ncomp == 3 &&
+                        (d.adobe ? d.transform == 0
+                                 : (d.comp[0].id == 'R' && d.comp[1].id == 'G' && d.comp[2].id == 'B'));
+                d.scan = segEnd;
+                d.end = end;
+                return true;
+            default:
+                // 渐进式、无损、算术编码等SOF
+                ok = !(m >= 0xC2 && m <= 0xCF);
+                break;
+        }
+        if (!ok) {
+            return false;
+        }
+    }
+}
+
+// 记录各复位段的起点，并行解码时每个任务从自己的复位段开始
+static void findSegments(JpegDecoder& d)
+{
+    d.segments.clear();
+    d.segments.push_back(d.scan);
+    if (!d.restart_interval) {
+        return;
+    }
+    const uint8_t* p = d.scan;
+    while (p + 1 < d.end) {
+        p = static_cast<const uint8_t*>(memchr(p, 0xFF, d.end - p - 1));
+        if (!p) {
+            break;
+        }
+        uint8_t m = p[1];
+        if (m == 0x00 || m == 0xFF) {
+            p += (m == 0x00) ? 2 : 1;
+        } else if (m >= 0xD0 && m <= 0xD7) {
+            d.segments.push_back(p + 2);
+            p += 2;
+        } else {
+            break;
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// 解码
+
+// 解码[row_begin, row_end)的MCU行；row_begin * mcux必须是复位段的起点
+static void decodeRows(const JpegDecoder& d, int n, int row_begin, int row_end, uint8_t* dst, int dst_stride)
+{
+    const int outW = (d.width * n + 7) / 8;
+    const int outH = (d.height * n + 7) / 8;
+
+    // 每个分量一个MCU行高的平面缓冲；缩小解码时色度块用更大的反变换尺寸，
+    // 直接得到输出分辨率的色度，只有全尺寸时才需要复制上采样
+    std::vector<uint8_t> planes[3];
+    int pstride[3];
+    int bw[3];
+    int bh[3];
+    for (int c = 0; c < d.ncomp; c++) {
+        bw[c] = std::min(8, n * d.hmax / d.comp[c].h);
+        bh[c] = std::min(8, n * d.vmax / d.comp[c].v);
+        pstride[c] = d.mcux * d.comp[c].h * bw[c];
+        planes[c].resize(static_cast<size_t>(pstride[c]) * d.comp[c].v * bh[c]);
+    }
+    std::vector<uint8_t> upsampled[3];
+    std::vector<int> xmap[3];
+    for (int c = 0; c < d.ncomp; c++) {
+        int num = d.comp[c].h * bw[c];
+        int den = d.hmax * n;
+        if (num != den) {
+            upsampled[c].resize(outW);
+            xmap[c].resize(outW);
+            for (int x = 0; x < outW; x++) {
+                xmap[c][x] = x * num / den;
+            }
+        }
+    }
+
+    const int ri = d.restart_interval;
+    size_t seg = ri ? static_cast<size_t>(row_begin) * d.mcux / ri : 0;
+    int left = ri;
+    BitReader br;
+    br.reset(seg < d.segments.size() ? d.segments[seg] : d.end, d.end);
+    int pred[3] = {0, 0, 0};
+    int16_t coef[64];
+
+    for (int row = row_begin; row < row_end; row++) {
+        for (int mx = 0; mx < d.mcux; mx++) {
+            if (ri) {
+                if (left == 0) {
+                    seg++;
+                    br.reset(seg < d.segments.size() ? d.segments[seg] : d.end, d.end);
+                    pred[0] = pred[1] = pred[2] = 0;
+                    left = ri;
+                }
+                left--;
+            }
+            for (int c = 0; c < d.ncomp; c++) {
+                const JpegComponent& comp = d.comp[c];
+                for (int by = 0; by < comp.v; by++) {
+                    for (int bx = 0; bx < comp.h; bx++) {
+                        int last = decodeBlock(br, d.dc[comp.td], d.ac[comp.ta], pred[c], d.quant[comp.tq], coef);
+                        uint8_t* o = &planes[c][static_cast<size_t>(by) * bh[c] * pstride[c] + (mx * comp.h + bx) * bw[c]];
+                        idctBlock(coef, last, o, pstride[c], bw[c], bh[c]);
+                    }
+                }
+            }
+        }
+
+        int y0 = row * d.vmax * n;
+        int y1 = std::min(y0 + d.vmax * n, outH);
+        for (int oy = y0; oy < y1; oy++) {
+            int ly = oy - y0;
+            uint8_t* out = dst + static_cast<size_t>(oy) * dst_stride;
+            const uint8_t* rows[3];
+            for (int c = 0; c < d.ncomp; c++) {
+                const uint8_t* src = &planes[c][static_cast<size_t>(ly * d.comp[c].v * bh[c] / (d.vmax * n)) * pstride[c]];
+                if (xmap[c].empty()) {
+                    rows[c] = src;
+                } else {
+                    for (int x = 0; x < outW; x++) {
+                        upsampled[c][x] = src[xmap[c][x]];
+                    }
+                    rows[c] = upsampled[c].data();
+                }
+            }
+            if (d.ncomp == 3 && d.rgb) {
+                rgbRow(rows[0], rows[1], rows[2], out, outW);
+            } else if (d.ncomp == 3) {
+                colorRow(rows[0], rows[1], rows[2], out, outW);
+            } else {
+                for (int x = 0; x < outW; x++) {
+                    out[3 * x] = out[3 * x + 1] = out[3 * x + 2] = rows[0][x];
+                }
+            }
+        }
+    }
+}
+
+static int gcd(int a, int b)
+{
+    while (b) {
+        int t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+bool funny_jpeg_info(const uint8_t* src, size_t size, FunnyJpegInfo& info)
+{
+    std::unique_ptr<JpegDecoder> d(new JpegDecoder());
+    if (!parseHeaders(*d, src, size)) {
+        return false;
+    }
+    info.width = d->width;
+    info.height = d->height;
+    info.components = d->ncomp;
+    info.rgb = d->rgb;
+    info.restart_interval = d->restart_interval;
+    return true;
+}
+
+int funny_jpeg_scaled_size(int size, int scale)
+{
+    return scale > 0 ? (size + scale - 1) / scale : 0;
+}
+
+const char* funny_jpeg_kernel()
+{
+#if defined(FUNNY_JPEG_SSE2)
+    return "sse2";
+#elif defined(FUNNY_JPEG_NEON)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
+
+bool funny_jpeg_decode(const uint8_t* src, size_t size, int scale,
+                       uint8_t* dst, int dst_stride, bool parallel)
+{
+    if (!dst || (scale != 1 && scale != 2 && scale != 4 && scale != 8)) {
+        return false;
+    }
+    std::unique_ptr<JpegDecoder> d(new JpegDecoder());
+    if (!parseHeaders(*d, src, size)) {
+        return false;
+    }
+    if (dst_stride < funny_jpeg_scaled_size(d->width, scale) * 3) {
+        return false;
+    }
+    const int n = 8 / scale;
+    findSegments(*d);
+
+    // 从第step的整数倍个MCU行开始的位置恰好是复位段起点
+    const int ri = d->restart_interval;
+    const int step = ri ? ri / gcd(ri, d->mcux) : d->mcuy;
+    if (!parallel || step >= d->mcuy) {
+        decodeRows(*d, n, 0, d->mcuy, dst, dst_stride);
+        return true;
+    }
+
+    TYWorkerPool& pool = TYWorkerPool::shared();
+    const int bands = (d->mcuy + step - 1) / step;
+    const int tasks = static_cast<int>(pool.size() + 1) * 4;
+    const int grain = std::max(1, (bands + tasks - 1) / tasks);
+    const JpegDecoder& dec = *d;
+    pool.parallel_for(0, bands, grain, [&](int begin, int end) {
+        decodeRows(dec, n, begin * step, std::min(end * step, dec.mcuy), dst, dst_stride);
+    });
+    return true;
+}
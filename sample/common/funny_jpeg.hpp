@@ -0,0 +1,33 @@
+#ifndef FUNNY_JPEG_HPP_
+#define FUNNY_JPEG_HPP_
+
+#include <stddef.h>
+#include <stdint.h>
+
+// JPEG/MJPG帧头信息
+struct FunnyJpegInfo {
+    int width;
+    int height;
+    int components;         // 1: 灰度，3: YCbCr或RGB
+    bool rgb;               // 3个分量直接是RGB(Adobe APP14 transform=0)，不做颜色转换
+    int restart_interval;   // 复位间隔(MCU数)，0表示码流中没有复位标记
+};
+
+// 解析到SOS为止；只支持8位精度的顺序Huffman编码(SOF0/SOF1)，渐进式/算术编码返回false
+bool funny_jpeg_info(const uint8_t* src, size_t size, FunnyJpegInfo& info);
+
+// 按1/scale缩小后的尺寸(向上取整)，scale为1/2/4/8
+int funny_jpeg_scaled_size(int size, int scale);
+
+// 解码为BGR888，输出尺寸为funny_jpeg_scaled_size(width/height, scale)
+// 缩小在DCT域完成：1/2、1/4只做4x4、2x2反变换，1/8只取DC，不会先解出全分辨率图像
+// 色度按MCU内复制上采样；MJPG码流缺少DHT时使用标准Huffman表；RGB编码的JPEG按分量直接输出
+// 码流带复位标记时按复位段切分MCU行，parallel为true时分给TYWorkerPool::shared()并行解码
+// 数据截断或损坏时缺失部分输出为灰色，只有帧头无法解析时返回false
+bool funny_jpeg_decode(const uint8_t* src, size_t size, int scale,
+                       uint8_t* dst, int dst_stride, bool parallel = false);
+
+// 当前选用的反变换/颜色转换内核名称("sse2"/"neon"/"scalar")
+const char* funny_jpeg_kernel();
+
+#endif
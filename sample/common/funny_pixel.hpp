@@ -0,0 +1,113 @@
+#ifndef FUNNY_PIXEL_HPP_
+#define FUNNY_PIXEL_HPP_
+
+#include <stdint.h>
+
+#include "TYDefs.h"
+
+// 像素数据的存放方式
+enum class FunnyPixelPacking : uint8_t {
+    Unknown,
+    Plain,      // 每个分量按字节对齐连续存放(8/16位)
+    CsiPacked,  // MIPI CSI-2紧凑打包(RAW10每4像素5字节，RAW12每2像素3字节)，见funny_csi.hpp
+    Yuv422,     // YUYV/YVYU，每2像素4字节
+    Compressed  // JPEG/MJPG码流，大小由TY_IMAGE_DATA::size给出
+};
+
+// 像素格式特性，按SDK的TY_PIXEL_FORMAT_LIST取值索引
+struct FunnyPixelTraits {
+    uint32_t          format;
+    uint8_t           bits;          // 每像素平均占用的位数，压缩格式为解码后的位数
+    uint8_t           sample_bits;   // 每个分量的有效位数
+    uint8_t           channels;      // 解码后的通道数，Bayer为1
+    FunnyPixelPacking packing;
+    bool              bayer;
+    bool              rgb_order;     // 3通道时分量顺序为R,G,B
+    bool              is_signed;     // 分量为有符号数(XYZ48)
+    bool              little_endian; // 多字节分量的字节序
+};
+
+namespace funny_pixel_detail {
+
+constexpr FunnyPixelTraits make(uint32_t fmt, int bits, int sample_bits, int channels,
+                                FunnyPixelPacking packing, bool bayer = false,
+                                bool rgb_order = false, bool is_signed = false) {
+    return FunnyPixelTraits{ fmt, static_cast<uint8_t>(bits), static_cast<uint8_t>(sample_bits),
+                             static_cast<uint8_t>(channels), packing, bayer, rgb_order, is_signed, true };
+}
+
+// BAYER8GRBG等为BAYER8GB等的别名，只列一次
+constexpr FunnyPixelTraits kTable[] = {
+    make(TY_PIXEL_FORMAT_MONO,            8,  8,  1, FunnyPixelPacking::Plain),
+    make(TY_PIXEL_FORMAT_BAYER8GB,        8,  8,  1, FunnyPixelPacking::Plain, true),
+    make(TY_PIXEL_FORMAT_BAYER8BG,        8,  8,  1, FunnyPixelPacking::Plain, true),
+    make(TY_PIXEL_FORMAT_BAYER8GR,        8,  8,  1, FunnyPixelPacking::Plain, true),
+    make(TY_PIXEL_FORMAT_BAYER8RG,        8,  8,  1, FunnyPixelPacking::Plain, true),
+    make(TY_PIXEL_FORMAT_CSI_MONO10,      10, 10, 1, FunnyPixelPacking::CsiPacked),
+    make(TY_PIXEL_FORMAT_CSI_BAYER10GRBG, 10, 10, 1, FunnyPixelPacking::CsiPacked, true),
+    make(TY_PIXEL_FORMAT_CSI_BAYER10RGGB, 10, 10, 1, FunnyPixelPacking::CsiPacked, true),
+    make(TY_PIXEL_FORMAT_CSI_BAYER10GBRG, 10, 10, 1, FunnyPixelPacking::CsiPacked, true),
+    make(TY_PIXEL_FORMAT_CSI_BAYER10BGGR, 10, 10, 1, FunnyPixelPacking::CsiPacked, true),
+    make(TY_PIXEL_FORMAT_CSI_MONO12,      12, 12, 1, FunnyPixelPacking::CsiPacked),
+    make(TY_PIXEL_FORMAT_CSI_BAYER12GRBG, 12, 12, 1, FunnyPixelPacking::CsiPacked, true),
+    make(TY_PIXEL_FORMAT_CSI_BAYER12RGGB, 12, 12, 1, FunnyPixelPacking::CsiPacked, true),
+    make(TY_PIXEL_FORMAT_CSI_BAYER12GBRG, 12, 12, 1, FunnyPixelPacking::CsiPacked, true),
+    make(TY_PIXEL_FORMAT_CSI_BAYER12BGGR, 12, 12, 1, FunnyPixelPacking::CsiPacked, true),
+    make(TY_PIXEL_FORMAT_DEPTH16,         16, 16, 1, FunnyPixelPacking::Plain),
+    make(TY_PIXEL_FORMAT_YVYU,            16, 8,  3, FunnyPixelPacking::Yuv422),
+    make(TY_PIXEL_FORMAT_YUYV,            16, 8,  3, FunnyPixelPacking::Yuv422),
+    make(TY_PIXEL_FORMAT_MONO16,          16, 16, 1, FunnyPixelPacking::Plain),
+    // 格式值中的位宽字段为64位，实际数据为16位单通道
+    make(TY_PIXEL_FORMAT_TOF_IR_MONO16,   16, 16, 1, FunnyPixelPacking::Plain),
+    make(TY_PIXEL_FORMAT_RGB,             24, 8,  3, FunnyPixelPacking::Plain, false, true),
+    make(TY_PIXEL_FORMAT_BGR,             24, 8,  3, FunnyPixelPacking::Plain),
+    make(TY_PIXEL_FORMAT_JPEG,            24, 8,  3, FunnyPixelPacking::Compressed),
+    make(TY_PIXEL_FORMAT_MJPG,            24, 8,  3, FunnyPixelPacking::Compressed),
+    make(TY_PIXEL_FORMAT_RGB48,           48, 16, 3, FunnyPixelPacking::Plain, false, true),
+    make(TY_PIXEL_FORMAT_BGR48,           48, 16, 3, FunnyPixelPacking::Plain),
+    make(TY_PIXEL_FORMAT_XYZ48,           48, 16, 3, FunnyPixelPacking::Plain, false, false, true),
+};
+
+constexpr int kCount = sizeof(kTable) / sizeof(kTable[0]);
+constexpr FunnyPixelTraits kUnknown = { TY_PIXEL_FORMAT_UNDEFINED, 0, 0, 0, FunnyPixelPacking::Unknown,
+                                        false, false, false, true };
+
+constexpr const FunnyPixelTraits& find(uint32_t fmt, int i) {
+    return i >= kCount ? kUnknown : (kTable[i].format == fmt ? kTable[i] : find(fmt, i + 1));
+}
+
+} // namespace funny_pixel_detail
+
+// 按像素格式取特性，未知格式返回packing为Unknown的项；可在编译期求值
+constexpr const FunnyPixelTraits& funny_pixel_traits(uint32_t pixel_format) {
+    return funny_pixel_detail::find(pixel_format, 0);
+}
+
+constexpr bool funny_pixel_known(uint32_t pixel_format) {
+    return funny_pixel_traits(pixel_format).packing != FunnyPixelPacking::Unknown;
+}
+
+// 一行数据的字节数，压缩格式和未知格式返回0
+constexpr int funny_pixel_row_bytes(uint32_t pixel_format, int width) {
+    return funny_pixel_traits(pixel_format).packing == FunnyPixelPacking::CsiPacked
+               ? (funny_pixel_traits(pixel_format).bits == 10 ? (width + 3) / 4 * 5 : (width + 1) / 2 * 3)
+           : funny_pixel_traits(pixel_format).packing == FunnyPixelPacking::Plain ||
+             funny_pixel_traits(pixel_format).packing == FunnyPixelPacking::Yuv422
+               ? width * funny_pixel_traits(pixel_format).bits / 8
+               : 0;
+}
+
+// 编译期特性，格式不在表中时编译失败
+template<uint32_t Fmt>
+struct FunnyPixelFormat {
+    static_assert(funny_pixel_known(Fmt), "unknown TY_PIXEL_FORMAT");
+    static constexpr uint32_t format = Fmt;
+    static constexpr int bits = funny_pixel_traits(Fmt).bits;
+    static constexpr int sample_bits = funny_pixel_traits(Fmt).sample_bits;
+    static constexpr int channels = funny_pixel_traits(Fmt).channels;
+    static constexpr FunnyPixelPacking packing = funny_pixel_traits(Fmt).packing;
+    static constexpr bool bayer = funny_pixel_traits(Fmt).bayer;
+    static constexpr bool rgb_order = funny_pixel_traits(Fmt).rgb_order;
+};
+
+#endif
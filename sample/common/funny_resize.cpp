@@ -1,136 +1,574 @@
 #include "funny_resize.hpp"
+#include "TYWorkerPool.hpp"
+
 #include <algorithm>
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
 
-static void resize_nearest_neighbor(
-    int src_width, int src_height, const uint8_t* src_data, int src_channels,
-    int dst_width, int dst_height, uint8_t* dst_data
-) {
-    float x_ratio = static_cast<float>(src_width) / dst_width;
-    float y_ratio = static_cast<float>(src_height) / dst_height;
-    
-    for (int y = 0; y < dst_height; y++) {
-        for (int x = 0; x < dst_width; x++) {
-            int src_x = static_cast<int>(x * x_ratio + 0.5f);
-            int src_y = static_cast<int>(y * y_ratio + 0.5f);
-            
-            src_x = std::min(src_width - 1, std::max(0, src_x));
-            src_y = std::min(src_height - 1, std::max(0, src_y));
-            
-            const uint8_t* src_pixel = src_data + (src_y * src_width + src_x) * src_channels;
-            uint8_t* dst_pixel = dst_data + (y * dst_width + x) * src_channels;
-            
-            for (int c = 0; c < src_channels; c++) {
-                dst_pixel[c] = src_pixel[c];
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FUNNY_RESIZE_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define FUNNY_RESIZE_NEON 1
+#include <arm_neon.h>
+#endif
+
+// 源坐标按像素中心对齐：sx = (dx + 0.5) * src / dst - 0.5，与cv::resize一致
+// 8位数据权重为Q7，横向结果(不超过255 * 128)存int16，纵向用16位乘加；
+// 16位数据(深度等)对精度更敏感，权重为Q15，横向结果存uint32，纵向用64位累加
+static const int kBits8  = 7;
+static const int kBits16 = 15;
+
+// 一个方向的采样表
+struct ResizeAxis {
+    std::vector<int>      i0;        // 两个相邻源坐标，边界处两者相同
+    std::vector<int>      i1;
+    std::vector<int16_t>  w7;        // i1的权重(Q7)，i0的权重为128 - w7
+    std::vector<uint16_t> w15;       // i1的权重(Q15)
+    std::vector<int>      nearest;   // 最近邻源坐标
+};
+
+// 区域平均的一个方向：目标坐标d覆盖源坐标idx[ofs[d]] ~ idx[ofs[d + 1] - 1]，
+// 权重为覆盖长度所占比例(Q15)，每个目标坐标的权重和恰为2^15
+struct AreaAxis {
+    std::vector<int>      ofs;
+    std::vector<int>      idx;
+    std::vector<uint32_t> w;
+};
+
+struct ResizePlan {
+    int        src_w, src_h, dst_w, dst_h;
+    ResizeAxis x, y;
+    AreaAxis   ax, ay;   // 只在两个方向都不放大时生成
+};
+
+static void buildAxis(ResizeAxis& a, int src, int dst)
+{
+    a.i0.resize(dst);
+    a.i1.resize(dst);
+    a.w7.resize(dst);
+    a.w15.resize(dst);
+    a.nearest.resize(dst);
+    const double scale = static_cast<double>(src) / dst;
+    for (int d = 0; d < dst; d++) {
+        double s = (d + 0.5) * scale - 0.5;
+        a.nearest[d] = std::min(src - 1, static_cast<int>((d + 0.5) * scale));
+        s = std::max(s, 0.0);
+        int i = static_cast<int>(s);
+        double f = s - i;
+        if (i >= src - 1) {
+            i = src - 1;
+            f = 0;
+        }
+        a.i0[d] = i;
+        a.i1[d] = std::min(i + 1, src - 1);
+        a.w7[d] = static_cast<int16_t>(std::lround(f * (1 << kBits8)));
+        a.w15[d] = static_cast<uint16_t>(std::lround(f * (1 << kBits16)));
+    }
+}
+
+static void buildArea(AreaAxis& a, int src, int dst)
+{
+    const double scale = static_cast<double>(src) / dst;
+    const uint32_t one = 1u << kBits16;
+    a.ofs.resize(dst + 1);
+    a.idx.clear();
+    a.w.clear();
+    for (int d = 0; d < dst; d++) {
+        const double f0 = d * scale;
+        const double f1 = (d + 1) * scale;
+        const int first = static_cast<int>(a.idx.size());
+        a.ofs[d] = first;
+        uint32_t total = 0;
+        int largest = first;
+        for (int i = static_cast<int>(f0); i < src && i < f1; i++) {
+            double overlap = std::min(f1, i + 1.0) - std::max(f0, static_cast<double>(i));
+            uint32_t w = static_cast<uint32_t>(std::lround(overlap / scale * one));
+            if (w == 0) {
+                continue;
+            }
+            a.idx.push_back(i);
+            a.w.push_back(w);
+            total += w;
+            if (w > a.w[largest]) {
+                largest = static_cast<int>(a.w.size()) - 1;
             }
         }
+        // 舍入误差补到权重最大的一项上，保证均匀区域输出不变
+        a.w[largest] += one - total;
     }
+    a.ofs[dst] = static_cast<int>(a.idx.size());
 }
 
-static void resize_bilinear(
-    int src_width, int src_height, const uint8_t* src_data, int src_channels,
-    int dst_width, int dst_height, uint8_t* dst_data
-) {
-    float x_ratio = static_cast<float>(src_width - 1) / dst_width;
-    float y_ratio = static_cast<float>(src_height - 1) / dst_height;
-    
-    for (int y = 0; y < dst_height; y++) {
-        for (int x = 0; x < dst_width; x++) {
-            float src_x = x * x_ratio;
-            float src_y = y * y_ratio;
-            
-            int x0 = static_cast<int>(src_x);
-            int y0 = static_cast<int>(src_y);
-            int x1 = std::min(src_width - 1, x0 + 1);
-            int y1 = std::min(src_height - 1, y0 + 1);
-            
-            float fx = src_x - x0;
-            float fy = src_y - y0;
-            float fx1 = 1.0f - fx;
-            float fy1 = 1.0f - fy;
-            
-            uint8_t* dst_pixel = dst_data + (y * dst_width + x) * src_channels;
-            
-            for (int c = 0; c < src_channels; c++) {
-                const uint8_t* p00 = src_data + (y0 * src_width + x0) * src_channels + c;
-                const uint8_t* p01 = src_data + (y0 * src_width + x1) * src_channels + c;
-                const uint8_t* p10 = src_data + (y1 * src_width + x0) * src_channels + c;
-                const uint8_t* p11 = src_data + (y1 * src_width + x1) * src_channels + c;
-                
-                float val = (*p00) * fx1 * fy1 + (*p01) * fx * fy1 + (*p10) * fx1 * fy + (*p11) * fx * fy;
-                dst_pixel[c] = static_cast<uint8_t>(std::min(255.0f, std::max(0.0f, val)));
+// 采样表按(源尺寸, 目标尺寸)缓存，与通道数和数据类型无关；每帧尺寸不变时只查表不重算
+static std::shared_ptr<const ResizePlan> acquirePlan(int src_w, int src_h, int dst_w, int dst_h)
+{
+    static const size_t kCapacity = 8;
+    static std::mutex lock;
+    static std::vector<std::shared_ptr<const ResizePlan> > cache;
+
+    std::lock_guard<std::mutex> guard(lock);
+    for (size_t i = 0; i < cache.size(); i++) {
+        const ResizePlan& p = *cache[i];
+        if (p.src_w == src_w && p.src_h == src_h && p.dst_w == dst_w && p.dst_h == dst_h) {
+            std::shared_ptr<const ResizePlan> hit = cache[i];
+            cache.erase(cache.begin() + i);
+            cache.insert(cache.begin(), hit);
+            return hit;
+        }
+    }
+    std::shared_ptr<ResizePlan> plan = std::make_shared<ResizePlan>();
+    plan->src_w = src_w;
+    plan->src_h = src_h;
+    plan->dst_w = dst_w;
+    plan->dst_h = dst_h;
+    buildAxis(plan->x, src_w, dst_w);
+    buildAxis(plan->y, src_h, dst_h);
+    if (dst_w <= src_w && dst_h <= src_h) {
+        buildArea(plan->ax, src_w, dst_w);
+        buildArea(plan->ay, src_h, dst_h);
+    }
+    if (cache.size() >= kCapacity) {
+        cache.pop_back();
+    }
+    cache.insert(cache.begin(), plan);
+    return plan;
+}
+
+// 按目标行带并行；每个行带各自缓存横向结果
+static void forBands(int rows, bool parallel, const std::function<void(int, int)>& fn)
+{
+    if (!parallel) {
+        fn(0, rows);
+        return;
+    }
+    TYWorkerPool& pool = TYWorkerPool::shared();
+    int bands = static_cast<int>(pool.size() + 1) * 4;
+    int grain = std::max(8, (rows + bands - 1) / bands);
+    pool.parallel_for(0, rows, grain, fn);
+}
+
+template <typename T>
+static void nearestRows(const ResizePlan& p, const T* src, int cn, T* dst, int y0, int y1)
+{
+    const int* nx = &p.x.nearest[0];
+    for (int dy = y0; dy < y1; dy++) {
+        const T* s = src + static_cast<size_t>(p.y.nearest[dy]) * p.src_w * cn;
+        T* d = dst + static_cast<size_t>(dy) * p.dst_w * cn;
+        if (cn == 1) {
+            for (int dx = 0; dx < p.dst_w; dx++) {
+                d[dx] = s[nx[dx]];
+            }
+        } else {
+            for (int dx = 0; dx < p.dst_w; dx++, d += cn) {
+                const T* q = s + nx[dx] * cn;
+                for (int c = 0; c < cn; c++) {
+                    d[c] = q[c];
+                }
             }
         }
     }
 }
 
-void funny_resize(
-    int src_width, int src_height, const uint8_t* src_data, int src_channels,
-    int dst_width, int dst_height, uint8_t* dst_data, 
-    InterpolationMethod interpolation
-) {
-    if (!src_data || !dst_data || src_width <= 0 || src_height <= 0 || 
-        dst_width <= 0 || dst_height <= 0 || src_channels <= 0) {
+// 横向：按通道数展开，源坐标和权重都来自采样表
+template <int CN, typename T, typename Acc, typename W>
+static void hpassCN(const T* s, Acc* h, const ResizeAxis& ax, const W* w, int one, int dst_w)
+{
+    for (int dx = 0; dx < dst_w; dx++, h += CN) {
+        const T* a = s + ax.i0[dx] * CN;
+        const T* b = s + ax.i1[dx] * CN;
+        const int wb = w[dx];
+        const int wa = one - wb;
+        for (int c = 0; c < CN; c++) {
+            h[c] = static_cast<Acc>(a[c] * wa + b[c] * wb);
+        }
+    }
+}
+
+template <typename T, typename Acc, typename W>
+static void hpass(const T* s, Acc* h, const ResizeAxis& ax, const W* w, int one, int dst_w, int cn)
+{
+    switch (cn) {
+    case 1: hpassCN<1>(s, h, ax, w, one, dst_w); break;
+    case 2: hpassCN<2>(s, h, ax, w, one, dst_w); break;
+    case 3: hpassCN<3>(s, h, ax, w, one, dst_w); break;
+    case 4: hpassCN<4>(s, h, ax, w, one, dst_w); break;
+    default:
+        for (int dx = 0; dx < dst_w; dx++, h += cn) {
+            const T* a = s + ax.i0[dx] * cn;
+            const T* b = s + ax.i1[dx] * cn;
+            const int wb = w[dx];
+            for (int c = 0; c < cn; c++) {
+                h[c] = static_cast<Acc>(a[c] * (one - wb) + b[c] * wb);
+            }
+        }
+        break;
+    }
+}
+
+// 纵向(8位)：d = (h0 * (128 - w) + h1 * w + 2^13) >> 14
+static void vpass8(const int16_t* h0, const int16_t* h1, uint8_t* d, int n, int w)
+{
+    const int w0 = (1 << kBits8) - w;
+    const int shift = kBits8 * 2;
+    int i = 0;
+#if defined(FUNNY_RESIZE_SSE2)
+    const __m128i wp = _mm_set1_epi32((w << 16) | w0);
+    const __m128i round = _mm_set1_epi32(1 << (shift - 1));
+    for (; i + 8 <= n; i += 8) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(h0 + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(h1 + i));
+        __m128i lo = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(a, b), wp), round), shift);
+        __m128i hi = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(a, b), wp), round), shift);
+        __m128i v = _mm_packs_epi32(lo, hi);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(d + i), _mm_packus_epi16(v, v));
+    }
+#elif defined(FUNNY_RESIZE_NEON)
+    for (; i + 8 <= n; i += 8) {
+        int16x8_t a = vld1q_s16(h0 + i);
+        int16x8_t b = vld1q_s16(h1 + i);
+        int32x4_t lo = vmlal_n_s16(vmull_n_s16(vget_low_s16(a), w0), vget_low_s16(b), w);
+        int32x4_t hi = vmlal_n_s16(vmull_n_s16(vget_high_s16(a), w0), vget_high_s16(b), w);
+        int16x8_t v = vcombine_s16(vrshrn_n_s32(lo, 14), vrshrn_n_s32(hi, 14));
+        vst1_u8(d + i, vqmovun_s16(v));
+    }
+#endif
+    for (; i < n; i++) {
+        d[i] = static_cast<uint8_t>((h0[i] * w0 + h1[i] * w + (1 << (shift - 1))) >> shift);
+    }
+}
+
+// 纵向(16位)：d = (h0 * (2^15 - w) + h1 * w + 2^29) >> 30
+static void vpass16(const uint32_t* h0, const uint32_t* h1, uint16_t* d, int n, int w)
+{
+    const uint64_t w0 = (1u << kBits16) - w;
+    const uint64_t wb = static_cast<uint64_t>(w);
+    const int shift = kBits16 * 2;
+    int i = 0;
+#if defined(FUNNY_RESIZE_SSE2)
+    // _mm_mul_epu32只乘偶数32位通道，奇偶通道分两次算出64位结果
+    const __m128i vw0 = _mm_set1_epi32(static_cast<int>(w0));
+    const __m128i vw1 = _mm_set1_epi32(w);
+    const __m128i round = _mm_set1_epi64x(1ll << (shift - 1));
+    const __m128i bias32 = _mm_set1_epi32(0x8000);
+    const __m128i bias16 = _mm_set1_epi16(-0x8000);
+    for (; i + 8 <= n; i += 8) {
+        __m128i v[2];
+        for (int k = 0; k < 2; k++) {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(h0 + i + k * 4));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(h1 + i + k * 4));
+            __m128i even = _mm_add_epi64(_mm_add_epi64(_mm_mul_epu32(a, vw0), _mm_mul_epu32(b, vw1)), round);
+            __m128i odd = _mm_add_epi64(_mm_add_epi64(_mm_mul_epu32(_mm_srli_epi64(a, 32), vw0),
+                                                      _mm_mul_epu32(_mm_srli_epi64(b, 32), vw1)), round);
+            // 结果不超过16位，偶数通道留在低32位，奇数通道移到高32位
+            v[k] = _mm_or_si128(_mm_srli_epi64(even, shift), _mm_slli_epi64(_mm_srli_epi64(odd, shift), 32));
+            // SSE2没有无符号32位到16位的饱和打包，先减0x8000按有符号打包再加回
+            v[k] = _mm_sub_epi32(v[k], bias32);
+        }
+        __m128i packed = _mm_add_epi16(_mm_packs_epi32(v[0], v[1]), bias16);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(d + i), packed);
+    }
+#elif defined(FUNNY_RESIZE_NEON)
+    const uint32x2_t vw0 = vdup_n_u32(static_cast<uint32_t>(w0));
+    const uint32x2_t vw1 = vdup_n_u32(static_cast<uint32_t>(w));
+    for (; i + 4 <= n; i += 4) {
+        uint32x4_t a = vld1q_u32(h0 + i);
+        uint32x4_t b = vld1q_u32(h1 + i);
+        uint64x2_t lo = vmlal_u32(vmull_u32(vget_low_u32(a), vw0), vget_low_u32(b), vw1);
+        uint64x2_t hi = vmlal_u32(vmull_u32(vget_high_u32(a), vw0), vget_high_u32(b), vw1);
+        uint32x4_t v = vcombine_u32(vrshrn_n_u64(lo, 30), vrshrn_n_u64(hi, 30));
+        vst1_u16(d + i, vmovn_u32(v));
+    }
+#endif
+    for (; i < n; i++) {
+        d[i] = static_cast<uint16_t>((h0[i] * w0 + h1[i] * wb + (1ull << (shift - 1))) >> shift);
+    }
+}
+
+// 先横向后纵向；相邻目标行共用的源行只做一次横向插值
+template <typename T, typename Acc>
+static void linearRows(const ResizePlan& p, const T* src, int cn, T* dst, int y0, int y1)
+{
+    const int n = p.dst_w * cn;
+    std::vector<Acc> buf(static_cast<size_t>(n) * 2);
+    Acc* rows[2] = { &buf[0], &buf[n] };
+    int ids[2] = { -1, -1 };
+
+    for (int dy = y0; dy < y1; dy++) {
+        const int need[2] = { p.y.i0[dy], p.y.i1[dy] };
+        if (ids[0] != need[0] && ids[1] == need[0]) {
+            std::swap(rows[0], rows[1]);
+            std::swap(ids[0], ids[1]);
+        }
+        for (int k = 0; k < 2; k++) {
+            if (ids[k] == need[k]) {
+                continue;
+            }
+            const T* s = src + static_cast<size_t>(need[k]) * p.src_w * cn;
+            if (sizeof(T) == 1) {
+                hpass(s, rows[k], p.x, &p.x.w7[0], 1 << kBits8, p.dst_w, cn);
+            } else {
+                hpass(s, rows[k], p.x, &p.x.w15[0], 1 << kBits16, p.dst_w, cn);
+            }
+            ids[k] = need[k];
+        }
+        T* d = dst + static_cast<size_t>(dy) * n;
+        if (sizeof(T) == 1) {
+            vpass8(reinterpret_cast<const int16_t*>(rows[0]), reinterpret_cast<const int16_t*>(rows[1]),
+                   reinterpret_cast<uint8_t*>(d), n, p.y.w7[dy]);
+        } else {
+            vpass16(reinterpret_cast<const uint32_t*>(rows[0]), reinterpret_cast<const uint32_t*>(rows[1]),
+                    reinterpret_cast<uint16_t*>(d), n, p.y.w15[dy]);
+        }
+    }
+}
+
+// 区域平均的横向一遍：覆盖的源像素按Q15权重求和，结果为Q15定点
+template <int CN, typename T>
+static void areaRowCN(const T* s, uint32_t* h, const AreaAxis& ax, int dst_w)
+{
+    for (int dx = 0; dx < dst_w; dx++, h += CN) {
+        uint32_t sum[CN] = {};
+        for (int j = ax.ofs[dx]; j < ax.ofs[dx + 1]; j++) {
+            const T* p = s + ax.idx[j] * CN;
+            const uint32_t w = ax.w[j];
+            for (int c = 0; c < CN; c++) {
+                sum[c] += p[c] * w;
+            }
+        }
+        for (int c = 0; c < CN; c++) {
+            h[c] = sum[c];
+        }
+    }
+}
+
+template <typename T>
+static void areaRow(const T* s, uint32_t* h, const AreaAxis& ax, int dst_w, int cn)
+{
+    switch (cn) {
+    case 1: areaRowCN<1>(s, h, ax, dst_w); break;
+    case 2: areaRowCN<2>(s, h, ax, dst_w); break;
+    case 3: areaRowCN<3>(s, h, ax, dst_w); break;
+    case 4: areaRowCN<4>(s, h, ax, dst_w); break;
+    default:
+        for (int dx = 0; dx < dst_w; dx++) {
+            for (int c = 0; c < cn; c++) {
+                uint32_t sum = 0;
+                for (int j = ax.ofs[dx]; j < ax.ofs[dx + 1]; j++) {
+                    sum += s[ax.idx[j] * cn + c] * ax.w[j];
+                }
+                h[dx * cn + c] = sum;
+            }
+        }
+        break;
+    }
+}
+
+// 区域平均：每个目标行按覆盖的源行加权累加横向结果
+template <typename T>
+static void areaRows(const ResizePlan& p, const T* src, int cn, T* dst, int y0, int y1)
+{
+    const int n = p.dst_w * cn;
+    const int shift = kBits16 * 2;
+    std::vector<uint32_t> h(n);
+    std::vector<uint64_t> acc(n);
+    const AreaAxis& ax = p.ax;
+
+    for (int dy = y0; dy < y1; dy++) {
+        std::fill(acc.begin(), acc.end(), 0);
+        for (int k = p.ay.ofs[dy]; k < p.ay.ofs[dy + 1]; k++) {
+            areaRow(src + static_cast<size_t>(p.ay.idx[k]) * p.src_w * cn, &h[0], ax, p.dst_w, cn);
+            const uint64_t wy = p.ay.w[k];
+            for (int i = 0; i < n; i++) {
+                acc[i] += h[i] * wy;
+            }
+        }
+        T* d = dst + static_cast<size_t>(dy) * n;
+        for (int i = 0; i < n; i++) {
+            d[i] = static_cast<T>((acc[i] + (1ull << (shift - 1))) >> shift);
+        }
+    }
+}
+
+template <typename T, typename Acc>
+static void resizeImpl(int src_width, int src_height, const T* src_data, int channels,
+                       int dst_width, int dst_height, T* dst_data,
+                       InterpolationMethod interpolation, bool parallel)
+{
+    if (!src_data || !dst_data || src_width <= 0 || src_height <= 0 ||
+        dst_width <= 0 || dst_height <= 0 || channels <= 0) {
         return;
     }
-    
+    if (interpolation == InterpolationMethod::AREA) {
+        if (dst_width > src_width || dst_height > src_height) {
+            // 放大时区域平均没有意义，与cv::resize一样退化为双线性
+            interpolation = InterpolationMethod::LINEAR;
+        } else if (sizeof(T) == 1 && channels <= 4) {
+            for (int k = 2; k <= 4; k += 2) {
+                if (src_width == dst_width * k && src_height == dst_height * k) {
+                    funny_downscale_box(reinterpret_cast<const uint8_t*>(src_data), 0, channels,
+                                        reinterpret_cast<uint8_t*>(dst_data), 0,
+                                        src_width, src_height, k, false, parallel);
+                    return;
+                }
+            }
+        }
+    }
+
+    std::shared_ptr<const ResizePlan> plan = acquirePlan(src_width, src_height, dst_width, dst_height);
+    const ResizePlan& p = *plan;
     if (interpolation == InterpolationMethod::NEAREST) {
-        resize_nearest_neighbor(src_width, src_height, src_data, src_channels, 
-                               dst_width, dst_height, dst_data);
+        forBands(dst_height, parallel, [&](int y0, int y1) {
+            nearestRows(p, src_data, channels, dst_data, y0, y1);
+        });
+    } else if (interpolation == InterpolationMethod::AREA) {
+        forBands(dst_height, parallel, [&](int y0, int y1) {
+            areaRows(p, src_data, channels, dst_data, y0, y1);
+        });
     } else {
-        resize_bilinear(src_width, src_height, src_data, src_channels, 
-                       dst_width, dst_height, dst_data);
+        forBands(dst_height, parallel, [&](int y0, int y1) {
+            linearRows<T, Acc>(p, src_data, channels, dst_data, y0, y1);
+        });
     }
 }
 
+void funny_resize(
+    int src_width, int src_height, const uint8_t* src_data, int src_channels,
+    int dst_width, int dst_height, uint8_t* dst_data,
+    InterpolationMethod interpolation, bool parallel
+) {
+    resizeImpl<uint8_t, int16_t>(src_width, src_height, src_data, src_channels,
+                                 dst_width, dst_height, dst_data, interpolation, parallel);
+}
+
 void funny_resize_16bit(
     int src_width, int src_height, const uint16_t* src_data,
-    int dst_width, int dst_height, uint16_t* dst_data, 
-    InterpolationMethod interpolation
+    int dst_width, int dst_height, uint16_t* dst_data,
+    InterpolationMethod interpolation, bool parallel
 ) {
-    if (!src_data || !dst_data || src_width <= 0 || src_height <= 0 || 
-        dst_width <= 0 || dst_height <= 0) {
-        return;
+    resizeImpl<uint16_t, uint32_t>(src_width, src_height, src_data, 1,
+                                   dst_width, dst_height, dst_data, interpolation, parallel);
+}
+
+void funny_resize_16bit(
+    int src_width, int src_height, const uint16_t* src_data, int src_channels,
+    int dst_width, int dst_height, uint16_t* dst_data,
+    InterpolationMethod interpolation, bool parallel
+) {
+    resizeImpl<uint16_t, uint32_t>(src_width, src_height, src_data, src_channels,
+                                   dst_width, dst_height, dst_data, interpolation, parallel);
+}
+
+// 把rows行的同一段字节纵向累加为16位
+static void sumRows(const uint8_t* src, int stride, int rows, uint16_t* acc, int n)
+{
+    int i = 0;
+#if defined(FUNNY_RESIZE_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= n; i += 16) {
+        __m128i lo = zero, hi = zero;
+        for (int r = 0; r < rows; r++) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + static_cast<size_t>(r) * stride + i));
+            lo = _mm_add_epi16(lo, _mm_unpacklo_epi8(v, zero));
+            hi = _mm_add_epi16(hi, _mm_unpackhi_epi8(v, zero));
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(acc + i), lo);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(acc + i + 8), hi);
     }
-    
-    float x_ratio = static_cast<float>(src_width - 1) / dst_width;
-    float y_ratio = static_cast<float>(src_height - 1) / dst_height;
-    
-    if (interpolation == InterpolationMethod::NEAREST) {
-        for (int y = 0; y < dst_height; y++) {
-            for (int x = 0; x < dst_width; x++) {
-                int src_x = static_cast<int>(x * x_ratio + 0.5f);
-                int src_y = static_cast<int>(y * y_ratio + 0.5f);
-                
-                src_x = std::min(src_width - 1, std::max(0, src_x));
-                src_y = std::min(src_height - 1, std::max(0, src_y));
-                
-                dst_data[y * dst_width + x] = src_data[src_y * src_width + src_x];
-            }
+#elif defined(FUNNY_RESIZE_NEON)
+    for (; i + 16 <= n; i += 16) {
+        uint16x8_t lo = vdupq_n_u16(0), hi = vdupq_n_u16(0);
+        for (int r = 0; r < rows; r++) {
+            uint8x16_t v = vld1q_u8(src + static_cast<size_t>(r) * stride + i);
+            lo = vaddw_u8(lo, vget_low_u8(v));
+            hi = vaddw_u8(hi, vget_high_u8(v));
         }
-    } else {
-        for (int y = 0; y < dst_height; y++) {
-            for (int x = 0; x < dst_width; x++) {
-                float src_x = x * x_ratio;
-                float src_y = y * y_ratio;
-                
-                int x0 = static_cast<int>(src_x);
-                int y0 = static_cast<int>(src_y);
-                int x1 = std::min(src_width - 1, x0 + 1);
-                int y1 = std::min(src_height - 1, y0 + 1);
-                
-                float fx = src_x - x0;
-                float fy = src_y - y0;
-                float fx1 = 1.0f - fx;
-                float fy1 = 1.0f - fy;
-                
-                uint16_t p00 = src_data[y0 * src_width + x0];
-                uint16_t p01 = src_data[y0 * src_width + x1];
-                uint16_t p10 = src_data[y1 * src_width + x0];
-                uint16_t p11 = src_data[y1 * src_width + x1];
-                
-                float val = p00 * fx1 * fy1 + p01 * fx * fy1 + p10 * fx1 * fy + p11 * fx * fy;
-                dst_data[y * dst_width + x] = static_cast<uint16_t>(val);
+        vst1q_u16(acc + i, lo);
+        vst1q_u16(acc + i + 8, hi);
+    }
+#endif
+    for (; i < n; i++) {
+        uint16_t sum = 0;
+        for (int r = 0; r < rows; r++) {
+            sum = static_cast<uint16_t>(sum + src[static_cast<size_t>(r) * stride + i]);
+        }
+        acc[i] = sum;
+    }
+}
+
+// 横向把S个像素的纵向和相加，块内像素数为2的幂，平均值用移位舍入
+template <int CN, int S>
+static void boxRow(const uint16_t* acc, uint8_t* d, int out_w, bool swap)
+{
+    const int shift = (S == 1) ? 0 : (S == 2 ? 2 : 4);
+    const int round = (1 << shift) >> 1;
+    for (int ox = 0; ox < out_w; ox++, acc += S * CN, d += CN) {
+        int sum[CN];
+        for (int c = 0; c < CN; c++) {
+            sum[c] = acc[c];
+        }
+        for (int k = 1; k < S; k++) {
+            for (int c = 0; c < CN; c++) {
+                sum[c] += acc[k * CN + c];
             }
         }
+        for (int c = 0; c < CN; c++) {
+            d[c] = static_cast<uint8_t>((sum[c] + round) >> shift);
+        }
+        if (CN >= 3 && swap) {
+            std::swap(d[0], d[2]);
+        }
+    }
+}
+
+template <int S>
+static void boxRowCN(const uint16_t* acc, uint8_t* d, int out_w, int channels, bool swap)
+{
+    switch (channels) {
+    case 1: boxRow<1, S>(acc, d, out_w, false); break;
+    case 2: boxRow<2, S>(acc, d, out_w, false); break;
+    case 3: boxRow<3, S>(acc, d, out_w, swap); break;
+    default: boxRow<4, S>(acc, d, out_w, swap); break;
+    }
+}
+
+void funny_downscale_box(
+    const uint8_t* src, int src_stride, int channels,
+    uint8_t* dst, int dst_stride,
+    int width, int height, int scale,
+    bool swap_rb, bool parallel
+) {
+    if (!src || !dst || channels <= 0 || channels > 4 || (scale != 1 && scale != 2 && scale != 4)) {
+        return;
     }
-}
\ No newline at end of file
+    const int out_w = width / scale;
+    const int out_h = height / scale;
+    if (out_w <= 0 || out_h <= 0) {
+        return;
+    }
+    if (src_stride == 0) {
+        src_stride = width * channels;
+    }
+    if (dst_stride == 0) {
+        dst_stride = out_w * channels;
+    }
+    const int n = out_w * scale * channels;
+
+    forBands(out_h, parallel, [&](int y0, int y1) {
+        std::vector<uint16_t> acc(n);
+        for (int oy = y0; oy < y1; oy++) {
+            sumRows(src + static_cast<size_t>(oy) * scale * src_stride, src_stride, scale, &acc[0], n);
+            uint8_t* d = dst + static_cast<size_t>(oy) * dst_stride;
+            if (scale == 1) {
+                boxRowCN<1>(&acc[0], d, out_w, channels, swap_rb);
+            } else if (scale == 2) {
+                boxRowCN<2>(&acc[0], d, out_w, channels, swap_rb);
+            } else {
+                boxRowCN<4>(&acc[0], d, out_w, channels, swap_rb);
+            }
+        }
+    });
+}
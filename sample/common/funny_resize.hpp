@@ -5,19 +5,44 @@
 
 enum class InterpolationMethod {
     NEAREST,
-    LINEAR
+    LINEAR,
+    AREA        // 区域平均，缩小时没有混叠；宽高都缩小2倍或4倍的8位图走funny_downscale_box，放大时同LINEAR
 };
 
+// 源坐标按像素中心对齐(与cv::resize一致)，按(源尺寸, 目标尺寸)缓存每行/每列的源坐标和定点权重，
+// 尺寸不变时每帧只查表；双线性为先横向后纵向的两遍定点插值，纵向一遍使用SSE2/NEON
+// parallel为true时按目标行带分给TYWorkerPool::shared()
 void funny_resize(
     int src_width, int src_height, const uint8_t* src_data, int src_channels,
     int dst_width, int dst_height, uint8_t* dst_data, 
-    InterpolationMethod interpolation = InterpolationMethod::LINEAR
+    InterpolationMethod interpolation = InterpolationMethod::LINEAR,
+    bool parallel = false
 );
 
 void funny_resize_16bit(
     int src_width, int src_height, const uint16_t* src_data,
     int dst_width, int dst_height, uint16_t* dst_data, 
-    InterpolationMethod interpolation = InterpolationMethod::NEAREST
+    InterpolationMethod interpolation = InterpolationMethod::NEAREST,
+    bool parallel = false
+);
+
+// 交错存放的多通道16位图像(如BGR48/RGB48)，与8位共用采样表和行带并行，不拆分通道
+// 插值方式须显式指定，避免与单通道版本的默认值混淆
+void funny_resize_16bit(
+    int src_width, int src_height, const uint16_t* src_data, int src_channels,
+    int dst_width, int dst_height, uint16_t* dst_data,
+    InterpolationMethod interpolation,
+    bool parallel = false
+);
+
+// 整数倍缩小：每个输出像素取scale x scale源像素块的平均(四舍五入)，输出(width / scale) x (height / scale)
+// scale为1/2/4，channels为1~4；swap_rb为true时同时交换第0和第2个分量(RGB转BGR)
+// src_stride/dst_stride为行字节数，为0时按紧凑行计算；纵向累加使用SSE2/NEON
+void funny_downscale_box(
+    const uint8_t* src, int src_stride, int channels,
+    uint8_t* dst, int dst_stride,
+    int width, int height, int scale,
+    bool swap_rb = false, bool parallel = false
 );
 
 #endif
\ No newline at end of file
@@ -0,0 +1,511 @@
+#include "funny_yuv.hpp"
+#include "TYWorkerPool.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FUNNY_YUV_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define FUNNY_YUV_NEON 1
+#include <arm_neon.h>
+#endif
+
+#if defined(FUNNY_YUV_X86) && (defined(__GNUC__) || defined(__clang__))
+#define FUNNY_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define FUNNY_TARGET_AVX2
+#endif
+
+// 色度系数：c0/c1为宏像素中第一个/第二个色度字节减128后的值
+// R = (298*(Y-16) + r0*c0 + r1*c1 + 128) >> 8，G、B同理
+struct YUVCoeffs {
+    int16_t r0, r1;
+    int16_t g0, g1;
+    int16_t b0, b1;
+};
+
+static const YUVCoeffs kYUYV = {0, 409, -100, -208, 516, 0};
+static const YUVCoeffs kYVYU = {409, 0, -208, -100, 0, 516};
+
+// 两个int16打包成一个32位值(lo在低位)，用于构造madd系数
+static inline int32_t pack16(int16_t lo, int16_t hi)
+{
+    return static_cast<int32_t>((static_cast<uint32_t>(static_cast<uint16_t>(hi)) << 16) | static_cast<uint16_t>(lo));
+}
+
+typedef void (*YUV422RowKernel)(const uint8_t* src, uint8_t* dst, int width, const YUVCoeffs& k);
+
+static inline uint8_t clamp8(int v)
+{
+    return static_cast<uint8_t>(v < 0 ? 0 : (v > 255 ? 255 : v));
+}
+
+static inline void storePixel(uint8_t* d, int yy, int rc, int gc, int bc)
+{
+    d[0] = clamp8((yy + bc) >> 8);
+    d[1] = clamp8((yy + gc) >> 8);
+    d[2] = clamp8((yy + rc) >> 8);
+}
+
+// 从第x个像素(偶数)开始处理到行尾
+static void rowScalar(const uint8_t* src, uint8_t* dst, int x, int width, const YUVCoeffs& k)
+{
+    const uint8_t* s = src + x * 2;
+    uint8_t* d = dst + x * 3;
+    for (; x + 1 < width; x += 2, s += 4, d += 6) {
+        int c0 = s[1] - 128;
+        int c1 = s[3] - 128;
+        int rc = k.r0 * c0 + k.r1 * c1;
+        int gc = k.g0 * c0 + k.g1 * c1;
+        int bc = k.b0 * c0 + k.b1 * c1;
+        storePixel(d,     298 * (s[0] - 16) + 128, rc, gc, bc);
+        storePixel(d + 3, 298 * (s[2] - 16) + 128, rc, gc, bc);
+    }
+    if (x < width) {
+        // 行末落单的像素，缺少的色度分量为128
+        int c0 = s[1] - 128;
+        storePixel(d, 298 * (s[0] - 16) + 128, k.r0 * c0, k.g0 * c0, k.b0 * c0);
+    }
+}
+
+#if !defined(FUNNY_YUV_X86) && !defined(FUNNY_YUV_NEON)
+static void rowKernelScalar(const uint8_t* src, uint8_t* dst, int width, const YUVCoeffs& k)
+{
+    rowScalar(src, dst, 0, width, k);
+}
+#endif
+
+#ifdef FUNNY_YUV_X86
+
+static void rowKernelSSE2(const uint8_t* src, uint8_t* dst, int width, const YUVCoeffs& k)
+{
+    const __m128i mask = _mm_set1_epi16(0x00FF);
+    const __m128i v16  = _mm_set1_epi16(16);
+    const __m128i v128 = _mm_set1_epi16(128);
+    const __m128i one  = _mm_set1_epi16(1);
+    const __m128i ky   = _mm_set1_epi32(pack16(298, 128));
+    const __m128i kr   = _mm_set1_epi32(pack16(k.r0, k.r1));
+    const __m128i kg   = _mm_set1_epi32(pack16(k.g0, k.g1));
+    const __m128i kb   = _mm_set1_epi32(pack16(k.b0, k.b1));
+    const __m128i zero = _mm_setzero_si128();
+
+    int x = 0;
+    // 每次8个像素；每个像素按4字节(BGR0)写出，后一个像素覆盖前一个的第4字节，
+    // 因此块后至少保留一个像素给标量部分，避免写出行尾
+    for (; x + 8 < width; x += 8) {
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x * 2));
+        __m128i y = _mm_sub_epi16(_mm_and_si128(s, mask), v16);
+        __m128i c = _mm_sub_epi16(_mm_srli_epi16(s, 8), v128);
+
+        __m128i ylo = _mm_madd_epi16(_mm_unpacklo_epi16(y, one), ky);
+        __m128i yhi = _mm_madd_epi16(_mm_unpackhi_epi16(y, one), ky);
+
+        __m128i rc = _mm_madd_epi16(c, kr);
+        __m128i gc = _mm_madd_epi16(c, kg);
+        __m128i bc = _mm_madd_epi16(c, kb);
+
+        __m128i r = _mm_packs_epi32(_mm_srai_epi32(_mm_add_epi32(ylo, _mm_unpacklo_epi32(rc, rc)), 8),
+                                    _mm_srai_epi32(_mm_add_epi32(yhi, _mm_unpackhi_epi32(rc, rc)), 8));
+        __m128i g = _mm_packs_epi32(_mm_srai_epi32(_mm_add_epi32(ylo, _mm_unpacklo_epi32(gc, gc)), 8),
+                                    _mm_srai_epi32(_mm_add_epi32(yhi, _mm_unpackhi_epi32(gc, gc)), 8));
+        __m128i b = _mm_packs_epi32(_mm_srai_epi32(_mm_add_epi32(ylo, _mm_unpacklo_epi32(bc, bc)), 8),
+                                    _mm_srai_epi32(_mm_add_epi32(yhi, _mm_unpackhi_epi32(bc, bc)), 8));
+
+        // packus同时完成0~255截断
+        __m128i bg = _mm_unpacklo_epi8(_mm_packus_epi16(b, b), _mm_packus_epi16(g, g));
+        __m128i r0 = _mm_unpacklo_epi8(_mm_packus_epi16(r, r), zero);
+        __m128i px[2] = { _mm_unpacklo_epi16(bg, r0), _mm_unpackhi_epi16(bg, r0) };
+
+        uint8_t* d = dst + x * 3;
+        for (int i = 0; i < 2; i++) {
+            for (int j = 0; j < 4; j++, d += 3) {
+                int32_t v = _mm_cvtsi128_si32(px[i]);
+                memcpy(d, &v, 4);
+                px[i] = _mm_srli_si128(px[i], 4);
+            }
+        }
+    }
+    rowScalar(src, dst, x, width, k);
+}
+
+FUNNY_TARGET_AVX2
+static void rowKernelAVX2(const uint8_t* src, uint8_t* dst, int width, const YUVCoeffs& k)
+{
+    const __m256i mask = _mm256_set1_epi16(0x00FF);
+    const __m256i v16  = _mm256_set1_epi16(16);
+    const __m256i v128 = _mm256_set1_epi16(128);
+    const __m256i one  = _mm256_set1_epi16(1);
+    const __m256i ky   = _mm256_set1_epi32(pack16(298, 128));
+    const __m256i kr   = _mm256_set1_epi32(pack16(k.r0, k.r1));
+    const __m256i kg   = _mm256_set1_epi32(pack16(k.g0, k.g1));
+    const __m256i kb   = _mm256_set1_epi32(pack16(k.b0, k.b1));
+    const __m256i zero = _mm256_setzero_si256();
+
+    // 每个128位通道内：BG寄存器为B0..B7 G0..G7，R寄存器为R0..R7，重排成24字节BGR
+    const __m256i bg_a = _mm256_setr_epi8(0, 8, -1, 1, 9, -1, 2, 10, -1, 3, 11, -1, 4, 12, -1, 5,
+                                          0, 8, -1, 1, 9, -1, 2, 10, -1, 3, 11, -1, 4, 12, -1, 5);
+    const __m256i r_a  = _mm256_setr_epi8(-1, -1, 0, -1, -1, 1, -1, -1, 2, -1, -1, 3, -1, -1, 4, -1,
+                                          -1, -1, 0, -1, -1, 1, -1, -1, 2, -1, -1, 3, -1, -1, 4, -1);
+    const __m256i bg_b = _mm256_setr_epi8(13, -1, 6, 14, -1, 7, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                          13, -1, 6, 14, -1, 7, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m256i r_b  = _mm256_setr_epi8(-1, 5, -1, -1, 6, -1, -1, 7, -1, -1, -1, -1, -1, -1, -1, -1,
+                                          -1, 5, -1, -1, 6, -1, -1, 7, -1, -1, -1, -1, -1, -1, -1, -1);
+
+    int x = 0;
+    // 每次16个像素，两个128位通道各8个
+    for (; x + 16 <= width; x += 16) {
+        __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + x * 2));
+        __m256i y = _mm256_sub_epi16(_mm256_and_si256(s, mask), v16);
+        __m256i c = _mm256_sub_epi16(_mm256_srli_epi16(s, 8), v128);
+
+        __m256i ylo = _mm256_madd_epi16(_mm256_unpacklo_epi16(y, one), ky);
+        __m256i yhi = _mm256_madd_epi16(_mm256_unpackhi_epi16(y, one), ky);
+
+        __m256i rc = _mm256_madd_epi16(c, kr);
+        __m256i gc = _mm256_madd_epi16(c, kg);
+        __m256i bc = _mm256_madd_epi16(c, kb);
+
+        __m256i r = _mm256_packs_epi32(_mm256_srai_epi32(_mm256_add_epi32(ylo, _mm256_unpacklo_epi32(rc, rc)), 8),
+                                       _mm256_srai_epi32(_mm256_add_epi32(yhi, _mm256_unpackhi_epi32(rc, rc)), 8));
+        __m256i g = _mm256_packs_epi32(_mm256_srai_epi32(_mm256_add_epi32(ylo, _mm256_unpacklo_epi32(gc, gc)), 8),
+                                       _mm256_srai_epi32(_mm256_add_epi32(yhi, _mm256_unpackhi_epi32(gc, gc)), 8));
+        __m256i b = _mm256_packs_epi32(_mm256_srai_epi32(_mm256_add_epi32(ylo, _mm256_unpacklo_epi32(bc, bc)), 8),
+                                       _mm256_srai_epi32(_mm256_add_epi32(yhi, _mm256_unpackhi_epi32(bc, bc)), 8));
+
+        __m256i bg = _mm256_packus_epi16(b, g);
+        __m256i r8 = _mm256_packus_epi16(r, zero);
+        __m256i a  = _mm256_or_si256(_mm256_shuffle_epi8(bg, bg_a), _mm256_shuffle_epi8(r8, r_a));
+        __m256i t  = _mm256_or_si256(_mm256_shuffle_epi8(bg, bg_b), _mm256_shuffle_epi8(r8, r_b));
+
+        uint8_t* d = dst + x * 3;
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(d),      _mm256_castsi256_si128(a));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(d + 16), _mm256_castsi256_si128(t));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(d + 24), _mm256_extracti128_si256(a, 1));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(d + 40), _mm256_extracti128_si256(t, 1));
+    }
+    rowKernelSSE2(src + x * 2, dst + x * 3, width - x, k);
+}
+
+static bool cpuHasAVX2()
+{
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuid(info, 1);
+    // 需要OS保存YMM寄存器
+    if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0) {
+        return false;
+    }
+    if ((_xgetbv(0) & 6) != 6) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#elif defined(__GNUC__) || defined(__clang__)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
+#else
+    return false;
+#endif
+}
+
+#endif // FUNNY_YUV_X86
+
+#ifdef FUNNY_YUV_NEON
+
+// 8个像素共用4组色度项(lo为前4个像素，hi为后4个)
+static inline uint8x8_t neonChannel(int32x4_t ylo, int32x4_t yhi, int32x4_t clo, int32x4_t chi)
+{
+    int16x4_t lo = vmovn_s32(vshrq_n_s32(vaddq_s32(ylo, clo), 8));
+    int16x4_t hi = vmovn_s32(vshrq_n_s32(vaddq_s32(yhi, chi), 8));
+    return vqmovun_s16(vcombine_s16(lo, hi));
+}
+
+static inline uint8x16_t neonZip(uint8x8_t even, uint8x8_t odd)
+{
+    uint8x8x2_t z = vzip_u8(even, odd);
+    return vcombine_u8(z.val[0], z.val[1]);
+}
+
+static void rowKernelNEON(const uint8_t* src, uint8_t* dst, int width, const YUVCoeffs& k)
+{
+    const int32x4_t v128 = vdupq_n_s32(128);
+
+    int x = 0;
+    // 每次16个像素：vld4把Y偶/C0/Y奇/C1拆开，奇偶像素共用同一组色度项
+    for (; x + 16 <= width; x += 16) {
+        uint8x8x4_t v = vld4_u8(src + x * 2);
+        int16x8_t ye = vreinterpretq_s16_u16(vsubl_u8(v.val[0], vdup_n_u8(16)));
+        int16x8_t yo = vreinterpretq_s16_u16(vsubl_u8(v.val[2], vdup_n_u8(16)));
+        int16x8_t c0 = vreinterpretq_s16_u16(vsubl_u8(v.val[1], vdup_n_u8(128)));
+        int16x8_t c1 = vreinterpretq_s16_u16(vsubl_u8(v.val[3], vdup_n_u8(128)));
+
+        int16x4_t c0l = vget_low_s16(c0), c0h = vget_high_s16(c0);
+        int16x4_t c1l = vget_low_s16(c1), c1h = vget_high_s16(c1);
+        int32x4_t rcl = vmlal_n_s16(vmull_n_s16(c0l, k.r0), c1l, k.r1);
+        int32x4_t rch = vmlal_n_s16(vmull_n_s16(c0h, k.r0), c1h, k.r1);
+        int32x4_t gcl = vmlal_n_s16(vmull_n_s16(c0l, k.g0), c1l, k.g1);
+        int32x4_t gch = vmlal_n_s16(vmull_n_s16(c0h, k.g0), c1h, k.g1);
+        int32x4_t bcl = vmlal_n_s16(vmull_n_s16(c0l, k.b0), c1l, k.b1);
+        int32x4_t bch = vmlal_n_s16(vmull_n_s16(c0h, k.b0), c1h, k.b1);
+
+        int32x4_t yel = vmlal_n_s16(v128, vget_low_s16(ye), 298);
+        int32x4_t yeh = vmlal_n_s16(v128, vget_high_s16(ye), 298);
+        int32x4_t yol = vmlal_n_s16(v128, vget_low_s16(yo), 298);
+        int32x4_t yoh = vmlal_n_s16(v128, vget_high_s16(yo), 298);
+
+        uint8x16x3_t bgr;
+        bgr.val[0] = neonZip(neonChannel(yel, yeh, bcl, bch), neonChannel(yol, yoh, bcl, bch));
+        bgr.val[1] = neonZip(neonChannel(yel, yeh, gcl, gch), neonChannel(yol, yoh, gcl, gch));
+        bgr.val[2] = neonZip(neonChannel(yel, yeh, rcl, rch), neonChannel(yol, yoh, rcl, rch));
+        vst3q_u8(dst + x * 3, bgr);
+    }
+    rowScalar(src, dst, x, width, k);
+}
+
+#endif // FUNNY_YUV_NEON
+
+struct YUV422Kernel {
+    YUV422RowKernel row;
+    const char*     name;
+};
+
+static YUV422Kernel selectKernel()
+{
+#ifdef FUNNY_YUV_X86
+    if (cpuHasAVX2()) {
+        return YUV422Kernel{rowKernelAVX2, "avx2"};
+    }
+    return YUV422Kernel{rowKernelSSE2, "sse2"};
+#elif defined(FUNNY_YUV_NEON)
+    return YUV422Kernel{rowKernelNEON, "neon"};
+#else
+    return YUV422Kernel{rowKernelScalar, "scalar"};
+#endif
+}
+
+static const YUV422Kernel& kernel()
+{
+    static const YUV422Kernel k = selectKernel();
+    return k;
+}
+
+const char* funny_yuv422_kernel()
+{
+    return kernel().name;
+}
+
+void funny_yuv422_to_bgr(
+    const uint8_t* src, int src_stride,
+    uint8_t* dst, int dst_stride,
+    int width, int height, YUV422Layout layout,
+    bool parallel)
+{
+    if (!src || !dst || width <= 0 || height <= 0) {
+        return;
+    }
+
+    const YUVCoeffs& k = (layout == YUV422Layout::YVYU) ? kYVYU : kYUYV;
+    YUV422RowKernel row = kernel().row;
+
+    auto rows = [&](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            row(src + static_cast<size_t>(i) * src_stride, dst + static_cast<size_t>(i) * dst_stride, width, k);
+        }
+    };
+
+    if (!parallel) {
+        rows(0, height);
+        return;
+    }
+
+    TYWorkerPool& pool = TYWorkerPool::shared();
+    int bands = static_cast<int>(pool.size() + 1) * 4;
+    int grain = std::max(8, (height + bands - 1) / bands);
+    pool.parallel_for(0, height, grain, rows);
+}
+
+// 把S行源数据块平均成一行输出分辨率的YUYV/YVYU：每个输出像素的Y取S * S块的平均，
+// 色度仍按4:2:2，每两个输出像素共用2S * S块内S * S个样本的平均值，之后直接复用全分辨率的行转换
+// 块内样本数均为2的幂，平均值用移位舍入
+// 从第ox个输出像素(偶数)开始处理到行尾
+template <int S>
+static void reducedLine(const uint8_t* src, int src_stride, uint8_t* line, int ox, int out_w)
+{
+    const int shift = (S == 2) ? 2 : 4;
+    const int half = 1 << (shift - 1);
+    const uint8_t* rows[S];
+    for (int r = 0; r < S; r++) {
+        rows[r] = src + static_cast<size_t>(r) * src_stride;
+    }
+
+    for (; ox + 1 < out_w; ox += 2) {
+        int y0 = 0, y1 = 0, c0 = 0, c1 = 0;
+        for (int r = 0; r < S; r++) {
+            const uint8_t* a = rows[r] + ox * S * 2;
+            for (int m = 0; m < S / 2; m++, a += 4) {
+                y0 += a[0] + a[2];
+                y1 += a[S * 2] + a[S * 2 + 2];
+                c0 += a[1] + a[S * 2 + 1];
+                c1 += a[3] + a[S * 2 + 3];
+            }
+        }
+        uint8_t* d = line + ox * 2;
+        d[0] = static_cast<uint8_t>((y0 + half) >> shift);
+        d[1] = static_cast<uint8_t>((c0 + half) >> shift);
+        d[2] = static_cast<uint8_t>((y1 + half) >> shift);
+        d[3] = static_cast<uint8_t>((c1 + half) >> shift);
+    }
+    if (ox < out_w) {
+        // 末尾单个输出像素，色度只取自己的块
+        int y0 = 0, c0 = 0, c1 = 0;
+        for (int r = 0; r < S; r++) {
+            const uint8_t* a = rows[r] + ox * S * 2;
+            for (int m = 0; m < S / 2; m++, a += 4) {
+                y0 += a[0] + a[2];
+                c0 += a[1];
+                c1 += a[3];
+            }
+        }
+        uint8_t* d = line + ox * 2;
+        d[0] = static_cast<uint8_t>((y0 + half) >> shift);
+        d[1] = static_cast<uint8_t>((c0 + half / 2) >> (shift - 1));
+        d[2] = d[0];
+        d[3] = static_cast<uint8_t>((c1 + half / 2) >> (shift - 1));
+    }
+}
+
+#ifdef FUNNY_YUV_X86
+// 2倍缩小的块平均，每次4个输出像素(每行16字节)，返回处理到的输出像素位置
+static int reducedLine2SSE2(const uint8_t* src, int src_stride, uint8_t* line, int out_w)
+{
+    const __m128i mask = _mm_set1_epi16(0x00FF);
+    const __m128i one  = _mm_set1_epi16(1);
+    const __m128i two  = _mm_set1_epi32(2);
+    const uint8_t* a = src;
+    const uint8_t* b = src + src_stride;
+
+    int ox = 0;
+    for (; ox + 4 <= out_w; ox += 4) {
+        __m128i sa = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + ox * 4));
+        __m128i sb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + ox * 4));
+        // Y: 两行相加后相邻两个相加，得到4个输出像素的和
+        __m128i y = _mm_add_epi16(_mm_and_si128(sa, mask), _mm_and_si128(sb, mask));
+        y = _mm_madd_epi16(y, one);
+        // 色度: c0 c1 c0' c1'... 重排为c0 c0' c1 c1'后相邻相加，得到两对输出像素的c0、c1
+        __m128i c = _mm_add_epi16(_mm_srli_epi16(sa, 8), _mm_srli_epi16(sb, 8));
+        c = _mm_shufflehi_epi16(_mm_shufflelo_epi16(c, _MM_SHUFFLE(3, 1, 2, 0)), _MM_SHUFFLE(3, 1, 2, 0));
+        c = _mm_madd_epi16(c, one);
+
+        y = _mm_srli_epi32(_mm_add_epi32(y, two), 2);
+        c = _mm_srli_epi32(_mm_add_epi32(c, two), 2);
+        // 交错成Y c0 Y c1 Y c0' Y c1'
+        __m128i v = _mm_packs_epi32(_mm_unpacklo_epi32(y, c), _mm_unpackhi_epi32(y, c));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(line + ox * 2), _mm_packus_epi16(v, v));
+    }
+    return ox;
+}
+
+// 4倍缩小，每次4个输出像素(每行32字节)；四行的和及第一次相邻相加后都不超过int16范围
+static int reducedLine4SSE2(const uint8_t* src, int src_stride, uint8_t* line, int out_w)
+{
+    const __m128i mask  = _mm_set1_epi16(0x00FF);
+    const __m128i one   = _mm_set1_epi16(1);
+    const __m128i eight = _mm_set1_epi32(8);
+
+    int ox = 0;
+    for (; ox + 4 <= out_w; ox += 4) {
+        __m128i y2[2], c2[2];
+        for (int h = 0; h < 2; h++) {
+            __m128i y = _mm_setzero_si128();
+            __m128i c = _mm_setzero_si128();
+            for (int r = 0; r < 4; r++) {
+                __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(
+                    src + static_cast<size_t>(r) * src_stride + ox * 8 + h * 16));
+                y = _mm_add_epi16(y, _mm_and_si128(s, mask));
+                c = _mm_add_epi16(c, _mm_srli_epi16(s, 8));
+            }
+            y2[h] = _mm_madd_epi16(y, one);
+            c = _mm_shufflehi_epi16(_mm_shufflelo_epi16(c, _MM_SHUFFLE(3, 1, 2, 0)), _MM_SHUFFLE(3, 1, 2, 0));
+            c2[h] = _mm_madd_epi16(c, one);
+        }
+        __m128i y = _mm_madd_epi16(_mm_packs_epi32(y2[0], y2[1]), one);
+        __m128i c = _mm_packs_epi32(c2[0], c2[1]);
+        c = _mm_shufflehi_epi16(_mm_shufflelo_epi16(c, _MM_SHUFFLE(3, 1, 2, 0)), _MM_SHUFFLE(3, 1, 2, 0));
+        c = _mm_madd_epi16(c, one);
+
+        y = _mm_srli_epi32(_mm_add_epi32(y, eight), 4);
+        c = _mm_srli_epi32(_mm_add_epi32(c, eight), 4);
+        __m128i v = _mm_packs_epi32(_mm_unpacklo_epi32(y, c), _mm_unpackhi_epi32(y, c));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(line + ox * 2), _mm_packus_epi16(v, v));
+    }
+    return ox;
+}
+#endif
+
+void funny_yuv422_to_bgr_reduced(
+    const uint8_t* src, int src_stride,
+    uint8_t* dst, int dst_stride,
+    int width, int height, YUV422Layout layout, int scale,
+    bool parallel)
+{
+    if (scale == 1) {
+        funny_yuv422_to_bgr(src, src_stride, dst, dst_stride, width, height, layout, parallel);
+        return;
+    }
+    if (!src || !dst || (scale != 2 && scale != 4)) {
+        return;
+    }
+    const int out_w = width / scale;
+    const int out_h = height / scale;
+    if (out_w <= 0 || out_h <= 0) {
+        return;
+    }
+
+    const YUVCoeffs& k = (layout == YUV422Layout::YVYU) ? kYVYU : kYUYV;
+    YUV422RowKernel row = kernel().row;
+
+    auto rows = [&](int begin, int end) {
+        std::vector<uint8_t> line(static_cast<size_t>(out_w + 1) / 2 * 4);
+        for (int i = begin; i < end; i++) {
+            const uint8_t* s = src + static_cast<size_t>(i) * scale * src_stride;
+            if (scale == 2) {
+                int ox = 0;
+#ifdef FUNNY_YUV_X86
+                ox = reducedLine2SSE2(s, src_stride, line.data(), out_w);
+#endif
+                reducedLine<2>(s, src_stride, line.data(), ox, out_w);
+            } else {
+                int ox = 0;
+#ifdef FUNNY_YUV_X86
+                ox = reducedLine4SSE2(s, src_stride, line.data(), out_w);
+#endif
+                reducedLine<4>(s, src_stride, line.data(), ox, out_w);
+            }
+            row(line.data(), dst + static_cast<size_t>(i) * dst_stride, out_w, k);
+        }
+    };
+
+    if (!parallel) {
+        rows(0, out_h);
+        return;
+    }
+
+    TYWorkerPool& pool = TYWorkerPool::shared();
+    int bands = static_cast<int>(pool.size() + 1) * 4;
+    int grain = std::max(8, (out_h + bands - 1) / bands);
+    pool.parallel_for(0, out_h, grain, rows);
+}
@@ -0,0 +1,36 @@
+#ifndef FUNNY_YUV_HPP_
+#define FUNNY_YUV_HPP_
+
+#include <stdint.h>
+
+// YUV422打包格式中色度分量的顺序
+enum class YUV422Layout {
+    YUYV,   // Y0 U0 Y1 V0
+    YVYU    // Y0 V0 Y1 U0
+};
+
+// YUV422(YUYV/YVYU)转BGR888，BT.601有限范围整数公式
+// 按宏像素(两个像素共用一组UV)处理，运行时按CPU选择AVX2/SSE2/NEON内核，所有内核与标量实现逐位一致
+// 宽度为奇数时，行末像素缺少的色度分量取128
+// src_stride/dst_stride为行字节数；parallel为true时按行带分给TYWorkerPool::shared()并行处理
+void funny_yuv422_to_bgr(
+    const uint8_t* src, int src_stride,
+    uint8_t* dst, int dst_stride,
+    int width, int height, YUV422Layout layout,
+    bool parallel = false
+);
+
+// 缩小解码：直接输出(width / scale) x (height / scale)的BGR888(向下取整)，scale为1/2/4，1时同funny_yuv422_to_bgr
+// 每个输出像素对应scale x scale的源像素块，Y取块内平均；色度在输出分辨率上仍为4:2:2，
+// 取相邻两个输出像素的块内平均，再用全分辨率的行内核转换；只读取源图一次，不生成全分辨率中间图
+void funny_yuv422_to_bgr_reduced(
+    const uint8_t* src, int src_stride,
+    uint8_t* dst, int dst_stride,
+    int width, int height, YUV422Layout layout, int scale,
+    bool parallel = false
+);
+
+// 当前选用的内核名称("avx2"/"sse2"/"neon"/"scalar")
+const char* funny_yuv422_kernel();
+
+#endif
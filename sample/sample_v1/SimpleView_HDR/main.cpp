@@ -1,4 +1,5 @@
 #include "common.hpp"
+#include "TYHdrStage.hpp"
 
 
 void eventCallback(TY_EVENT_INFO *event_info, void *userdata)
@@ -13,54 +14,27 @@ void eventCallback(TY_EVENT_INFO *event_info, void *userdata)
     }
 }
 
-static inline int covertToLinear(cv::Mat &raw16, cv::Mat raw32,
-    uint32_t *param)
-{
-    uint16_t *src = (uint16_t *)raw16.data;
-    int *dst = (int *)raw32.data;
-    uint32_t R1 = param[0];
-    uint32_t R2 = param[1];
-    R1 = 1 << (R1 + 2);
-    R2 = 1 << (R2 + 2);
-    uint32_t P1 = 1 << param[6];
-    uint32_t P2 = 1 << param[7];
-    uint32_t Pk = (int)((P2 - P1)/(4.0f*R1)) + P1;
-    for (int i = 0; i < raw16.cols * raw16.rows; i++) {
-        if (src[i] <= P1) {
-            dst[i] = (int)src[i];
-        } else if (src[i] > P1 && src[i] <= Pk) {
-            dst[i] = ((int)src[i] - P1)* 4* R1 + P1;
-        } else {
-            dst[i] = ((int)src[i] - Pk)* 4* R1 * R2 + P2;
-        }
-    }
-    return 0;
-}
-
 static inline int parseHDRRaw10(TY_FRAME_DATA& frame,
-    cv::Mat* pColor, uint32_t *param)
+    cv::Mat* pColor, uint32_t *param, TYHdrStage::ToneMap tone)
 {
     if (pColor == NULL) {
         return -1;
     }
+    //lut is rebuilt only when R1/R2/P1/P2 changed
+    static TYHdrStage hdr;
+    hdr.configure(param, tone);
     for(int idx=0;idx<frame.validCount;idx++){
         TY_IMAGE_DATA &img = frame.image[idx];
         if(img.componentID == TY_COMPONENT_RGB_CAM && 
                              img.pixelFormat == TY_PIXEL_FORMAT_CSI_MONO10){
+            //decode csi_mono10, recover 10bit hdr data to 12 bit, convert compressed 12bit hdr data
+            //to 20 bit linear data and map to 16bit in one pass
+            //TONEMAP_CLIP saturates like the old convertTo(CV_16U), TONEMAP_LOG (-log) keeps the dark details for preview
             cv::Mat raw16 = cv::Mat(img.height,img.width,CV_16U);
-            cv::Mat raw32 = cv::Mat(img.height,img.width,CV_32S);
-            //decode csi_mono10 to gray16
-            decodeCsiRaw10((uchar *)img.buffer, (ushort *)raw16.data,
-                img.width, img.height);
-            //recover 10bit hdr data to 12 bit hdr Data
-            raw16 = raw16 * 4;
-            //covert compressed 12bit hdr data to 20 bit linear data
-            covertToLinear(raw16, raw32, param);
-            //TODO: shitft the 16bit with most details to the lsb for force convert, will show most details when preview
-            //raw32 = raw32 / (1 << 2);
-            //Here May overflow, force type convert here
-            raw32.convertTo(raw32, CV_16U);
-            *pColor = raw32.clone();
+            if (hdr.process(img, NULL, (uint16_t *)raw16.data, NULL, true) != TY_STATUS_OK) {
+                return -1;
+            }
+            *pColor = raw16;
             break;
         }
     }
@@ -114,6 +88,7 @@ int main(int argc, char* argv[])
     color = ir = depth = 1;
     int R1 = 0, R2 = 0;
     bool hdr_enable = true;
+    bool tonemap_log = false;
     int expo = -1;
 
     for(int i = 1; i < argc; i++) {
@@ -143,8 +118,10 @@ int main(int argc, char* argv[])
             hdr_enable = atoi(argv[++i]) == 0 ? false : true;
         } else if (strcmp(argv[i], "-expo") == 0) {
             expo = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-log") == 0) {
+            tonemap_log = true;
         } else if(strcmp(argv[i], "-h") == 0) {
-            LOGI("Usage: SimpleView_HDR [-h] [-id <ID>] [-HDR en] [-R1 r1] [-R2 r2] [-expo ex]");
+            LOGI("Usage: SimpleView_HDR [-h] [-id <ID>] [-HDR en] [-R1 r1] [-R2 r2] [-expo ex] [-log]");
             return 0;
         }
     }
@@ -282,7 +259,8 @@ int main(int argc, char* argv[])
                 }
                 //Color cannot use normal parse as is HDR
                 parseFrame(frame, &depth, &irl, &irr, NULL, NULL);
-                parseHDRRaw10(frame, &color, &_hdr_param[0]);
+                parseHDRRaw10(frame, &color, &_hdr_param[0],
+                    tonemap_log ? TYHdrStage::TONEMAP_LOG : TYHdrStage::TONEMAP_CLIP);
             } else {
                 parseFrame(frame, &depth, &irl, &irr, &color, NULL);
             }
@@ -3,6 +3,10 @@
 #include <iostream>
 #include <cstring>
 #include <cstdlib>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
 
 struct to_string
 {
@@ -11,10 +15,131 @@ struct to_string
     operator std::string() const { return ss.str(); }
 };
 
-// 简化的updateDevicesParallel函数
-static void updateDevicesParallel(const std::vector<TY_INTERFACE_HANDLE>& hIfaces) {
-    // 这里实现设备列表的并行更新逻辑
-    // 简化实现，实际项目中可能需要更复杂的处理
+// 并行扫描的共享状态，由各扫描线程按返回的先后写入；超过截止时间的线程仍持有该状态直到结束
+struct InterfaceScanState {
+    std::mutex                              lock;
+    std::condition_variable                 cond;
+    size_t                                  pending;
+    std::vector<bool>                       done;
+    std::vector<TY_DEVICE_BASE_INFO>        devices;
+    std::vector<percipio_layer::InterfaceScanInfo> report;
+};
+
+namespace percipio_layer {
+
+// 超过截止时间仍未返回的扫描线程
+struct PendingScan {
+    std::shared_ptr<InterfaceScanState> state;
+    size_t      idx;
+    std::thread thread;
+
+    bool finished() {
+        std::lock_guard<std::mutex> lock(state->lock);
+        return state->done[idx];
+    }
+};
+
+}
+
+static void scanInterface(std::shared_ptr<InterfaceScanState> state, size_t idx, TY_INTERFACE_HANDLE hIface,
+                          std::chrono::steady_clock::time_point begin, uint32_t timeout_ms)
+{
+    std::vector<TY_DEVICE_BASE_INFO> devs;
+    TY_STATUS status = TYUpdateDeviceList(hIface);
+    if (status == TY_STATUS_OK) {
+        uint32_t n = 0;
+        status = TYGetDeviceNumber(hIface, &n);
+        if (status == TY_STATUS_OK && n > 0) {
+            devs.resize(n);
+            status = TYGetDeviceList(hIface, &devs[0], n, &n);
+            devs.resize(status == TY_STATUS_OK ? n : 0);
+        }
+    }
+    TYCloseInterface(hIface);
+
+    uint32_t elapsed = static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - begin).count());
+
+    std::lock_guard<std::mutex> lock(state->lock);
+    percipio_layer::InterfaceScanInfo& info = state->report[idx];
+    info.status = status;
+    info.deviceCount = static_cast<uint32_t>(devs.size());
+    info.elapsedMs = elapsed;
+    info.timedOut = elapsed > timeout_ms;
+    // 按接口返回的先后合并，同一设备经多个网卡可见时保留最先返回的一条
+    for (const auto& dev : devs) {
+        bool exists = false;
+        for (const auto& known : state->devices) {
+            if (strcmp(known.id, dev.id) == 0) {
+                exists = true;
+                break;
+            }
+        }
+        if (!exists) {
+            state->devices.push_back(dev);
+        }
+    }
+    state->done[idx] = true;
+    state->pending--;
+    state->cond.notify_all();
+}
+
+// 每个接口一个线程并行执行TYUpdateDeviceList，结果随接口返回逐个合并，最多等待timeout_ms
+// 截止时间到达时返回已合并的结果，未返回的接口在报告中标记为超时，其线程移入late，结果不再使用
+// 接口句柄由扫描线程负责关闭；late为空时等待全部线程结束
+static void updateDevicesParallel(const std::vector<TY_INTERFACE_HANDLE>& hIfaces,
+                                  const std::vector<std::string>& ids,
+                                  uint32_t timeout_ms,
+                                  std::vector<TY_DEVICE_BASE_INFO>& out,
+                                  std::vector<percipio_layer::InterfaceScanInfo>& report,
+                                  std::vector<std::shared_ptr<percipio_layer::PendingScan>>* late)
+{
+    std::shared_ptr<InterfaceScanState> state = std::make_shared<InterfaceScanState>();
+    state->pending = hIfaces.size();
+    state->done.assign(hIfaces.size(), false);
+    state->report.resize(hIfaces.size());
+    for (size_t i = 0; i < hIfaces.size(); i++) {
+        state->report[i].id = ids[i];
+        state->report[i].status = TY_STATUS_TIMEOUT;
+        state->report[i].deviceCount = 0;
+        state->report[i].elapsedMs = 0;
+        state->report[i].timedOut = false;
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    threads.reserve(hIfaces.size());
+    for (size_t i = 0; i < hIfaces.size(); i++) {
+        threads.push_back(std::thread(scanInterface, state, i, hIfaces[i], begin, timeout_ms));
+    }
+
+    std::vector<bool> done;
+    {
+        std::unique_lock<std::mutex> lock(state->lock);
+        if (late) {
+            state->cond.wait_until(lock, begin + std::chrono::milliseconds(timeout_ms),
+                                   [&state] { return state->pending == 0; });
+        } else {
+            state->cond.wait(lock, [&state] { return state->pending == 0; });
+        }
+        out = state->devices;
+        report = state->report;
+        done = state->done;
+    }
+
+    for (size_t i = 0; i < threads.size(); i++) {
+        if (done[i]) {
+            threads[i].join();
+            continue;
+        }
+        report[i].elapsedMs = timeout_ms;
+        report[i].timedOut = true;
+        std::shared_ptr<percipio_layer::PendingScan> scan = std::make_shared<percipio_layer::PendingScan>();
+        scan->state = state;
+        scan->idx = i;
+        scan->thread = std::move(threads[i]);
+        late->push_back(scan);
+    }
 }
 
 // CHECK_RET宏定义
@@ -54,7 +179,9 @@ static std::string TY_ERROR(TY_STATUS status)
     return to_string() << status << "(" << TYErrorString(status) << ").";
 }
 
-static inline TY_STATUS searchDevice(std::vector<TY_DEVICE_BASE_INFO>& out, const char *inf_id = nullptr, TY_INTERFACE_TYPE type = TY_INTERFACE_ALL)
+static inline TY_STATUS searchDevice(std::vector<TY_DEVICE_BASE_INFO>& out, const char *inf_id = nullptr, TY_INTERFACE_TYPE type = TY_INTERFACE_ALL,
+                                     uint32_t timeout_ms = 2000, std::vector<percipio_layer::InterfaceScanInfo>* report = nullptr,
+                                     std::vector<std::shared_ptr<percipio_layer::PendingScan>>* late = nullptr)
 {
     out.clear();
     ASSERT_OK( TYUpdateInterfaceList() );
@@ -68,6 +195,7 @@ static inline TY_STATUS searchDevice(std::vector<TY_DEVICE_BASE_INFO>& out, cons
 
     bool found = false;
     std::vector<TY_INTERFACE_HANDLE> hIfaces;
+    std::vector<std::string> ids;
     for(uint32_t i = 0; i < ifaces.size(); i++){
         TY_INTERFACE_HANDLE hIface;
         if(type & ifaces[i].type) {
@@ -77,6 +205,7 @@ static inline TY_STATUS searchDevice(std::vector<TY_DEVICE_BASE_INFO>& out, cons
                 strcmp(inf_id, ifaces[i].id) == 0) {
                 ASSERT_OK( TYOpenInterface(ifaces[i].id, &hIface) );
                 hIfaces.push_back(hIface);
+                ids.push_back(ifaces[i].id);
                 found = true;
                 //Interface been setted, found and just break
                 if(nullptr != inf_id) {
@@ -87,20 +216,15 @@ static inline TY_STATUS searchDevice(std::vector<TY_DEVICE_BASE_INFO>& out, cons
 
     }
     if(!found) return TY_STATUS_ERROR;
-    updateDevicesParallel(hIfaces);
 
-    for (uint32_t i = 0; i < hIfaces.size(); i++) {
-        TY_INTERFACE_HANDLE hIface = hIfaces[i];
-        uint32_t n = 0;
-        TYGetDeviceNumber(hIface, &n);
-        if(n > 0){
-            std::vector<TY_DEVICE_BASE_INFO> devs(n);
-            TYGetDeviceList(hIface, &devs[0], n, &n);
-            for(uint32_t j = 0; j < n; j++) {
-                out.push_back(devs[j]);
-            }
-        }
-        TYCloseInterface(hIface);
+    std::vector<percipio_layer::InterfaceScanInfo> scan_report;
+    updateDevicesParallel(hIfaces, ids, timeout_ms, out, scan_report, late);
+    for (const auto& info : scan_report) {
+        LOGD("scan " << info.id << ": " << info.deviceCount << " device(s), "
+             << info.elapsedMs << " ms" << (info.timedOut ? " (timeout)" : ""));
+    }
+    if (report) {
+        report->swap(scan_report);
     }
 
     if(out.size() == 0){
@@ -219,6 +343,11 @@ void  TYDevice::registerEventCallback(const TY_EVENT eventID, void* data, EventC
 
 void TYDevice::onDeviceEventCallback(const TY_EVENT_INFO *event_info)
 {
+    // 离线设备的缓存信息不再可信，下一次打开时重新枚举
+    if (event_info->eventId == TY_EVENT_DEVICE_OFFLINE) {
+        TYContext::getInstance().invalidateDevice(_dev_info.id);
+    }
+
     auto it = _eventCallbackMap.find(event_info->eventId);
     if (it != _eventCallbackMap.end() && it->second.second != nullptr) {
         it->second.second(it->second.first);
@@ -231,6 +360,7 @@ std::shared_ptr<TYDeviceInfo> TYDevice::getDeviceInfo()
 }
 
 std::set<TY_INTERFACE_HANDLE> DeviceList::gifaces;
+std::mutex DeviceList::gifaces_lock;
 DeviceList::DeviceList(std::vector<DeviceBaseInfo>& devices)
 {
     devs = devices;
@@ -238,6 +368,7 @@ DeviceList::DeviceList(std::vector<DeviceBaseInfo>& devices)
 
 DeviceList::~DeviceList()
 {
+    std::lock_guard<std::mutex> lock(gifaces_lock);
     for (TY_INTERFACE_HANDLE iface : gifaces) {
         TYCloseInterface(iface);
     }
@@ -281,7 +412,10 @@ std::shared_ptr<TYDevice> DeviceList::getDevice(int idx)
         return nullptr;
     }
 
-    gifaces.insert(hIface);
+    {
+        std::lock_guard<std::mutex> lock(gifaces_lock);
+        gifaces.insert(hIface);
+    }
     std::string ifaceId = devs[idx].iface.id;
     std::string open_log = std::string("open device ") + devs[idx].id +
         "\non interface " + parseInterfaceID(ifaceId);
@@ -329,7 +463,10 @@ std::shared_ptr<TYDevice> DeviceList::getDeviceBySN(const char* sn)
             status = TYOpenInterface(devs[i].iface.id, &hIface);
             if(status != TY_STATUS_OK)  continue;
 
-            gifaces.insert(hIface);
+            {
+                std::lock_guard<std::mutex> lock(gifaces_lock);
+                gifaces.insert(hIface);
+            }
             std::string ifaceId = devs[i].iface.id;
             std::string open_log = std::string("open device ") + devs[i].id +
                 "\non interface " + parseInterfaceID(ifaceId);
@@ -418,10 +555,40 @@ std::shared_ptr<TYDevice> DeviceList::getDeviceByIP(const char* ip)
     return nullptr;
 }
 
-std::shared_ptr<DeviceList> TYContext::queryDeviceList(const char *iface)
+TYContext::~TYContext()
+{
+    reapLateScans(true);
+}
+
+void TYContext::reapLateScans(bool wait)
+{
+    std::lock_guard<std::mutex> lock(_scan_lock);
+    for (auto it = _late_scans.begin(); it != _late_scans.end(); ) {
+        if (wait || (*it)->finished()) {
+            (*it)->thread.join();
+            it = _late_scans.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+std::shared_ptr<DeviceList> TYContext::searchDeviceList(const char *iface, TY_INTERFACE_TYPE type)
 {
+    reapLateScans(false);
+
     std::vector<TY_DEVICE_BASE_INFO> ty_devs;
-    searchDevice(ty_devs, iface);
+    std::vector<InterfaceScanInfo> report;
+    std::vector<std::shared_ptr<PendingScan>> late;
+    searchDevice(ty_devs, iface, type, _discovery_timeout, &report, &late);
+    if (!late.empty()) {
+        std::lock_guard<std::mutex> lock(_scan_lock);
+        _late_scans.insert(_late_scans.end(), late.begin(), late.end());
+    }
+    {
+        std::lock_guard<std::mutex> lock(_report_lock);
+        _last_report.swap(report);
+    }
     
     // 转换为DeviceBaseInfo格式
     std::vector<DeviceBaseInfo> devs;
@@ -437,33 +604,145 @@ std::shared_ptr<DeviceList> TYContext::queryDeviceList(const char *iface)
         info.netInfo = ty_dev.netInfo;
         devs.push_back(info);
     }
+    updateRegistry(devs, iface);
     
     return std::shared_ptr<DeviceList>(new DeviceList(devs));
 }
 
+std::shared_ptr<DeviceList> TYContext::queryDeviceList(const char *iface)
+{
+    return searchDeviceList(iface, TY_INTERFACE_ALL);
+}
+
 std::shared_ptr<DeviceList> TYContext::queryNetDeviceList(const char *iface)
 {
-    std::vector<TY_DEVICE_BASE_INFO> ty_devs;
-    searchDevice(ty_devs, iface, TY_INTERFACE_ETHERNET | TY_INTERFACE_IEEE80211);
-    
-    // 转换为DeviceBaseInfo格式
-    std::vector<DeviceBaseInfo> devs;
-    for (const auto& ty_dev : ty_devs) {
-        DeviceBaseInfo info;
-        memset(&info, 0, sizeof(info));
-        strncpy(info.id, ty_dev.id, sizeof(info.id) - 1);
-        strncpy(info.name, ty_dev.vendorName, sizeof(info.name) - 1);
-        strncpy(info.modelName, ty_dev.modelName, sizeof(info.modelName) - 1);
-        strncpy(info.serialNumber, ty_dev.id, sizeof(info.serialNumber) - 1);
-        info.nChipID = 0;
-        info.iface = ty_dev.iface;
-        info.netInfo = ty_dev.netInfo;
-        devs.push_back(info);
+    return searchDeviceList(iface, TY_INTERFACE_ETHERNET | TY_INTERFACE_IEEE80211);
+}
+
+std::vector<InterfaceScanInfo> TYContext::lastScanReport()
+{
+    std::lock_guard<std::mutex> lock(_report_lock);
+    return _last_report;
+}
+
+void TYContext::updateRegistry(const std::vector<DeviceBaseInfo>& devs, const char* iface)
+{
+    std::lock_guard<std::mutex> lock(_registry_lock);
+    auto now = std::chrono::steady_clock::now();
+
+    // 定向扫描某个接口时，该接口上已不存在的设备直接移除
+    if (iface) {
+        for (auto it = _registry.begin(); it != _registry.end(); ) {
+            bool seen = false;
+            for (const auto& dev : devs) {
+                if (it->first == dev.id) {
+                    seen = true;
+                    break;
+                }
+            }
+            if (!seen && strcmp(it->second.info.iface.id, iface) == 0) {
+                _registry_ip.erase(it->second.info.netInfo.ip);
+                it = _registry.erase(it);
+            } else {
+                ++it;
+            }
+        }
     }
-    
+
+    for (const auto& dev : devs) {
+        RegistryEntry& entry = _registry[dev.id];
+        if (TYIsNetworkInterface(entry.info.iface.type)) {
+            _registry_ip.erase(entry.info.netInfo.ip);
+        }
+        entry.info = dev;
+        entry.updated = now;
+        if (TYIsNetworkInterface(dev.iface.type) && dev.netInfo.ip[0]) {
+            _registry_ip[dev.netInfo.ip] = dev.id;
+        }
+    }
+}
+
+bool TYContext::lookupRegistry(const char* sn, const char* ip, DeviceBaseInfo& info, bool& stale)
+{
+    std::lock_guard<std::mutex> lock(_registry_lock);
+    std::string key;
+    if (sn) {
+        key = sn;
+    } else {
+        auto ip_it = _registry_ip.find(ip);
+        if (ip_it == _registry_ip.end()) {
+            return false;
+        }
+        key = ip_it->second;
+    }
+
+    auto it = _registry.find(key);
+    if (it == _registry.end()) {
+        return false;
+    }
+    info = it->second.info;
+    stale = std::chrono::steady_clock::now() - it->second.updated > std::chrono::milliseconds(_registry_ttl);
+    return true;
+}
+
+std::shared_ptr<DeviceList> TYContext::findDevice(const char* sn, const char* ip)
+{
+    DeviceBaseInfo info;
+    bool stale = false;
+    bool known = lookupRegistry(sn, ip, info, stale);
+    if (!known || stale) {
+        TY_INTERFACE_TYPE type = ip ? (TY_INTERFACE_ETHERNET | TY_INTERFACE_IEEE80211) : TY_INTERFACE_ALL;
+        bool found = false;
+        if (known) {
+            // 先只重新扫描该设备所在的接口
+            std::string iface = info.iface.id;
+            searchDeviceList(iface.c_str(), TY_INTERFACE_ALL);
+            found = lookupRegistry(sn, ip, info, stale);
+        }
+        // 未知设备，或设备已换到其他网卡/USB口时做一次完整枚举
+        if (!found) {
+            searchDeviceList(nullptr, type);
+            found = lookupRegistry(sn, ip, info, stale);
+        }
+        if (!found) {
+            return nullptr;
+        }
+    }
+
+    std::vector<DeviceBaseInfo> devs(1, info);
     return std::shared_ptr<DeviceList>(new DeviceList(devs));
 }
 
+std::shared_ptr<DeviceList> TYContext::findDeviceBySN(const char* sn)
+{
+    return sn ? findDevice(sn, nullptr) : nullptr;
+}
+
+std::shared_ptr<DeviceList> TYContext::findDeviceByIP(const char* ip)
+{
+    return ip ? findDevice(nullptr, ip) : nullptr;
+}
+
+void TYContext::invalidateDevice(const char* sn)
+{
+    if (!sn) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(_registry_lock);
+    auto it = _registry.find(sn);
+    if (it != _registry.end()) {
+        _registry_ip.erase(it->second.info.netInfo.ip);
+        _registry.erase(it);
+    }
+}
+
+void TYContext::invalidateAll()
+{
+    std::lock_guard<std::mutex> lock(_registry_lock);
+    _registry.clear();
+    _registry_ip.clear();
+}
+
 bool TYContext::ForceNetDeviceIP(const ForceIPStyle style, const std::string& mac, const std::string& ip, const std::string& mask, const std::string& gateway)
 {
     ASSERT_OK( TYUpdateInterfaceList() );
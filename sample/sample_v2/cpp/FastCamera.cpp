@@ -3,15 +3,45 @@
 #include "../../../include/TYApi.h"
 #include "../../../include/TYDefs.h"
 
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
 namespace percipio_layer {
 
+// 当前线程正在执行的帧回调(FrameCallbackEntry)，用于识别在回调内部注销自身
+static thread_local const void* tCurrentCallback = nullptr;
+
+// 调用回调期间标记当前线程，回调内再同步触发其他回调时退出后恢复
+struct CallbackScope {
+    const void* saved;
+    explicit CallbackScope(const void* entry) : saved(tCurrentCallback) { tCurrentCallback = entry; }
+    ~CallbackScope() { tCurrentCallback = saved; }
+};
+
 FastCamera::FastCamera()
+    : isRuning(false), components(0), mLeaseMode(false), mMinFreeBuffers(2)
+    , mPool(std::make_shared<FrameBufferPool>())
+    , mOverflow(OverflowDropOldest), mAcqRunning(false), mDropped(0)
+    , mCallbacks(std::make_shared<FrameCallbackList>()), mNextCallbackId(0)
+    , mOfflineData(nullptr), mOffline(false), mAutoReconnect(false)
+    , mInitialBackoff(100), mMaxBackoff(5000), mBackoff(100), mAwaitFirstFrame(false)
+    , mStreamStats(new StreamStats())
 {
+    memset(&mReconnectStats, 0, sizeof(mReconnectStats));
     // 构造函数实现
 }
 
 FastCamera::FastCamera(const char* sn)
+    : isRuning(false), components(0), mLeaseMode(false), mMinFreeBuffers(2)
+    , mPool(std::make_shared<FrameBufferPool>())
+    , mOverflow(OverflowDropOldest), mAcqRunning(false), mDropped(0)
+    , mCallbacks(std::make_shared<FrameCallbackList>()), mNextCallbackId(0)
+    , mOfflineData(nullptr), mOffline(false), mAutoReconnect(false)
+    , mInitialBackoff(100), mMaxBackoff(5000), mBackoff(100), mAwaitFirstFrame(false)
+    , mStreamStats(new StreamStats())
 {
+    memset(&mReconnectStats, 0, sizeof(mReconnectStats));
     // 带参数构造函数实现
     if (sn) {
         mIfaceId = sn;
@@ -25,30 +55,45 @@ FastCamera::~FastCamera()
         stop();
         close();
     }
+    stopAcquisition();
 }
 
 TY_STATUS FastCamera::open(const char* sn)
 {
-    std::lock_guard<std::mutex> lock(_dev_lock);
-    
     if (!sn) {
         return TY_STATUS_INVALID_PARAMETER;
     }
     
-    // 获取设备列表
+    // 优先使用设备注册表中的缓存，打开失败说明缓存已失效，重新枚举后再试一次
     auto& context = TYContext::getInstance();
-    auto deviceList = context.queryDeviceList();
+    TY_STATUS status = open(context.findDeviceBySN(sn), sn);
+    if (status != TY_STATUS_OK) {
+        context.invalidateDevice(sn);
+        status = open(context.findDeviceBySN(sn), sn);
+    }
+    return status;
+}
+
+TY_STATUS FastCamera::open(const std::shared_ptr<DeviceList>& deviceList, const char* sn)
+{
+    std::lock_guard<std::mutex> lock(_dev_lock);
+    
+    if (!sn) {
+        return TY_STATUS_INVALID_PARAMETER;
+    }
     
     if (!deviceList || deviceList->empty()) {
         return TY_STATUS_ERROR;
     }
     
     // 查找指定序列号的设备
-    device = deviceList->getDeviceBySN(sn);
-    if (!device) {
+    std::shared_ptr<TYDevice> dev = deviceList->getDeviceBySN(sn);
+    if (!dev) {
         return TY_STATUS_ERROR;
     }
     
+    std::atomic_store(&device, dev);
+    attachDevice();
     return TY_STATUS_OK;
 }
 
@@ -61,17 +106,25 @@ TY_STATUS FastCamera::openByIP(const char* ip)
     }
     
     auto& context = TYContext::getInstance();
-    auto deviceList = context.queryNetDeviceList();
-    
-    if (!deviceList || deviceList->empty()) {
-        return TY_STATUS_ERROR;
+    auto deviceList = context.findDeviceByIP(ip);
+    std::shared_ptr<TYDevice> dev;
+    if (deviceList && !deviceList->empty()) {
+        dev = deviceList->getDeviceByIP(ip);
     }
-    
-    device = deviceList->getDeviceByIP(ip);
-    if (!device) {
+    if (!dev && deviceList && !deviceList->empty()) {
+        // 缓存已失效，重新枚举后再试一次
+        context.invalidateDevice(deviceList->getDeviceInfo(0)->info().serialNumber);
+        deviceList = context.findDeviceByIP(ip);
+        if (deviceList && !deviceList->empty()) {
+            dev = deviceList->getDeviceByIP(ip);
+        }
+    }
+    if (!dev) {
         return TY_STATUS_ERROR;
     }
     
+    std::atomic_store(&device, dev);
+    attachDevice();
     return TY_STATUS_OK;
 }
 
@@ -91,9 +144,8 @@ TY_STATUS FastCamera::openWithHandle(TY_DEV_HANDLE handle)
         return status;
     }
     
-    // 转换为DeviceBaseInfo格式
+    // 转换为DeviceBaseInfo格式(构造时已清零)
     DeviceBaseInfo devInfo;
-    memset(&devInfo, 0, sizeof(devInfo));
     strncpy(devInfo.id, tyDevInfo.id, sizeof(devInfo.id) - 1);
     strncpy(devInfo.name, tyDevInfo.vendorName, sizeof(devInfo.name) - 1);
     strncpy(devInfo.modelName, tyDevInfo.modelName, sizeof(devInfo.modelName) - 1);
@@ -103,57 +155,17 @@ TY_STATUS FastCamera::openWithHandle(TY_DEV_HANDLE handle)
     devInfo.netInfo = tyDevInfo.netInfo;
     
     // 创建TYDevice实例
-    device = std::shared_ptr<TYDevice>(new TYDevice(handle, devInfo));
-    
-    // 分配帧缓冲区
-    bool color, ir, depth;
-    color = ir = depth = false;
-    
-    // 获取组件信息
-    TYHasFeature(handle, TY_COMPONENT_RGB_CAM, 0, &color);
-    TYHasFeature(handle, TY_COMPONENT_IR_CAM_LEFT, 0, &ir);
-    TYHasFeature(handle, TY_COMPONENT_DEPTH_CAM, 0, &depth);
-    
-    // 分配缓冲区
-    const int buffer_size = 10;  // 分配10个缓冲区
-    for (int i = 0; i < buffer_size; i++) {
-        char* buffer = NULL;
-        int size = 0;
-        
-        if (depth) {
-            int w = 640, h = 480;  // 默认深度图尺寸
-            TYGetInt(handle, TY_COMPONENT_DEPTH_CAM, TY_INT_WIDTH, &w);
-            TYGetInt(handle, TY_COMPONENT_DEPTH_CAM, TY_INT_HEIGHT, &h);
-            size = w * h * 2;  // 16位深度
-        } else if (color) {
-            int w = 640, h = 480;  // 默认彩色图尺寸
-            TYGetInt(handle, TY_COMPONENT_RGB_CAM, TY_INT_WIDTH, &w);
-            TYGetInt(handle, TY_COMPONENT_RGB_CAM, TY_INT_HEIGHT, &h);
-            size = w * h * 3;  // RGB888
-        } else if (ir) {
-            int w = 640, h = 480;  // 默认IR图尺寸
-            TYGetInt(handle, TY_COMPONENT_IR_CAM_LEFT, TY_INT_WIDTH, &w);
-            TYGetInt(handle, TY_COMPONENT_IR_CAM_LEFT, TY_INT_HEIGHT, &h);
-            size = w * h;  // 8位IR
-        }
-        
-        if (size > 0) {
-            buffer = (char*)malloc(size);
-            if (buffer) {
-                status = TYEnqueueBuffer(handle, buffer, size);
-                if (status != TY_STATUS_OK) {
-                    free(buffer);
-                }
-            }
-        }
-    }
-    
+    std::atomic_store(&device, std::shared_ptr<TYDevice>(new TYDevice(handle, devInfo)));
+    attachDevice();
+
+    // 帧缓冲区在start()时按实际启用的流分配
     return TY_STATUS_OK;
 }
 
 bool FastCamera::has_stream(stream_idx idx)
 {
-    if (!device) {
+    std::shared_ptr<TYDevice> dev = std::atomic_load(&device);
+    if (!dev) {
         return false;
     }
     
@@ -177,7 +189,8 @@ bool FastCamera::has_stream(stream_idx idx)
 
 TY_STATUS FastCamera::stream_enable(stream_idx idx)
 {
-    if (!device) {
+    std::shared_ptr<TYDevice> dev = std::atomic_load(&device);
+    if (!dev) {
         return TY_STATUS_INVALID_HANDLE;
     }
     
@@ -185,22 +198,22 @@ TY_STATUS FastCamera::stream_enable(stream_idx idx)
     
     switch (idx) {
         case stream_depth:
-            status = TYEnableComponents(device->_handle, TY_COMPONENT_DEPTH_CAM);
+            status = TYEnableComponents(dev->_handle, TY_COMPONENT_DEPTH_CAM);
             break;
         case stream_color:
-            status = TYEnableComponents(device->_handle, TY_COMPONENT_RGB_CAM);
+            status = TYEnableComponents(dev->_handle, TY_COMPONENT_RGB_CAM);
             break;
         case stream_ir_left:
-            status = TYEnableComponents(device->_handle, TY_COMPONENT_IR_CAM_LEFT);
+            status = TYEnableComponents(dev->_handle, TY_COMPONENT_IR_CAM_LEFT);
             break;
         case stream_ir_right:
-            status = TYEnableComponents(device->_handle, TY_COMPONENT_IR_CAM_RIGHT);
+            status = TYEnableComponents(dev->_handle, TY_COMPONENT_IR_CAM_RIGHT);
             break;
         case stream_ir:
             // IR流同时启用左右摄像头
-            status = TYEnableComponents(device->_handle, TY_COMPONENT_IR_CAM_LEFT);
+            status = TYEnableComponents(dev->_handle, TY_COMPONENT_IR_CAM_LEFT);
             if (status == TY_STATUS_OK) {
-                status = TYEnableComponents(device->_handle, TY_COMPONENT_IR_CAM_RIGHT);
+                status = TYEnableComponents(dev->_handle, TY_COMPONENT_IR_CAM_RIGHT);
             }
             break;
         default:
@@ -216,7 +229,8 @@ TY_STATUS FastCamera::stream_enable(stream_idx idx)
 
 TY_STATUS FastCamera::stream_disable(stream_idx idx)
 {
-    if (!device) {
+    std::shared_ptr<TYDevice> dev = std::atomic_load(&device);
+    if (!dev) {
         return TY_STATUS_INVALID_HANDLE;
     }
     
@@ -224,22 +238,22 @@ TY_STATUS FastCamera::stream_disable(stream_idx idx)
     
     switch (idx) {
         case stream_depth:
-            status = TYDisableComponents(device->_handle, TY_COMPONENT_DEPTH_CAM);
+            status = TYDisableComponents(dev->_handle, TY_COMPONENT_DEPTH_CAM);
             break;
         case stream_color:
-            status = TYDisableComponents(device->_handle, TY_COMPONENT_RGB_CAM);
+            status = TYDisableComponents(dev->_handle, TY_COMPONENT_RGB_CAM);
             break;
         case stream_ir_left:
-            status = TYDisableComponents(device->_handle, TY_COMPONENT_IR_CAM_LEFT);
+            status = TYDisableComponents(dev->_handle, TY_COMPONENT_IR_CAM_LEFT);
             break;
         case stream_ir_right:
-            status = TYDisableComponents(device->_handle, TY_COMPONENT_IR_CAM_RIGHT);
+            status = TYDisableComponents(dev->_handle, TY_COMPONENT_IR_CAM_RIGHT);
             break;
         case stream_ir:
             // IR流同时禁用左右摄像头
-            status = TYDisableComponents(device->_handle, TY_COMPONENT_IR_CAM_LEFT);
+            status = TYDisableComponents(dev->_handle, TY_COMPONENT_IR_CAM_LEFT);
             if (status == TY_STATUS_OK) {
-                status = TYDisableComponents(device->_handle, TY_COMPONENT_IR_CAM_RIGHT);
+                status = TYDisableComponents(dev->_handle, TY_COMPONENT_IR_CAM_RIGHT);
             }
             break;
         default:
@@ -255,27 +269,46 @@ TY_STATUS FastCamera::stream_disable(stream_idx idx)
 
 TY_STATUS FastCamera::start()
 {
-    if (!device) {
+    std::shared_ptr<TYDevice> dev = std::atomic_load(&device);
+    if (!dev) {
         return TY_STATUS_INVALID_HANDLE;
     }
     
+    // 按当前启用的流和分辨率准备帧缓冲区
+    TY_STATUS status = mPool->prepare(dev->_handle);
+    if (status != TY_STATUS_OK) {
+        return status;
+    }
+
     // 启动数据采集
-    TY_STATUS status = TYStartCapture(device->_handle);
-    if (status == TY_STATUS_OK) {
-        isRuning = true;
+    status = TYStartCapture(dev->_handle);
+    if (status != TY_STATUS_OK) {
+        return status;
     }
-    return status;
+    isRuning = true;
+
+    bool has_callbacks = !std::atomic_load(&mCallbacks)->empty();
+    if (mAcqRing || has_callbacks) {
+        mAcqRunning = true;
+        mAcqThread = std::thread(&FastCamera::acquisitionLoop, this);
+    }
+    return TY_STATUS_OK;
 }
 
 TY_STATUS FastCamera::stop()
 {
-    if (!device || !isRuning) {
+    if (!isRuning) {
         return TY_STATUS_OK; // 已经停止或未启动
     }
     
+    // 先停止采集线程，避免其在TYStopCapture期间继续取帧；
+    // 设备离线且重连失败时device为空，采集线程仍在重试，同样需要停止
+    stopAcquisition();
+
     // 停止数据采集
     TY_STATUS status = doStop();
-    if (status == TY_STATUS_OK) {
+    if (status == TY_STATUS_OK || mOffline) {
+        // 设备已离线时无法停止，视为已停止
         isRuning = false;
     }
     return status;
@@ -283,64 +316,359 @@ TY_STATUS FastCamera::stop()
 
 TY_STATUS FastCamera::doStop()
 {
-    if (!device) {
+    std::shared_ptr<TYDevice> dev = std::atomic_load(&device);
+    if (!dev) {
         return TY_STATUS_INVALID_HANDLE;
     }
     
-    return TYStopCapture(device->_handle);
+    return TYStopCapture(dev->_handle);
 }
 
 void FastCamera::close()
 {
-    std::lock_guard<std::mutex> lock(_dev_lock);
-    
+    // 必须在获取_dev_lock之前停止并等待采集线程：采集线程重连时会在reopen()中获取_dev_lock
     if (isRuning) {
         stop();
     }
+
+    std::lock_guard<std::mutex> lock(_dev_lock);
+
+    // 设备关闭后，尚未归还的租借帧不能再向该句柄入队；缓冲区保留供重新打开时复用
+    mPool->detach();
     
-    if (device) {
-        device.reset();
-    }
+    std::atomic_store(&device, std::shared_ptr<TYDevice>());
     
     components = 0;
     isRuning = false;
+    mOffline = false;
+    std::lock_guard<std::mutex> features_lock(mFeatureLock);
+    mFeatures.clear();
 }
 
 std::shared_ptr<TYFrame> FastCamera::tryGetFrames(uint32_t timeout_ms)
 {
-    if (!device || !isRuning) {
+    if (!std::atomic_load(&device) || !isRuning) {
         return nullptr;
     }
-    
-    return fetchFrames(timeout_ms);
+
+    if (!mAcqRing) {
+        // 帧已由采集线程交给回调
+        if (mAcqThread.joinable()) {
+            return nullptr;
+        }
+        return fetchFrames(timeout_ms);
+    }
+
+    std::shared_ptr<TYFrame> frame;
+    if (!mAcqRing->popWait(frame, timeout_ms)) {
+        return nullptr;
+    }
+    if (mOverflow == OverflowKeepLatest) {
+        // 只保留最新的一帧，较旧的帧释放后其租借的缓冲区立即回到SDK队列
+        std::shared_ptr<TYFrame> newer;
+        while (mAcqRing->tryPop(newer)) {
+            frame = std::move(newer);
+            mDropped++;
+        }
+    }
+    return frame;
+}
+
+TY_STATUS FastCamera::enableAcquisitionThread(uint32_t ring_size, OverflowPolicy policy)
+{
+    if (isRuning) {
+        return TY_STATUS_BUSY;
+    }
+    if (ring_size == 0) {
+        return TY_STATUS_INVALID_PARAMETER;
+    }
+
+    mAcqRing.reset(new FrameRing<std::shared_ptr<TYFrame>>(ring_size));
+    mOverflow = policy;
+    mDropped = 0;
+    return TY_STATUS_OK;
+}
+
+TY_STATUS FastCamera::disableAcquisitionThread()
+{
+    if (isRuning) {
+        return TY_STATUS_BUSY;
+    }
+    mAcqRing.reset();
+    return TY_STATUS_OK;
+}
+
+void FastCamera::acquisitionLoop()
+{
+    while (mAcqRunning) {
+        // 短超时以便及时响应停止请求
+        std::shared_ptr<TYFrame> frame = fetchFrames(100);
+        if (!frame) {
+            continue;
+        }
+
+        dispatchFrame(frame);
+        if (!mAcqRing) {
+            continue;
+        }
+
+        if (mOverflow == OverflowBlock) {
+            mAcqRing->pushWait(std::move(frame), mAcqRunning);
+            continue;
+        }
+
+        while (!mAcqRing->tryPush(std::move(frame))) {
+            // 队满：淘汰最旧的一帧
+            std::shared_ptr<TYFrame> oldest;
+            if (mAcqRing->tryPop(oldest)) {
+                mDropped++;
+            }
+        }
+    }
+}
+
+void FastCamera::stopAcquisition()
+{
+    if (!mAcqThread.joinable()) {
+        return;
+    }
+
+    mAcqRunning = false;
+    // 唤醒因在途上限而阻塞的采集线程
+    std::shared_ptr<const FrameCallbackList> list = std::atomic_load(&mCallbacks);
+    for (const auto& entry : *list) {
+        std::lock_guard<std::mutex> lock(entry->lock);
+        entry->idle.notify_all();
+    }
+    if (!mAcqRing) {
+        mAcqThread.join();
+        return;
+    }
+    mAcqRing->interrupt();
+    mAcqThread.join();
+
+    // 释放队列中残留的帧，租借的缓冲区在设备解绑前归还
+    std::shared_ptr<TYFrame> frame;
+    while (mAcqRing->tryPop(frame)) {
+        frame.reset();
+    }
 }
 
 std::shared_ptr<TYFrame> FastCamera::fetchFrames(uint32_t timeout_ms)
 {
-    if (!device) {
+    if (mOffline && mAutoReconnect && !tryReconnect(timeout_ms)) {
+        return nullptr;
+    }
+    std::shared_ptr<TYDevice> dev = std::atomic_load(&device);
+    if (!dev) {
         return nullptr;
     }
     
     // 调用TY SDK API获取实际帧数据
     TY_FRAME_DATA frameData;
-    int ret = TYFetchFrame(device->_handle, &frameData, timeout_ms);
+    int ret = TYFetchFrame(dev->_handle, &frameData, timeout_ms);
     
     if (ret != TY_STATUS_OK) {
-        // 获取帧失败
         return nullptr;
     }
-    
+
+    Clock::time_point fetched = Clock::now();
+    if (mAwaitFirstFrame.exchange(false)) {
+        std::lock_guard<std::mutex> lock(mReconnectLock);
+        mReconnectStats.offline_to_frame_ms = static_cast<uint32_t>(
+            std::chrono::duration_cast<std::chrono::milliseconds>(fetched - mOfflineAt).count());
+        mReconnectStats.reopen_to_frame_ms = static_cast<uint32_t>(
+            std::chrono::duration_cast<std::chrono::milliseconds>(fetched - mReopenedAt).count());
+    }
+
+    std::shared_ptr<TYFrame> frame = wrapFrame(frameData);
+
+    uint64_t host_us = std::chrono::duration_cast<std::chrono::microseconds>(fetched.time_since_epoch()).count();
+    uint64_t deliver_us = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - fetched).count();
+    mStreamStats->onFrame(frameData, host_us, deliver_us);
+    return frame;
+}
+
+std::shared_ptr<TYFrame> FastCamera::wrapFrame(TY_FRAME_DATA& frameData)
+{
+    if (!frameData.userBuffer || frameData.bufferSize <= 0) {
+        return std::make_shared<TYFrame>(frameData);
+    }
+    // 饥饿只在缓冲池取走最后一个空闲缓冲区时统计一次，各流统计沿用同一判定
+    if (mPool->onFetched(frameData.userBuffer)) {
+        mStreamStats->onStarved(componentMask());
+    }
+
+    // 租借模式：只要SDK队列中仍有足够的空闲缓冲区，就直接把缓冲区交给TYFrame
+    if (mLeaseMode) {
+        if (mPool->freeCount() >= mMinFreeBuffers) {
+            std::shared_ptr<FrameBufferPool> pool = mPool;
+            return std::make_shared<TYFrame>(frameData, [pool](void* buffer, int32_t) {
+                pool->requeue(buffer);
+            });
+        }
+    }
+
     // 创建共享的帧对象
     auto frame = std::make_shared<TYFrame>(frameData);
     
     // 重要：将缓冲区重新入队以供下次使用
-    if (frameData.userBuffer && frameData.bufferSize > 0) {
-        TYEnqueueBuffer(device->_handle, frameData.userBuffer, frameData.bufferSize);
-    }
+    mPool->requeue(frameData.userBuffer);
     
     return frame;
 }
 
+TY_COMPONENT_ID FastCamera::componentMask() const
+{
+    TY_COMPONENT_ID mask = 0;
+    if (components & stream_depth)    mask |= TY_COMPONENT_DEPTH_CAM;
+    if (components & stream_color)    mask |= TY_COMPONENT_RGB_CAM;
+    if (components & stream_ir_left)  mask |= TY_COMPONENT_IR_CAM_LEFT;
+    if (components & stream_ir_right) mask |= TY_COMPONENT_IR_CAM_RIGHT;
+    return mask;
+}
+
+bool FastCamera::streamStats(TY_COMPONENT_ID comp, StreamStatsSnapshot& out) const
+{
+    return mStreamStats->snapshot(comp, out);
+}
+
+void FastCamera::resetStreamStats()
+{
+    mStreamStats->reset();
+}
+
+int FastCamera::registerFrameCallback(FrameCallback cb, FrameExecutor executor,
+                                      uint32_t max_in_flight, bool blocking)
+{
+    if (!cb) {
+        return TY_STATUS_INVALID_PARAMETER;
+    }
+    // 运行中但没有采集线程时无法开始推送
+    if (isRuning && !mAcqThread.joinable()) {
+        return TY_STATUS_BUSY;
+    }
+
+    std::shared_ptr<FrameCallbackEntry> entry = std::make_shared<FrameCallbackEntry>();
+    entry->cb = cb;
+    entry->executor = executor;
+    entry->max_in_flight = max_in_flight ? max_in_flight : 1;
+    entry->blocking = blocking;
+    entry->in_flight = 0;
+    entry->delivered = 0;
+    entry->skipped = 0;
+    entry->active = true;
+
+    std::lock_guard<std::mutex> lock(mCallbackLock);
+    entry->id = mNextCallbackId++;
+    std::shared_ptr<FrameCallbackList> list = std::make_shared<FrameCallbackList>(*std::atomic_load(&mCallbacks));
+    list->push_back(entry);
+    std::atomic_store(&mCallbacks, std::shared_ptr<const FrameCallbackList>(list));
+    return entry->id;
+}
+
+void FastCamera::unregisterFrameCallback(int id)
+{
+    std::shared_ptr<FrameCallbackEntry> entry;
+    {
+        std::lock_guard<std::mutex> lock(mCallbackLock);
+        std::shared_ptr<FrameCallbackList> list = std::make_shared<FrameCallbackList>(*std::atomic_load(&mCallbacks));
+        for (auto it = list->begin(); it != list->end(); ++it) {
+            if ((*it)->id == id) {
+                entry = *it;
+                list->erase(it);
+                break;
+            }
+        }
+        if (!entry) {
+            return;
+        }
+        std::atomic_store(&mCallbacks, std::shared_ptr<const FrameCallbackList>(list));
+    }
+
+    // 采集线程可能仍持有旧列表，active置位后不会再投递
+    std::unique_lock<std::mutex> lock(entry->lock);
+    entry->active = false;
+    entry->idle.notify_all();
+    // 在采集线程或该回调内部注销时，调用方本身就计在在途数中，不能等待
+    if (std::this_thread::get_id() == mAcqThread.get_id() || tCurrentCallback == entry.get()) {
+        return;
+    }
+    entry->idle.wait(lock, [&entry] { return entry->in_flight.load() == 0; });
+}
+
+FastCamera::FrameCallbackStats FastCamera::frameCallbackStats(int id)
+{
+    FrameCallbackStats stats = {0, 0, 0};
+    std::shared_ptr<const FrameCallbackList> list = std::atomic_load(&mCallbacks);
+    for (const auto& entry : *list) {
+        if (entry->id == id) {
+            stats.delivered = entry->delivered.load();
+            stats.skipped = entry->skipped.load();
+            stats.in_flight = entry->in_flight.load();
+            break;
+        }
+    }
+    return stats;
+}
+
+void FastCamera::finishCallback(FrameCallbackEntry* entry)
+{
+    // 唤醒等待空位的采集线程或等待注销的线程
+    std::lock_guard<std::mutex> lock(entry->lock);
+    entry->in_flight--;
+    entry->idle.notify_all();
+}
+
+void FastCamera::dispatchFrame(const std::shared_ptr<TYFrame>& frame)
+{
+    std::shared_ptr<const FrameCallbackList> list = std::atomic_load(&mCallbacks);
+    for (const auto& entry : *list) {
+        if (entry->in_flight.load() >= entry->max_in_flight) {
+            if (!entry->blocking) {
+                entry->skipped++;
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(entry->lock);
+            entry->idle.wait(lock, [this, &entry] {
+                return !mAcqRunning || !entry->active ||
+                       entry->in_flight.load() < entry->max_in_flight;
+            });
+            if (!mAcqRunning || !entry->active) {
+                continue;
+            }
+        }
+
+        // 在锁内检查active并计入在途，保证注销返回后不会再有新的投递
+        {
+            std::lock_guard<std::mutex> lock(entry->lock);
+            if (!entry->active) {
+                continue;
+            }
+            entry->in_flight++;
+        }
+        entry->delivered++;
+
+        if (!entry->executor) {
+            {
+                CallbackScope scope(entry.get());
+                entry->cb(frame);
+            }
+            finishCallback(entry.get());
+        } else {
+            std::shared_ptr<FrameCallbackEntry> e = entry;
+            std::shared_ptr<TYFrame> f = frame;
+            entry->executor([e, f] {
+                {
+                    CallbackScope scope(e.get());
+                    e->cb(f);
+                }
+                finishCallback(e.get());
+            });
+        }
+    }
+}
+
 TY_STATUS FastCamera::setIfaceId(const char* inf)
 {
     if (inf) {
@@ -350,4 +678,241 @@ TY_STATUS FastCamera::setIfaceId(const char* inf)
     return TY_STATUS_INVALID_PARAMETER;
 }
 
+void FastCamera::RegisterOfflineEventCallback(EventCallback cb, void* data)
+{
+    std::lock_guard<std::mutex> lock(_dev_lock);
+    mOfflineCallback = cb;
+    mOfflineData = data;
+}
+
+void FastCamera::attachDevice()
+{
+    // 调用方持有_dev_lock；device只在持有该锁时写入，这里可以直接读取
+    auto info = device->getDeviceInfo();
+    mSerial = info->info().serialNumber;
+    const char* ip = info->ip();
+    mIP = ip ? ip : "";
+    mOffline = false;
+
+    device->registerEventCallback(TY_EVENT_DEVICE_OFFLINE, this, [this](void*) {
+        {
+            std::lock_guard<std::mutex> lock(mReconnectLock);
+            mOfflineAt = Clock::now();
+            mNextAttempt = mOfflineAt;
+            mBackoff = mInitialBackoff;
+        }
+        mOffline = true;
+        if (mOfflineCallback) {
+            mOfflineCallback(mOfflineData);
+        }
+    });
+}
+
+void FastCamera::setAutoReconnect(bool enable, uint32_t initial_backoff_ms, uint32_t max_backoff_ms)
+{
+    std::lock_guard<std::mutex> lock(mReconnectLock);
+    mAutoReconnect = enable;
+    mInitialBackoff = initial_backoff_ms ? initial_backoff_ms : 1;
+    mMaxBackoff = std::max(max_backoff_ms, mInitialBackoff);
+    mBackoff = mInitialBackoff;
+}
+
+FastCamera::ReconnectStats FastCamera::reconnectStats() const
+{
+    std::lock_guard<std::mutex> lock(mReconnectLock);
+    return mReconnectStats;
+}
+
+bool FastCamera::tryReconnect(uint32_t max_wait_ms)
+{
+    Clock::time_point next;
+    {
+        std::lock_guard<std::mutex> lock(mReconnectLock);
+        next = mNextAttempt;
+    }
+
+    // 未到重试时间时等待，不在取帧循环中空转
+    Clock::time_point now = Clock::now();
+    if (now < next) {
+        Clock::duration wait = std::min<Clock::duration>(next - now, std::chrono::milliseconds(max_wait_ms));
+        std::this_thread::sleep_for(wait);
+        if (Clock::now() < next) {
+            return false;
+        }
+    }
+
+    TY_STATUS status = reopen();
+
+    std::lock_guard<std::mutex> lock(mReconnectLock);
+    mReconnectStats.attempts++;
+    if (status != TY_STATUS_OK) {
+        std::cout << "FastCamera: reconnect " << mSerial << " failed: " << status << "(" << TYErrorString(status) << "), retry in " << mBackoff << "ms" << std::endl;
+        mNextAttempt = Clock::now() + std::chrono::milliseconds(mBackoff);
+        mBackoff = std::min(mBackoff * 2, mMaxBackoff);
+        return false;
+    }
+
+    mReconnectStats.reconnects++;
+    mReopenedAt = Clock::now();
+    mAwaitFirstFrame = true;
+    mBackoff = mInitialBackoff;
+    return true;
+}
+
+TY_STATUS FastCamera::reopen()
+{
+    {
+        // 旧句柄已失效；只解除缓冲区与设备的绑定，内存保留给新句柄
+        std::lock_guard<std::mutex> lock(_dev_lock);
+        mPool->detach();
+        std::atomic_store(&device, std::shared_ptr<TYDevice>());
+    }
+
+    // 先用注册表中的缓存直接打开，失败时open()会重新枚举
+    TY_STATUS status = TY_STATUS_ERROR;
+    if (!mSerial.empty()) {
+        status = open(mSerial.c_str());
+    }
+    if (status != TY_STATUS_OK && !mIP.empty()) {
+        status = openByIP(mIP.c_str());
+    }
+    if (status != TY_STATUS_OK) {
+        return status;
+    }
+
+    status = restoreState();
+    if (status != TY_STATUS_OK) {
+        // 恢复失败时放弃本次打开，下次重试从头开始
+        std::lock_guard<std::mutex> lock(_dev_lock);
+        mPool->detach();
+        std::atomic_store(&device, std::shared_ptr<TYDevice>());
+        mOffline = true;
+    }
+    return status;
+}
+
+TY_STATUS FastCamera::restoreState()
+{
+    // 重新打开后可能已被close()释放
+    std::shared_ptr<TYDevice> dev = std::atomic_load(&device);
+    if (!dev) {
+        return TY_STATUS_INVALID_HANDLE;
+    }
+    TY_DEV_HANDLE handle = dev->_handle;
+
+    // 所有分量一次调用启用
+    TY_COMPONENT_ID mask = componentMask();
+    TY_STATUS status = TY_STATUS_OK;
+    if (mask) {
+        status = TYEnableComponents(handle, mask);
+        if (status != TY_STATUS_OK) {
+            return status;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mFeatureLock);
+        for (const auto& record : mFeatures) {
+            status = applyFeature(handle, record);
+            if (status != TY_STATUS_OK) {
+                return status;
+            }
+        }
+    }
+
+    if (!isRuning) {
+        return TY_STATUS_OK;
+    }
+
+    // 分辨率未变时缓冲区直接复用，只需重新入队
+    status = mPool->prepare(handle);
+    if (status != TY_STATUS_OK) {
+        return status;
+    }
+    return TYStartCapture(handle);
+}
+
+TY_STATUS FastCamera::applyFeature(TY_DEV_HANDLE handle, const FeatureRecord& record)
+{
+    switch (record.type) {
+        case FeatureInt:
+            return TYSetInt(handle, record.comp, record.feat, record.i);
+        case FeatureFloat:
+            return TYSetFloat(handle, record.comp, record.feat, record.f);
+        case FeatureEnum:
+            return TYSetEnum(handle, record.comp, record.feat, record.e);
+        case FeatureBool:
+            return TYSetBool(handle, record.comp, record.feat, record.b);
+    }
+    return TY_STATUS_INVALID_PARAMETER;
+}
+
+void FastCamera::recordFeature(const FeatureRecord& record)
+{
+    std::lock_guard<std::mutex> lock(mFeatureLock);
+    for (auto& r : mFeatures) {
+        if (r.comp == record.comp && r.feat == record.feat) {
+            r = record;
+            return;
+        }
+    }
+    mFeatures.push_back(record);
+}
+
+TY_STATUS FastCamera::setInt(TY_COMPONENT_ID comp, TY_FEATURE_ID feat, int32_t value)
+{
+    std::shared_ptr<TYDevice> dev = std::atomic_load(&device);
+    if (!dev) {
+        return TY_STATUS_INVALID_HANDLE;
+    }
+    FeatureRecord record = {comp, feat, FeatureInt, value, 0.f, 0, false};
+    TY_STATUS status = applyFeature(dev->_handle, record);
+    if (status == TY_STATUS_OK) {
+        recordFeature(record);
+    }
+    return status;
+}
+
+TY_STATUS FastCamera::setFloat(TY_COMPONENT_ID comp, TY_FEATURE_ID feat, float value)
+{
+    std::shared_ptr<TYDevice> dev = std::atomic_load(&device);
+    if (!dev) {
+        return TY_STATUS_INVALID_HANDLE;
+    }
+    FeatureRecord record = {comp, feat, FeatureFloat, 0, value, 0, false};
+    TY_STATUS status = applyFeature(dev->_handle, record);
+    if (status == TY_STATUS_OK) {
+        recordFeature(record);
+    }
+    return status;
+}
+
+TY_STATUS FastCamera::setEnum(TY_COMPONENT_ID comp, TY_FEATURE_ID feat, uint32_t value)
+{
+    std::shared_ptr<TYDevice> dev = std::atomic_load(&device);
+    if (!dev) {
+        return TY_STATUS_INVALID_HANDLE;
+    }
+    FeatureRecord record = {comp, feat, FeatureEnum, 0, 0.f, value, false};
+    TY_STATUS status = applyFeature(dev->_handle, record);
+    if (status == TY_STATUS_OK) {
+        recordFeature(record);
+    }
+    return status;
+}
+
+TY_STATUS FastCamera::setBool(TY_COMPONENT_ID comp, TY_FEATURE_ID feat, bool value)
+{
+    std::shared_ptr<TYDevice> dev = std::atomic_load(&device);
+    if (!dev) {
+        return TY_STATUS_INVALID_HANDLE;
+    }
+    FeatureRecord record = {comp, feat, FeatureBool, 0, 0.f, 0, value};
+    TY_STATUS status = applyFeature(dev->_handle, record);
+    if (status == TY_STATUS_OK) {
+        recordFeature(record);
+    }
+    return status;
+}
+
 }
\ No newline at end of file
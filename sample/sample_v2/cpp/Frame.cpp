@@ -12,10 +12,10 @@
 
 namespace percipio_layer {
 // 前向声明函数，避免循环依赖
-int parseIrFrame(const TY_IMAGE_DATA* img, funny_Mat* pIr);
-int parseColorFrame(const TY_IMAGE_DATA* img, funny_Mat* pColor, TY_ISP_HANDLE color_isp_handle);
-int parseImage(const TY_IMAGE_DATA* img, funny_Mat* image, TY_ISP_HANDLE color_isp_handle);
-int parseDepthFrame(const TY_IMAGE_DATA* img, funny_Mat* pDepth);
+int parseIrFrame(const TY_IMAGE_DATA* img, funny_Mat* pIr, bool copy);
+int parseColorFrame(const TY_IMAGE_DATA* img, funny_Mat* pColor, TY_ISP_HANDLE color_isp_handle, bool copy);
+int parseImage(const TY_IMAGE_DATA* img, funny_Mat* image, TY_ISP_HANDLE color_isp_handle, bool copy);
+int parseDepthFrame(const TY_IMAGE_DATA* img, funny_Mat* pDepth, bool copy);
 }
 
 #include "../common/common.hpp"        // 添加common头文件
@@ -28,13 +28,18 @@ namespace percipio_layer {
 
 bool TYImage::resize(int w, int h)
 {
-    // 无论是否定义了OPENCV_DEPENDENCIES，都使用funny_resize函数
+    // 无论是否定义了OPENCV_DEPENDENCIES，都使用funny_resize函数(采样表按尺寸缓存，按行带并行)
     if (!buffer() || w <= 0 || h <= 0) {
         return false;
     }
 
     int32_t new_size = 0;
     void* new_buffer = nullptr;
+    // 原缓冲区在本函数结束前保持有效；新缓冲区由本图像持有
+    std::shared_ptr<void> old_keeper = _keeper;
+    // 缩小时用区域平均避免混叠，放大时用双线性
+    const InterpolationMethod smooth = (w <= width() && h <= height()) ?
+        InterpolationMethod::AREA : InterpolationMethod::LINEAR;
     
     // 根据图像格式计算新的大小并分配内存
     switch(image_data.pixelFormat)
@@ -44,27 +49,24 @@ bool TYImage::resize(int w, int h)
             new_size = w * h * 3; // 3通道8位图像
             new_buffer = malloc(new_size);
             if (new_buffer) {
-                // 使用双线性插值
                 funny_resize(width(), height(), static_cast<const uint8_t*>(buffer()), 3,
-                             w, h, static_cast<uint8_t*>(new_buffer), InterpolationMethod::LINEAR);
+                             w, h, static_cast<uint8_t*>(new_buffer), smooth, true);
             }
             break;
         case TY_PIXEL_FORMAT_MONO:
             new_size = w * h; // 单通道8位图像
             new_buffer = malloc(new_size);
             if (new_buffer) {
-                // 使用双线性插值
                 funny_resize(width(), height(), static_cast<const uint8_t*>(buffer()), 1,
-                             w, h, static_cast<uint8_t*>(new_buffer), InterpolationMethod::LINEAR);
+                             w, h, static_cast<uint8_t*>(new_buffer), smooth, true);
             }
             break;
         case TY_PIXEL_FORMAT_MONO16:
             new_size = w * h * 2; // 单通道16位图像
             new_buffer = malloc(new_size);
             if (new_buffer) {
-                // 使用双线性插值
                 funny_resize_16bit(width(), height(), static_cast<const uint16_t*>(buffer()),
-                                   w, h, static_cast<uint16_t*>(new_buffer), InterpolationMethod::LINEAR);
+                                   w, h, static_cast<uint16_t*>(new_buffer), smooth, true);
             }
             break;
         case TY_PIXEL_FORMAT_BGR48:
@@ -72,34 +74,9 @@ bool TYImage::resize(int w, int h)
             new_size = w * h * 6; // 3通道16位图像
             new_buffer = malloc(new_size);
             if (new_buffer) {
-                // BGR48/RGB48格式需要特殊处理，这里简化处理
-                // 实际应用中可能需要根据具体格式调整
-                std::cout << "Warning: BGR48/RGB48 resize may not be fully supported!" << std::endl;
-                
-                // 对于多通道16位图像，我们需要逐通道处理
-                const uint16_t* src_data = static_cast<const uint16_t*>(buffer());
-                uint16_t* dst_data = static_cast<uint16_t*>(new_buffer);
-                
-                // 临时单通道缓冲区
-                std::vector<uint16_t> temp_src(width() * height());
-                std::vector<uint16_t> temp_dst(w * h);
-                
-                // 分别处理每个通道
-                for (int c = 0; c < 3; c++) {
-                    // 提取单个通道
-                    for (int i = 0; i < width() * height(); i++) {
-                        temp_src[i] = src_data[i * 3 + c];
-                    }
-                    
-                    // 对单个通道进行resize
-                    funny_resize_16bit(width(), height(), temp_src.data(),
-                                      w, h, temp_dst.data(), InterpolationMethod::LINEAR);
-                    
-                    // 放回目标图像
-                    for (int i = 0; i < w * h; i++) {
-                        dst_data[i * 3 + c] = temp_dst[i];
-                    }
-                }
+                // 按交错的3通道直接插值，通道顺序不影响结果
+                funny_resize_16bit(width(), height(), static_cast<const uint16_t*>(buffer()), 3,
+                                   w, h, static_cast<uint16_t*>(new_buffer), smooth, true);
             }
             break;
         case TY_PIXEL_FORMAT_DEPTH16:
@@ -108,7 +85,7 @@ bool TYImage::resize(int w, int h)
             if (new_buffer) {
                 // 深度图通常使用最近邻插值
                 funny_resize_16bit(width(), height(), static_cast<const uint16_t*>(buffer()),
-                                   w, h, static_cast<uint16_t*>(new_buffer), InterpolationMethod::NEAREST);
+                                   w, h, static_cast<uint16_t*>(new_buffer), InterpolationMethod::NEAREST, true);
             }
             break;
         default:
@@ -118,15 +95,11 @@ bool TYImage::resize(int w, int h)
     
     // 更新图像数据
     if (new_buffer) {
-        // 暂时注释掉m_isOwner相关代码，因为编译器报错未声明
-        /*if (m_isOwner && image_data.buffer) {
-            free(image_data.buffer);
-        }*/
+        _keeper = std::shared_ptr<void>(new_buffer, free);
         image_data.buffer = new_buffer;
         image_data.size = new_size;
         image_data.width = w;
         image_data.height = h;
-        // m_isOwner = true; // 现在我们拥有这个缓冲区
         return true;
     }
     
@@ -143,7 +116,12 @@ TYImage::TYImage(const TY_IMAGE_DATA& image) {
     memcpy(&image_data, &image, sizeof(TY_IMAGE_DATA));
 }
 
-TYImage::TYImage(const TYImage& src) {
+TYImage::TYImage(const TY_IMAGE_DATA& image, std::shared_ptr<void> keeper)
+    : _keeper(std::move(keeper)) {
+    memcpy(&image_data, &image, sizeof(TY_IMAGE_DATA));
+}
+
+TYImage::TYImage(const TYImage& src) : _keeper(src._keeper) {
     memcpy(&image_data, &src.image_data, sizeof(TY_IMAGE_DATA));
 }
 
@@ -156,12 +134,13 @@ TYImage::TYImage(int32_t width, int32_t height, TY_COMPONENT_ID compID, TY_PIXEL
     image_data.size = size;
     if (size > 0) {
         image_data.buffer = malloc(size);
+        _keeper = std::shared_ptr<void>(image_data.buffer, free);
     }
 }
 
 // TYImage 析构函数实现
 TYImage::~TYImage() {
-    // 暂时不释放缓冲区，因为我们无法确定所有权
+    // 自行分配的缓冲区随_keeper释放，外部缓冲区不归本对象管理
     image_data.buffer = nullptr;
 }
 
@@ -170,35 +149,73 @@ TYFrame::TYFrame(const TY_FRAME_DATA& frame) {
     // 保存缓冲区信息
     bufferSize = frame.bufferSize;
     if (frame.userBuffer && frame.bufferSize > 0) {
-        userBuffer.resize(frame.bufferSize);
-        memcpy(userBuffer.data(), frame.userBuffer, frame.bufferSize);
+        userBuffer = std::make_shared<std::vector<uint8_t>>(frame.bufferSize);
+        memcpy(userBuffer->data(), frame.userBuffer, frame.bufferSize);
+        // 图像指针需要重定位到副本中，原SDK缓冲区随后会被重新入队
+        parseImages(frame, userBuffer->data());
+    } else {
+        parseImages(frame, nullptr);
     }
-    
+}
+
+TYFrame::TYFrame(const TY_FRAME_DATA& frame, TYFrameBufferReleaser releaser) {
+    bufferSize = frame.bufferSize;
+    const int32_t size = frame.bufferSize;
+    // 帧和各图像(及其视图)共同持有，最后一个持有者释放时才归还SDK缓冲区
+    _lease = std::shared_ptr<void>(frame.userBuffer, [releaser, size](void* buffer) {
+        if (buffer && releaser) {
+            releaser(buffer, size);
+        }
+    });
+    parseImages(frame, nullptr);
+}
+
+void TYFrame::parseImages(const TY_FRAME_DATA& frame, uint8_t* base) {
+    const uint8_t* src_begin = static_cast<const uint8_t*>(frame.userBuffer);
+    const uint8_t* src_end = src_begin + frame.bufferSize;
+    // 图像持有缓冲区的所有者：拷贝模式为副本，租借模式为SDK缓冲区的租约
+    std::shared_ptr<void> keeper = userBuffer ? std::shared_ptr<void>(userBuffer) : _lease;
+
     // 遍历frame.image数组，查找并创建各种图像对象
     for (int i = 0; i < 10; i++) {
-        const TY_IMAGE_DATA& img = frame.image[i];
+        TY_IMAGE_DATA img = frame.image[i];
         
         // 检查图像数据是否有效
         if (img.buffer == nullptr || img.size == 0 || img.status != TY_STATUS_OK) {
             continue;
         }
+
+        if (_components == 0) {
+            _timestamp = img.timestamp;
+            _image_index = img.imageIndex;
+        }
+
+        // 拷贝模式下将图像指针换算到副本中的相同偏移
+        const uint8_t* p = static_cast<const uint8_t*>(img.buffer);
+        if (base && p >= src_begin && p + img.size <= src_end) {
+            img.buffer = base + (p - src_begin);
+        }
         
         // 根据componentID创建对应的图像对象
         switch (img.componentID) {
             case TY_COMPONENT_DEPTH_CAM:
-                _images[TY_COMPONENT_DEPTH_CAM] = std::make_shared<TYImage>(img);
+                _images[TY_COMPONENT_DEPTH_CAM] = std::make_shared<TYImage>(img, keeper);
+                _components |= TY_COMPONENT_DEPTH_CAM;
                 break;
                 
             case TY_COMPONENT_RGB_CAM:
-                _images[TY_COMPONENT_RGB_CAM] = std::make_shared<TYImage>(img);
+                _images[TY_COMPONENT_RGB_CAM] = std::make_shared<TYImage>(img, keeper);
+                _components |= TY_COMPONENT_RGB_CAM;
                 break;
                 
             case TY_COMPONENT_IR_CAM_LEFT:
-                _images[TY_COMPONENT_IR_CAM_LEFT] = std::make_shared<TYImage>(img);
+                _images[TY_COMPONENT_IR_CAM_LEFT] = std::make_shared<TYImage>(img, keeper);
+                _components |= TY_COMPONENT_IR_CAM_LEFT;
                 break;
                 
             case TY_COMPONENT_IR_CAM_RIGHT:
-                _images[TY_COMPONENT_IR_CAM_RIGHT] = std::make_shared<TYImage>(img);
+                _images[TY_COMPONENT_IR_CAM_RIGHT] = std::make_shared<TYImage>(img, keeper);
+                _components |= TY_COMPONENT_IR_CAM_RIGHT;
                 break;
                 
             default:
@@ -208,18 +225,56 @@ TYFrame::TYFrame(const TY_FRAME_DATA& frame) {
     }
 }
 
+TYFrame::TYFrame(const std::vector<std::shared_ptr<TYFrame>>& parts) {
+    for (const auto& part : parts) {
+        if (!part) {
+            continue;
+        }
+        for (const auto& iter : part->_images) {
+            if (!iter.second || _images[iter.first]) {
+                continue;
+            }
+            if (_components == 0) {
+                _timestamp = part->_timestamp;
+                _image_index = part->_image_index;
+            }
+            _images[iter.first] = iter.second;
+            _components |= iter.first;
+        }
+        _parts.push_back(part);
+    }
+}
+
+void TYFrame::release() {
+    // 组合帧：放弃对原帧的引用，最后一个引用释放时原帧归还各自的缓冲区
+    _parts.clear();
+    if (!_lease) {
+        return;
+    }
+    // 租借帧：放弃本帧对图像和缓冲区的引用，已取出的图像和视图释放后缓冲区才归还
+    _images.clear();
+    _lease.reset();
+}
+
 // TYFrame 析构函数实现
 TYFrame::~TYFrame() {
     // 清理资源
     _images.clear();
+    // 租借模式下归还SDK缓冲区
+    release();
 }
 
 
 TYFrameParser::TYFrameParser(uint32_t max_queue_size, const TY_ISP_HANDLE isp_handle)
+    : _max_queue_size(max_queue_size ? max_queue_size : 1)
+    , _drop_policy(DropOldest)
+    , _dropped(0)
+    , _parallel(false)
+    , _pool(nullptr)
+    , isRuning(true)
+    , user_data(nullptr)
+    , func_keyboard_event(nullptr)
 {
-    _max_queue_size = max_queue_size;
-    isRuning = true;
-
     setImageProcesser(TY_COMPONENT_DEPTH_CAM, std::shared_ptr<ImageProcesser>(new ImageProcesser("depth")));
     setImageProcesser(TY_COMPONENT_IR_CAM_LEFT, std::shared_ptr<ImageProcesser>(new ImageProcesser("Left-IR")));
     setImageProcesser(TY_COMPONENT_IR_CAM_RIGHT, std::shared_ptr<ImageProcesser>(new ImageProcesser("Right-IR")));
@@ -230,8 +285,33 @@ TYFrameParser::TYFrameParser(uint32_t max_queue_size, const TY_ISP_HANDLE isp_ha
 
 TYFrameParser::~TYFrameParser()
 {
-    isRuning = false;
-    processThread_.join();
+    stop();
+}
+
+void TYFrameParser::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(_queue_lock);
+        isRuning = false;
+        // 未处理的帧直接释放，租借的缓冲区随之归还
+        std::queue<std::shared_ptr<TYFrame>>().swap(images);
+    }
+    _queue_not_empty.notify_all();
+    _queue_not_full.notify_all();
+
+    if (processThread_.joinable()) {
+        processThread_.join();
+    }
+}
+
+void TYFrameParser::setDropPolicy(DropPolicy policy)
+{
+    {
+        std::lock_guard<std::mutex> lock(_queue_lock);
+        _drop_policy = policy;
+    }
+    // 从DropNone切换出来时唤醒阻塞的update()
+    _queue_not_full.notify_all();
 }
 
 int TYFrameParser::setImageProcesser(TY_COMPONENT_ID id, std::shared_ptr<ImageProcesser> proc)
@@ -240,6 +320,14 @@ int TYFrameParser::setImageProcesser(TY_COMPONENT_ID id, std::shared_ptr<ImagePr
     return 0;
 }
 
+void TYFrameParser::setParallelProcess(bool enable, TYWorkerPool* pool)
+{
+    // 由display线程在两帧之间读取，切换时持有队列锁
+    std::lock_guard<std::mutex> lock(_queue_lock);
+    _parallel = enable;
+    _pool = pool;
+}
+
 int TYFrameParser::doProcess(const std::shared_ptr<TYFrame>& img)
 {
     auto depth = img->depthImage();
@@ -247,88 +335,155 @@ int TYFrameParser::doProcess(const std::shared_ptr<TYFrame>& img)
     auto left_ir = img->leftIRImage();
     auto right_ir = img->rightIRImage();
 
+    std::pair<ImageProcesser*, std::shared_ptr<TYImage>> jobs[4];
+    int count = 0;
+
     if (left_ir) {
-        stream[TY_COMPONENT_IR_CAM_LEFT]->parse(left_ir);
+        jobs[count++] = std::make_pair(stream[TY_COMPONENT_IR_CAM_LEFT].get(), left_ir);
     }
 
     if (right_ir) {
-        stream[TY_COMPONENT_IR_CAM_RIGHT]->parse(right_ir);
+        jobs[count++] = std::make_pair(stream[TY_COMPONENT_IR_CAM_RIGHT].get(), right_ir);
     }
 
     if (color) {
-        stream[TY_COMPONENT_RGB_CAM]->parse(color);
+        jobs[count++] = std::make_pair(stream[TY_COMPONENT_RGB_CAM].get(), color);
     }
 
     if (depth) {
-        stream[TY_COMPONENT_DEPTH_CAM]->parse(depth);
+        jobs[count++] = std::make_pair(stream[TY_COMPONENT_DEPTH_CAM].get(), depth);
     }
+
+    bool parallel;
+    TYWorkerPool* pool;
+    {
+        std::lock_guard<std::mutex> lock(_queue_lock);
+        parallel = _parallel;
+        pool = _pool ? _pool : &TYWorkerPool::shared();
+    }
+
+    if (!parallel || count < 2) {
+        for (int i = 0; i < count; i++) {
+            if (jobs[i].first) jobs[i].first->parse(jobs[i].second);
+        }
+        return 0;
+    }
+
+    // 各分量互不依赖：除第一个外提交到线程池，第一个在当前线程执行，最后等待全部完成
+    TYTaskGroup group(*pool);
+    for (int i = 1; i < count; i++) {
+        ImageProcesser* proc = jobs[i].first;
+        std::shared_ptr<TYImage> image = jobs[i].second;
+        if (proc) {
+            group.run([proc, image] { proc->parse(image); });
+        }
+    }
+    if (jobs[0].first) jobs[0].first->parse(jobs[0].second);
+    group.wait();
     return 0;
 }
 
 void TYFrameParser::display()
 {
-    int ret = 0;
-    while(isRuning) {
-        if(images.size()) {
+    for (;;) {
+        std::shared_ptr<TYFrame> img;
+        TYFrameKeyBoardEventCallback cb = nullptr;
+        void* data = nullptr;
+        {
+            // 无帧时在条件变量上休眠，不再空转占满一个核
             std::unique_lock<std::mutex> lock(_queue_lock);
-            std::shared_ptr<TYFrame> img = images.front();
-
-            if(img) {
-                images.pop();
-                doProcess(img);
+            _queue_not_empty.wait(lock, [this] { return !isRuning || !images.empty(); });
+            if (!isRuning) {
+                break;
             }
+            img = images.front();
+            images.pop();
+            cb = func_keyboard_event;
+            data = user_data;
         }
+        _queue_not_full.notify_one();
 
-        for(auto& iter : stream) {
-            ret = iter.second->show();
-            // 跳过键盘事件回调，避免编译错误
-                if(ret > 0) {
-                    // 键盘事件回调被暂时禁用
-                }
+        // 在锁外处理，update()不会被耗时的处理阻塞
+        if (img) {
+            doProcess(img);
         }
-    }
-}
 
-inline void TYFrameParser::ImageQueueSizeCheck()
-{
-    while(images.size() >= _max_queue_size)
-        images.pop();
+        // 只有新帧到达时才刷新显示
+        for (auto& iter : stream) {
+            int ret = iter.second->show();
+            if (ret > 0 && cb) {
+                cb(ret, data);
+            }
+        }
+    }
 }
 
 void TYFrameParser::update(const std::shared_ptr<TYFrame>& frame)
 {
-    std::unique_lock<std::mutex> lock(_queue_lock);
-    if(frame) {
-        ImageQueueSizeCheck();
-        images.push(frame);
-#ifndef OPENCV_DEPENDENCIES        
-        auto depth = frame->depthImage();
-        auto color = frame->colorImage();
-        auto left_ir = frame->leftIRImage();
-        auto right_ir = frame->rightIRImage();
-
-        if (left_ir) {
-            auto image = left_ir;
-            std::cout << "Left" << " image size : " << image->width() << " x " << image->height() << std::endl;
-        }
+    if (!frame) {
+        return;
+    }
 
-        if (right_ir) {
-            auto image = right_ir;
-            std::cout << "Right" << " image size : " << image->width() << " x " << image->height() << std::endl;
-        }
+#ifndef OPENCV_DEPENDENCIES
+    // 入队前打印，入队后显示线程会同时处理该帧
+    auto depth = frame->depthImage();
+    auto color = frame->colorImage();
+    auto left_ir = frame->leftIRImage();
+    auto right_ir = frame->rightIRImage();
 
-        if (color) {
-            auto image = color;
-            std::cout << "Color" << " image size : " << image->width() << " x " << image->height() << std::endl;
-        }
+    if (left_ir) {
+        auto image = left_ir;
+        std::cout << "Left" << " image size : " << image->width() << " x " << image->height() << std::endl;
+    }
 
-        if (depth) {
-            auto image = depth;
-            std::cout << "Depth" << " image size : " << image->width() << " x " << image->height() << std::endl;
-        }
+    if (right_ir) {
+        auto image = right_ir;
+        std::cout << "Right" << " image size : " << image->width() << " x " << image->height() << std::endl;
+    }
+
+    if (color) {
+        auto image = color;
+        std::cout << "Color" << " image size : " << image->width() << " x " << image->height() << std::endl;
+    }
+
+    if (depth) {
+        auto image = depth;
+        std::cout << "Depth" << " image size : " << image->width() << " x " << image->height() << std::endl;
+    }
 
 #endif
+
+    {
+        std::unique_lock<std::mutex> lock(_queue_lock);
+        if (!isRuning) {
+            return;
+        }
+
+        if (images.size() >= _max_queue_size) {
+            switch (_drop_policy) {
+            case DropNewest:
+                _dropped++;
+                return;
+            case DropNone:
+                _queue_not_full.wait(lock, [this] {
+                    return !isRuning || _drop_policy != DropNone || images.size() < _max_queue_size;
+                });
+                if (!isRuning) {
+                    return;
+                }
+                break;
+            case DropOldest:
+            default:
+                break;
+            }
+            while (images.size() >= _max_queue_size) {
+                images.pop();
+                _dropped++;
+            }
+        }
+        images.push(frame);
     }
+    _queue_not_empty.notify_one();
 }
 
 // ImageProcesser类方法实现
@@ -0,0 +1,151 @@
+#include "../hpp/FrameAssembler.hpp"
+
+#include <cstring>
+
+namespace percipio_layer {
+
+FrameAssembler::FrameAssembler(TY_COMPONENT_ID components, MatchKey key)
+    : _expected(components), _match(key), _tolerance_us(1000)
+    , _deadline(std::chrono::milliseconds(100)), _emit_partial(true), _max_pending(4)
+{
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+uint64_t FrameAssembler::keyOf(const std::shared_ptr<TYFrame>& frame) const
+{
+    if (_match == MatchImageIndex) {
+        return static_cast<uint32_t>(frame->imageIndex());
+    }
+    return frame->timestamp();
+}
+
+bool FrameAssembler::matches(uint64_t a, uint64_t b) const
+{
+    if (_match == MatchImageIndex) {
+        return a == b;
+    }
+    return (a > b ? a - b : b - a) <= _tolerance_us;
+}
+
+void FrameAssembler::emit(Group& group, bool complete, std::vector<std::shared_ptr<TYFrame>>& out)
+{
+    _recent.push_back(group.key);
+    while (_recent.size() > _max_pending * 2) {
+        _recent.pop_front();
+    }
+
+    if (!complete && !_emit_partial) {
+        _stats.expired++;
+        return;
+    }
+
+    if (complete) {
+        _stats.complete++;
+    } else {
+        _stats.partial++;
+    }
+    // 只有一个分量时无需再包一层
+    if (group.parts.size() == 1) {
+        out.push_back(group.parts[0]);
+    } else {
+        out.push_back(std::make_shared<TYFrame>(group.parts));
+    }
+}
+
+void FrameAssembler::expire(const Clock::time_point& now, std::vector<std::shared_ptr<TYFrame>>& out)
+{
+    while (!_groups.empty() && now - _groups.front().first_arrival >= _deadline) {
+        emit(_groups.front(), false, out);
+        _groups.pop_front();
+    }
+}
+
+void FrameAssembler::push(const std::shared_ptr<TYFrame>& part, std::vector<std::shared_ptr<TYFrame>>& out)
+{
+    if (!part || part->components() == 0) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(_lock);
+    Clock::time_point now = Clock::now();
+    uint64_t key = keyOf(part);
+    TY_COMPONENT_ID comps = part->components() & _expected;
+    if (comps == 0) {
+        return;
+    }
+
+    for (auto it = _groups.begin(); it != _groups.end(); ++it) {
+        if (!matches(it->key, key) || (it->have & comps)) {
+            continue;
+        }
+        it->have |= comps;
+        it->parts.push_back(part);
+        if ((it->have & _expected) == _expected) {
+            emit(*it, true, out);
+            _groups.erase(it);
+        }
+        expire(now, out);
+        return;
+    }
+
+    // 所属帧已经输出(完整或超时)，迟到的分量直接丢弃
+    for (auto recent : _recent) {
+        if (matches(recent, key)) {
+            _stats.late++;
+            expire(now, out);
+            return;
+        }
+    }
+
+    Group group;
+    group.key = key;
+    group.have = comps;
+    group.first_arrival = now;
+    group.parts.push_back(part);
+
+    if ((comps & _expected) == _expected) {
+        emit(group, true, out);
+    } else {
+        // 等待的帧组过多时，最旧的帧组提前结束
+        while (_groups.size() >= _max_pending) {
+            emit(_groups.front(), false, out);
+            _groups.pop_front();
+        }
+        _groups.push_back(std::move(group));
+    }
+    expire(now, out);
+}
+
+void FrameAssembler::poll(std::vector<std::shared_ptr<TYFrame>>& out)
+{
+    std::lock_guard<std::mutex> lock(_lock);
+    expire(Clock::now(), out);
+}
+
+void FrameAssembler::flush(std::vector<std::shared_ptr<TYFrame>>& out)
+{
+    std::lock_guard<std::mutex> lock(_lock);
+    bool emit_partial = _emit_partial;
+    // 主动请求时总是输出
+    _emit_partial = true;
+    while (!_groups.empty()) {
+        emit(_groups.front(), false, out);
+        _groups.pop_front();
+    }
+    _emit_partial = emit_partial;
+}
+
+void FrameAssembler::reset()
+{
+    std::lock_guard<std::mutex> lock(_lock);
+    _groups.clear();
+    _recent.clear();
+}
+
+FrameAssembler::Stats FrameAssembler::stats() const
+{
+    std::lock_guard<std::mutex> lock(_lock);
+    return _stats;
+}
+
+}
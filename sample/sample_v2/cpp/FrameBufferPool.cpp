@@ -0,0 +1,295 @@
+#include "../hpp/FrameBufferPool.hpp"
+
+#include <cstdlib>
+#include <iostream>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <malloc.h>
+#else
+#include <sys/mman.h>
+#endif
+
+namespace percipio_layer {
+
+static inline size_t alignUp(size_t size, size_t align)
+{
+    return (size + align - 1) / align * align;
+}
+
+FrameBufferPool::FrameBufferPool(uint32_t count, uint32_t flags)
+    : _handle(nullptr), _count(count), _flags(flags), _buffer_size(0)
+    , _queued(0), _in_flight(0), _starved(0), _allocations(0)
+{
+}
+
+FrameBufferPool::~FrameBufferPool()
+{
+    detach();
+    for (auto& block : _blocks) {
+        freeBlock(block);
+    }
+    for (auto& block : _retired) {
+        freeBlock(block);
+    }
+}
+
+void FrameBufferPool::setBufferCount(uint32_t count)
+{
+    std::lock_guard<std::mutex> guard(_lock);
+    _count = count;
+}
+
+void FrameBufferPool::setMemoryFlags(uint32_t flags)
+{
+    std::lock_guard<std::mutex> guard(_lock);
+    _flags = flags;
+}
+
+bool FrameBufferPool::allocBlock(Block& block, size_t size)
+{
+    block.ptr = nullptr;
+    block.alloc_size = alignUp(size, kAlignment);
+    block.mapped = false;
+    block.locked = false;
+    block.flags = _flags;
+    block.state = BLOCK_IDLE;
+
+#ifdef _WIN32
+    if (_flags & MEM_HUGE_PAGES) {
+        // 大页需要SeLockMemoryPrivilege权限，失败时退回普通分配
+        SIZE_T large = GetLargePageMinimum();
+        if (large > 0) {
+            SIZE_T alloc_size = alignUp(size, large);
+            block.ptr = VirtualAlloc(NULL, alloc_size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+            if (block.ptr) {
+                block.alloc_size = alloc_size;
+                block.mapped = true;
+            }
+        }
+    }
+    if (!block.ptr) {
+        block.ptr = _aligned_malloc(block.alloc_size, kAlignment);
+    }
+    if (block.ptr && (_flags & MEM_LOCKED)) {
+        block.locked = VirtualLock(block.ptr, block.alloc_size) != 0;
+    }
+#else
+    if (_flags & MEM_HUGE_PAGES) {
+#ifdef MAP_HUGETLB
+        const size_t kHugePage = 2 * 1024 * 1024;
+        size_t alloc_size = alignUp(size, kHugePage);
+        void* p = mmap(NULL, alloc_size, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED) {
+            block.ptr = p;
+            block.alloc_size = alloc_size;
+            block.mapped = true;
+        }
+#endif
+    }
+    if (!block.ptr) {
+        if (posix_memalign(&block.ptr, kAlignment, block.alloc_size) != 0) {
+            block.ptr = nullptr;
+        }
+#ifdef MADV_HUGEPAGE
+        // 没有预留大页时，交给透明大页处理
+        else if (_flags & MEM_HUGE_PAGES) {
+            madvise(block.ptr, block.alloc_size, MADV_HUGEPAGE);
+        }
+#endif
+    }
+    if (block.ptr && (_flags & MEM_LOCKED)) {
+        block.locked = mlock(block.ptr, block.alloc_size) == 0;
+    }
+#endif
+
+    if (!block.ptr) {
+        std::cout << "Failed to allocate frame buffer of " << size << " bytes" << std::endl;
+        return false;
+    }
+    if ((_flags & MEM_LOCKED) && !block.locked) {
+        std::cout << "Warning: frame buffer could not be locked in memory" << std::endl;
+    }
+    _allocations++;
+    return true;
+}
+
+void FrameBufferPool::freeBlock(Block& block)
+{
+    if (!block.ptr) {
+        return;
+    }
+#ifdef _WIN32
+    if (block.locked) {
+        VirtualUnlock(block.ptr, block.alloc_size);
+    }
+    if (block.mapped) {
+        VirtualFree(block.ptr, 0, MEM_RELEASE);
+    } else {
+        _aligned_free(block.ptr);
+    }
+#else
+    if (block.locked) {
+        munlock(block.ptr, block.alloc_size);
+    }
+    if (block.mapped) {
+        munmap(block.ptr, block.alloc_size);
+    } else {
+        free(block.ptr);
+    }
+#endif
+    block.ptr = nullptr;
+}
+
+FrameBufferPool::Block* FrameBufferPool::findBlock(void* buffer, bool* retired)
+{
+    *retired = false;
+    for (auto& block : _blocks) {
+        if (block.ptr == buffer) {
+            return &block;
+        }
+    }
+    for (auto& block : _retired) {
+        if (block.ptr == buffer) {
+            *retired = true;
+            return &block;
+        }
+    }
+    return nullptr;
+}
+
+TY_STATUS FrameBufferPool::prepare(TY_DEV_HANDLE handle)
+{
+    if (!handle) {
+        return TY_STATUS_INVALID_HANDLE;
+    }
+
+    uint32_t frame_size = 0;
+    TY_STATUS status = TYGetFrameBufferSize(handle, &frame_size);
+    if (status != TY_STATUS_OK) {
+        return status;
+    }
+    if (frame_size == 0) {
+        return TY_STATUS_ERROR;
+    }
+
+    std::lock_guard<std::mutex> guard(_lock);
+
+    // 从干净的SDK队列开始，避免重复入队
+    TYClearBufferQueue(handle);
+    for (auto& block : _blocks) {
+        if (block.state == BLOCK_QUEUED) {
+            block.state = BLOCK_IDLE;
+        }
+    }
+    _queued = 0;
+
+    // 帧大小、数量或内存属性变化：不再适用的空闲缓冲区释放，仍被占用的转入_retired，归还时释放
+    std::vector<Block> keep;
+    for (auto& block : _blocks) {
+        if (frame_size == _buffer_size && block.flags == _flags && keep.size() < _count) {
+            keep.push_back(block);
+        } else if (block.state == BLOCK_IN_FLIGHT) {
+            _retired.push_back(block);
+        } else {
+            freeBlock(block);
+        }
+    }
+    _blocks.swap(keep);
+    _buffer_size = frame_size;
+
+    while (_blocks.size() < _count) {
+        Block block;
+        if (!allocBlock(block, frame_size)) {
+            break;
+        }
+        _blocks.push_back(block);
+    }
+
+    _handle = handle;
+    for (auto& block : _blocks) {
+        if (block.state != BLOCK_IDLE) {
+            continue;
+        }
+        status = TYEnqueueBuffer(handle, block.ptr, _buffer_size);
+        if (status != TY_STATUS_OK) {
+            return status;
+        }
+        block.state = BLOCK_QUEUED;
+        _queued++;
+    }
+    return _queued > 0 ? TY_STATUS_OK : TY_STATUS_NO_BUFFER;
+}
+
+void FrameBufferPool::detach()
+{
+    std::lock_guard<std::mutex> guard(_lock);
+    if (_handle) {
+        TYClearBufferQueue(_handle);
+        _handle = nullptr;
+    }
+    for (auto& block : _blocks) {
+        if (block.state == BLOCK_QUEUED) {
+            block.state = BLOCK_IDLE;
+        }
+    }
+    _queued = 0;
+}
+
+bool FrameBufferPool::onFetched(void* buffer)
+{
+    std::lock_guard<std::mutex> guard(_lock);
+    bool retired = false;
+    Block* block = findBlock(buffer, &retired);
+    if (!block || block->state != BLOCK_QUEUED) {
+        return false;
+    }
+    block->state = BLOCK_IN_FLIGHT;
+    _queued--;
+    _in_flight++;
+    if (_queued == 0) {
+        _starved++;
+        return true;
+    }
+    return false;
+}
+
+void FrameBufferPool::requeue(void* buffer)
+{
+    std::lock_guard<std::mutex> guard(_lock);
+    bool retired = false;
+    Block* block = findBlock(buffer, &retired);
+    if (!block || block->state != BLOCK_IN_FLIGHT) {
+        return;
+    }
+    _in_flight--;
+
+    if (retired) {
+        freeBlock(*block);
+        _retired.erase(_retired.begin() + (block - &_retired[0]));
+        return;
+    }
+
+    if (_handle && TYEnqueueBuffer(_handle, block->ptr, _buffer_size) == TY_STATUS_OK) {
+        block->state = BLOCK_QUEUED;
+        _queued++;
+    } else {
+        block->state = BLOCK_IDLE;
+    }
+}
+
+FrameBufferPool::Stats FrameBufferPool::stats() const
+{
+    std::lock_guard<std::mutex> guard(_lock);
+    Stats s;
+    s.buffer_count = static_cast<uint32_t>(_blocks.size());
+    s.buffer_size  = _buffer_size;
+    s.queued       = _queued.load();
+    s.in_flight    = _in_flight.load();
+    s.starved      = _starved.load();
+    s.allocations  = _allocations.load();
+    return s;
+}
+
+}
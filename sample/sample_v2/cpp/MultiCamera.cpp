@@ -0,0 +1,330 @@
+#include "../hpp/MultiCamera.hpp"
+#include "../../../include/TYApi.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <iostream>
+
+namespace percipio_layer {
+
+static uint64_t hostTimeUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// 每台设备一个线程并行执行fn，返回第一个失败的状态
+static TY_STATUS runPerDevice(size_t count, const std::function<TY_STATUS(size_t)>& fn)
+{
+    std::vector<TY_STATUS> status(count, TY_STATUS_OK);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < count; i++) {
+        threads.push_back(std::thread([&fn, &status, i] { status[i] = fn(i); }));
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (status[i] != TY_STATUS_OK) {
+            return status[i];
+        }
+    }
+    return TY_STATUS_OK;
+}
+
+MultiCamera::MultiCamera()
+    : mSyncMode(SyncHostTimestamp), mTolerance(10000), mQueueSize(4)
+    , mRunning(false), mMatcherWaiting(0), mSetIndex(0), mDroppedSets(0)
+{
+}
+
+MultiCamera::~MultiCamera()
+{
+    close();
+}
+
+TY_STATUS MultiCamera::open(const std::vector<std::string>& sns)
+{
+    close();
+    if (sns.empty()) {
+        return TY_STATUS_INVALID_PARAMETER;
+    }
+
+    // 只枚举一次，各相机在自己的线程中打开
+    auto deviceList = TYContext::getInstance().queryDeviceList();
+    if (!deviceList || deviceList->empty()) {
+        return TY_STATUS_ERROR;
+    }
+
+    for (const auto& sn : sns) {
+        std::unique_ptr<Device> dev(new Device());
+        dev->sn = sn;
+        dev->camera.reset(new FastCamera());
+        mDevices.push_back(std::move(dev));
+    }
+
+    TY_STATUS status = runPerDevice(mDevices.size(), [this, &deviceList](size_t i) {
+        TY_STATUS ret = mDevices[i]->camera->open(deviceList, mDevices[i]->sn.c_str());
+        if (ret != TY_STATUS_OK) {
+            std::cout << "MultiCamera: open " << mDevices[i]->sn << " failed: " << ret << "(" << TYErrorString(ret) << ")" << std::endl;
+        }
+        return ret;
+    });
+
+    if (status != TY_STATUS_OK) {
+        close();
+    }
+    return status;
+}
+
+void MultiCamera::close()
+{
+    stop();
+    for (auto& dev : mDevices) {
+        dev->camera->close();
+    }
+    mDevices.clear();
+}
+
+FastCamera* MultiCamera::camera(size_t idx)
+{
+    return idx < mDevices.size() ? mDevices[idx]->camera.get() : nullptr;
+}
+
+void MultiCamera::setSyncMode(SyncMode mode, uint32_t tolerance_us)
+{
+    mSyncMode = mode;
+    mTolerance = tolerance_us;
+}
+
+TY_STATUS MultiCamera::start(uint32_t queue_size)
+{
+    if (mDevices.empty()) {
+        return TY_STATUS_INVALID_HANDLE;
+    }
+    if (mRunning) {
+        return TY_STATUS_BUSY;
+    }
+
+    mQueueSize = queue_size ? queue_size : 1;
+    for (auto& dev : mDevices) {
+        dev->ring.reset(new FrameRing<TimedFrame>(mQueueSize));
+        dev->pending.clear();
+    }
+    mOutput.reset(new FrameRing<std::shared_ptr<TYFrameSet>>(mQueueSize));
+    mSetIndex = 0;
+
+    TY_STATUS status = runPerDevice(mDevices.size(), [this](size_t i) {
+        return mDevices[i]->camera->start();
+    });
+    if (status != TY_STATUS_OK) {
+        for (auto& dev : mDevices) {
+            dev->camera->stop();
+        }
+        return status;
+    }
+
+    mRunning = true;
+    for (auto& dev : mDevices) {
+        dev->thread = std::thread(&MultiCamera::captureLoop, this, dev.get());
+    }
+    mMatchThread = std::thread(&MultiCamera::matchLoop, this);
+    return TY_STATUS_OK;
+}
+
+TY_STATUS MultiCamera::stop()
+{
+    if (!mRunning) {
+        return TY_STATUS_OK;
+    }
+
+    mRunning = false;
+    for (auto& dev : mDevices) {
+        if (dev->thread.joinable()) {
+            dev->thread.join();
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(mWakeLock);
+        mWake.notify_all();
+    }
+    if (mMatchThread.joinable()) {
+        mMatchThread.join();
+    }
+
+    // 释放残留的帧，租借的缓冲区在相机停止前归还
+    for (auto& dev : mDevices) {
+        TimedFrame tf;
+        while (dev->ring->tryPop(tf)) {}
+        dev->pending.clear();
+    }
+    std::shared_ptr<TYFrameSet> set;
+    while (mOutput->tryPop(set)) {}
+    mOutput->interrupt();
+
+    return runPerDevice(mDevices.size(), [this](size_t i) {
+        return mDevices[i]->camera->stop();
+    });
+}
+
+std::shared_ptr<TYFrameSet> MultiCamera::tryGetFrameSet(uint32_t timeout_ms)
+{
+    if (!mOutput) {
+        return nullptr;
+    }
+
+    std::shared_ptr<TYFrameSet> set;
+    if (!mOutput->popWait(set, timeout_ms)) {
+        return nullptr;
+    }
+    return set;
+}
+
+MultiCamera::DeviceStats MultiCamera::deviceStats(size_t idx) const
+{
+    DeviceStats stats;
+    memset(&stats, 0, sizeof(stats));
+    if (idx >= mDevices.size()) {
+        return stats;
+    }
+
+    const Device& dev = *mDevices[idx];
+    stats.frames    = dev.frames.load();
+    stats.dropped   = dev.dropped.load();
+    stats.unmatched = dev.unmatched.load();
+    uint64_t count  = dev.latency_count.load();
+    stats.latency_avg_us = count ? dev.latency_sum.load() / count : 0;
+    stats.latency_max_us = dev.latency_max.load();
+    return stats;
+}
+
+void MultiCamera::captureLoop(Device* dev)
+{
+    while (mRunning) {
+        // 短超时以便及时响应停止请求
+        std::shared_ptr<TYFrame> frame = dev->camera->tryGetFrames(100);
+        if (!frame) {
+            continue;
+        }
+
+        TimedFrame tf;
+        tf.host_us = hostTimeUs();
+        tf.sync_us = (mSyncMode == SyncDeviceTimestamp) ? frame->timestamp() : tf.host_us;
+        tf.frame = std::move(frame);
+        dev->frames++;
+
+        // 匹配线程跟不上时丢弃该相机最旧的帧，不阻塞采集
+        while (!dev->ring->tryPush(std::move(tf))) {
+            TimedFrame oldest;
+            if (dev->ring->tryPop(oldest)) {
+                dev->dropped++;
+            }
+        }
+        notifyMatcher();
+    }
+}
+
+void MultiCamera::notifyMatcher()
+{
+    // 与matchLoop中的mMatcherWaiting++配对，保证不会错过唤醒
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (mMatcherWaiting.load() > 0) {
+        std::lock_guard<std::mutex> lock(mWakeLock);
+        mWake.notify_one();
+    }
+}
+
+void MultiCamera::matchLoop()
+{
+    while (mRunning) {
+        if (matchOnce()) {
+            continue;
+        }
+
+        mMatcherWaiting++;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        {
+            std::unique_lock<std::mutex> lock(mWakeLock);
+            bool ready = !mRunning;
+            for (auto& dev : mDevices) {
+                ready = ready || !dev->ring->empty();
+            }
+            if (!ready) {
+                mWake.wait_for(lock, std::chrono::milliseconds(100));
+            }
+        }
+        mMatcherWaiting--;
+    }
+}
+
+bool MultiCamera::matchOnce()
+{
+    bool progressed = false;
+
+    for (auto& dev : mDevices) {
+        TimedFrame tf;
+        while (dev->ring->tryPop(tf)) {
+            dev->pending.push_back(std::move(tf));
+            progressed = true;
+        }
+        // 某台相机长时间无帧时，限制其余相机的积压
+        while (dev->pending.size() > mQueueSize * 2) {
+            dev->pending.pop_front();
+            dev->unmatched++;
+        }
+    }
+
+    for (;;) {
+        uint64_t oldest = UINT64_MAX;
+        uint64_t newest = 0;
+        for (auto& dev : mDevices) {
+            if (dev->pending.empty()) {
+                return progressed;
+            }
+            uint64_t t = dev->pending.front().sync_us;
+            oldest = std::min(oldest, t);
+            newest = std::max(newest, t);
+        }
+        progressed = true;
+
+        if (newest - oldest > mTolerance) {
+            // 比最新队首早出容差窗口的帧不可能再成组，丢弃后重新比较
+            for (auto& dev : mDevices) {
+                if (dev->pending.front().sync_us + mTolerance < newest) {
+                    dev->pending.pop_front();
+                    dev->unmatched++;
+                }
+            }
+            continue;
+        }
+
+        std::shared_ptr<TYFrameSet> set = std::make_shared<TYFrameSet>();
+        set->index = mSetIndex++;
+        set->timestamp = newest;
+        set->frames.reserve(mDevices.size());
+
+        uint64_t now = hostTimeUs();
+        for (auto& dev : mDevices) {
+            TimedFrame& tf = dev->pending.front();
+            uint64_t latency = now > tf.host_us ? now - tf.host_us : 0;
+            dev->latency_sum += latency;
+            dev->latency_count++;
+            if (latency > dev->latency_max.load()) {
+                dev->latency_max = latency;
+            }
+            set->frames.push_back(std::move(tf.frame));
+            dev->pending.pop_front();
+        }
+
+        while (!mOutput->tryPush(std::move(set))) {
+            std::shared_ptr<TYFrameSet> stale;
+            if (mOutput->tryPop(stale)) {
+                mDroppedSets++;
+            }
+        }
+    }
+}
+
+}
@@ -0,0 +1,173 @@
+#include "../hpp/StreamStats.hpp"
+
+#include <climits>
+
+namespace percipio_layer {
+
+static int bucketOf(uint64_t us)
+{
+    if (us > 0xFFFFFFFFull) {
+        us = 0xFFFFFFFFull;
+    }
+    if (us < 8) {
+        return static_cast<int>(us);
+    }
+    int msb = 3;
+    while ((us >> (msb + 1)) != 0) {
+        msb++;
+    }
+    int sub = static_cast<int>((us >> (msb - 2)) & 3);
+    return 8 + (msb - 3) * 4 + sub;
+}
+
+static uint64_t bucketUpperBound(int idx)
+{
+    if (idx < 8) {
+        return idx;
+    }
+    int msb = (idx - 8) / 4 + 3;
+    uint64_t sub = (idx - 8) % 4;
+    uint64_t lower = (4 + sub) << (msb - 2);
+    return lower + (1ull << (msb - 2)) - 1;
+}
+
+void LatencyHistogram::record(uint64_t us)
+{
+    _sum.fetch_add(us, std::memory_order_relaxed);
+    uint64_t max = _max.load(std::memory_order_relaxed);
+    while (us > max && !_max.compare_exchange_weak(max, us, std::memory_order_relaxed)) {}
+    _buckets[bucketOf(us)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void LatencyHistogram::reset()
+{
+    _sum.store(0, std::memory_order_relaxed);
+    _max.store(0, std::memory_order_relaxed);
+    for (int i = 0; i < kBuckets; i++) {
+        _buckets[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+void LatencyHistogram::snapshot(Snapshot& out) const
+{
+    out.sum = _sum.load(std::memory_order_relaxed);
+    out.max = _max.load(std::memory_order_relaxed);
+    // 以各桶之和为准，保证百分位计算与桶计数一致
+    out.count = 0;
+    for (int i = 0; i < kBuckets; i++) {
+        out.buckets[i] = _buckets[i].load(std::memory_order_relaxed);
+        out.count += out.buckets[i];
+    }
+}
+
+uint64_t LatencyHistogram::Snapshot::percentile(double p) const
+{
+    if (count == 0) {
+        return 0;
+    }
+    if (p < 0) p = 0;
+    if (p > 1) p = 1;
+    uint64_t rank = static_cast<uint64_t>(p * (count - 1)) + 1;
+    uint64_t seen = 0;
+    for (int i = 0; i < kBuckets; i++) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            // 最后一个桶没有上界
+            uint64_t upper = (i == kBuckets - 1) ? max : bucketUpperBound(i);
+            return upper < max ? upper : max;
+        }
+    }
+    return max;
+}
+
+int StreamStats::slotOf(TY_COMPONENT_ID comp)
+{
+    switch (comp) {
+        case TY_COMPONENT_DEPTH_CAM:    return 0;
+        case TY_COMPONENT_RGB_CAM:      return 1;
+        case TY_COMPONENT_IR_CAM_LEFT:  return 2;
+        case TY_COMPONENT_IR_CAM_RIGHT: return 3;
+        default:                        return -1;
+    }
+}
+
+void StreamStats::onFrame(const TY_FRAME_DATA& frame, uint64_t host_us, uint64_t deliver_us)
+{
+    for (int i = 0; i < frame.validCount && i < 10; i++) {
+        const TY_IMAGE_DATA& img = frame.image[i];
+        int slot = slotOf(img.componentID);
+        if (slot < 0) {
+            continue;
+        }
+        Stream& s = _streams[slot];
+        s.frames.fetch_add(1, std::memory_order_relaxed);
+
+        int64_t last = s.last_index.load(std::memory_order_relaxed);
+        int64_t index = img.imageIndex;
+        if (last != LLONG_MIN) {
+            if (index > last + 1) {
+                s.lost.fetch_add(index - last - 1, std::memory_order_relaxed);
+            } else if (index <= last) {
+                // 设备重新开始计数，两边时钟的偏差也需要重新观测
+                s.index_resets.fetch_add(1, std::memory_order_relaxed);
+                s.min_offset.store(LLONG_MAX, std::memory_order_relaxed);
+            }
+        }
+        s.last_index.store(index, std::memory_order_relaxed);
+
+        if (img.timestamp) {
+            int64_t offset = static_cast<int64_t>(host_us) - static_cast<int64_t>(img.timestamp);
+            int64_t min = s.min_offset.load(std::memory_order_relaxed);
+            if (offset < min) {
+                s.min_offset.store(offset, std::memory_order_relaxed);
+                min = offset;
+            }
+            s.transit.record(static_cast<uint64_t>(offset - min));
+        }
+        s.deliver.record(deliver_us);
+    }
+}
+
+void StreamStats::onStarved(TY_COMPONENT_ID components)
+{
+    for (int i = 0; i < 32; i++) {
+        int slot = slotOf(components & (1u << i));
+        if (slot >= 0) {
+            _streams[slot].starved.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+void StreamStats::reset()
+{
+    for (int i = 0; i < kMaxStreams; i++) {
+        Stream& s = _streams[i];
+        s.frames.store(0, std::memory_order_relaxed);
+        s.lost.store(0, std::memory_order_relaxed);
+        s.index_resets.store(0, std::memory_order_relaxed);
+        s.starved.store(0, std::memory_order_relaxed);
+        s.last_index.store(LLONG_MIN, std::memory_order_relaxed);
+        s.min_offset.store(LLONG_MAX, std::memory_order_relaxed);
+        s.transit.reset();
+        s.deliver.reset();
+    }
+}
+
+bool StreamStats::snapshot(TY_COMPONENT_ID comp, StreamStatsSnapshot& out) const
+{
+    int slot = slotOf(comp);
+    if (slot < 0) {
+        return false;
+    }
+    const Stream& s = _streams[slot];
+    out.component    = comp;
+    out.frames       = s.frames.load(std::memory_order_relaxed);
+    out.lost         = s.lost.load(std::memory_order_relaxed);
+    out.index_resets = s.index_resets.load(std::memory_order_relaxed);
+    out.starved      = s.starved.load(std::memory_order_relaxed);
+    s.transit.snapshot(out.transit_us);
+    s.deliver.snapshot(out.deliver_us);
+    return true;
+}
+
+}
@@ -8,9 +8,16 @@
 #include <mutex>
 #include <set>
 #include <functional>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 
 // 包含Frame.hpp以获取TYFrame定义
 #include "Frame.hpp"
+#include "FrameBufferPool.hpp"
+#include "FrameRing.hpp"
+#include "StreamStats.hpp"
 
 // SDK类型前向声明 - 避免重复包含
 #ifndef TY_SDK_TYPES_DEFINED
@@ -118,6 +125,7 @@ class DeviceList;
 class TYContext;
 class TYCamInterface;
 class TYFrame;
+struct PendingScan;
 
 // 设备基础信息结构 - 避免与TY SDK冲突，使用自定义命名
 struct DeviceBaseInfo {
@@ -192,6 +200,7 @@ public:
 private:
     std::vector<DeviceBaseInfo> devs;
     static std::set<TY_INTERFACE_HANDLE> gifaces;
+    static std::mutex gifaces_lock;     // 多台设备可能被并行打开
 };
 
 // 相机接口类
@@ -207,6 +216,15 @@ private:
     std::vector<TY_INTERFACE_INFO> ifaces;
 };
 
+// 一次设备枚举中单个接口的扫描结果
+struct InterfaceScanInfo {
+    std::string id;
+    TY_STATUS   status;
+    uint32_t    deviceCount;
+    uint32_t    elapsedMs;
+    bool        timedOut;   // 截止时间内未返回，本次枚举不含该接口的设备
+};
+
 // 上下文类
 class TYContext {
 public:
@@ -230,11 +248,52 @@ public:
     bool ForceNetDeviceIP(const ForceIPStyle style, const std::string& mac, 
                          const std::string& ip, const std::string& mask, 
                          const std::string& gateway);
+
+    // 设备枚举时所有接口并行扫描，最多等待timeout_ms：到时返回已扫描到的设备，
+    // 未返回的接口在报告中标记为超时，其扫描线程由上下文持有并在结束后回收
+    void setDiscoveryTimeout(uint32_t timeout_ms) { _discovery_timeout = timeout_ms; }
+    uint32_t discoveryTimeout() const { return _discovery_timeout; }
+    // 最近一次枚举中各接口的耗时与结果
+    std::vector<InterfaceScanInfo> lastScanReport();
+
+    // 设备注册表：每次枚举的结果按序列号和IP缓存，TTL内的查找直接命中，不再重复枚举
+    void setRegistryTTL(uint32_t ttl_ms) { _registry_ttl = ttl_ms; }
+    // 返回只含该设备的列表，找不到时返回空；缓存过期时先只重新扫描该设备所在的接口，
+    // 未知设备或在原接口上找不到(换了网卡/USB口)时做一次完整枚举
+    std::shared_ptr<DeviceList> findDeviceBySN(const char* sn);
+    std::shared_ptr<DeviceList> findDeviceByIP(const char* ip);
+    // 设备离线或打开失败时移出注册表，下一次查找会重新枚举
+    void invalidateDevice(const char* sn);
+    void invalidateAll();
     
 private:
-    TYContext() {}
+    TYContext() : _discovery_timeout(2000), _registry_ttl(10000) {}
+    ~TYContext();
     TYContext(const TYContext&) = delete;
     TYContext& operator=(const TYContext&) = delete;
+
+    std::shared_ptr<DeviceList> searchDeviceList(const char *iface, TY_INTERFACE_TYPE type);
+
+    uint32_t _discovery_timeout;
+    // 超过截止时间的扫描线程：每次枚举前回收已结束的，析构时等待全部结束
+    void reapLateScans(bool wait);
+    std::mutex _scan_lock;
+    std::vector<std::shared_ptr<PendingScan>> _late_scans;
+    std::mutex _report_lock;
+    std::vector<InterfaceScanInfo> _last_report;
+
+    struct RegistryEntry {
+        DeviceBaseInfo info;
+        std::chrono::steady_clock::time_point updated;
+    };
+    std::shared_ptr<DeviceList> findDevice(const char* sn, const char* ip);
+    void updateRegistry(const std::vector<DeviceBaseInfo>& devs, const char* iface);
+    bool lookupRegistry(const char* sn, const char* ip, DeviceBaseInfo& info, bool& stale);
+
+    uint32_t _registry_ttl;
+    std::mutex _registry_lock;
+    std::map<std::string, RegistryEntry> _registry;     // 序列号 -> 设备信息
+    std::map<std::string, std::string> _registry_ip;    // IP -> 序列号
 };
 
 // FastCamera类 - 简化相机操作
@@ -248,6 +307,24 @@ public:
         stream_ir_right = 0x08,
         stream_ir = stream_ir_left | stream_ir_right,
     };
+
+    // 后台采集模式下环形队列满时的处理策略
+    enum OverflowPolicy {
+        OverflowDropOldest = 0, // 丢弃最旧的帧，保证队列中总是最近的ring_size帧
+        OverflowKeepLatest,     // 同上，且取帧时只返回最新一帧，其余帧丢弃
+        OverflowBlock,          // 采集线程等待消费者取走帧(SDK缓冲区可能被耗尽)
+    };
+    
+    // 帧回调：frame在租借模式下直接持有SDK缓冲区，回调返回(或frame释放)后才会归还
+    typedef std::function<void(const std::shared_ptr<TYFrame>& frame)> FrameCallback;
+    // 回调执行器：接收一个任务并在其它线程执行，例如提交到TYWorkerPool；为空时在采集线程内联执行
+    typedef std::function<void(std::function<void()> task)> FrameExecutor;
+
+    struct FrameCallbackStats {
+        uint64_t delivered;   // 已投递的帧数
+        uint64_t skipped;     // 达到在途上限而跳过的帧数
+        uint32_t in_flight;   // 当前尚未返回的回调数
+    };
     
     FastCamera();
     FastCamera(const char* sn);
@@ -255,6 +332,8 @@ public:
     
     // 设备操作
     TY_STATUS open(const char* sn);
+    // 使用已查询到的设备列表打开，多台相机并行打开时避免重复枚举
+    TY_STATUS open(const std::shared_ptr<DeviceList>& list, const char* sn);
     TY_STATUS openByIP(const char* ip);
     TY_STATUS openWithHandle(TY_DEV_HANDLE handle);
     void close();
@@ -272,21 +351,162 @@ public:
     std::shared_ptr<TYFrame> tryGetFrames(uint32_t timeout_ms = 1000);
     
     // 设备句柄访问
-    TY_DEV_HANDLE handle() { return device ? device->_handle : nullptr; }
+    TY_DEV_HANDLE handle() {
+        std::shared_ptr<TYDevice> dev = std::atomic_load(&device);
+        return dev ? dev->_handle : nullptr;
+    }
     
     // 设置接口ID
     TY_STATUS setIfaceId(const char* inf);
-    
+
+    // 帧租借模式：TYFrame直接持有SDK缓冲区，帧和取出的图像、视图都释放后重新入队，省去整帧拷贝
+    // 留在SDK队列中的空闲缓冲区少于min_free_buffers时，本帧退回拷贝模式
+    void setFrameLeaseMode(bool enable, uint32_t min_free_buffers = 2);
+    bool frameLeaseMode() const { return mLeaseMode; }
+
+    // 帧缓冲池：数量与内存属性在下一次start()时生效
+    void setBufferCount(uint32_t count) { mPool->setBufferCount(count); }
+    void setBufferMemoryFlags(uint32_t flags) { mPool->setMemoryFlags(flags); }
+    FrameBufferPool::Stats bufferStats() const { return mPool->stats(); }
+
+    // 后台采集模式：每台相机一个专用线程持续取帧并放入无锁环形队列，
+    // tryGetFrames变为出队操作(timeout_ms为0时不阻塞)，处理耗时不再影响SDK缓冲区回收
+    // 仅能在采集停止时切换；ring_size即队列最多缓存的帧数，不做取整
+    TY_STATUS enableAcquisitionThread(uint32_t ring_size = 4, OverflowPolicy policy = OverflowDropOldest);
+    TY_STATUS disableAcquisitionThread();
+    bool acquisitionThreadEnabled() const { return mAcqRing != nullptr; }
+    // 因队列溢出而丢弃的帧数
+    uint64_t droppedFrames() const { return mDropped.load(); }
+
+    // 注册帧回调，采集线程取到帧后直接推送给回调，无需轮询；返回回调id，失败返回负值
+    // max_in_flight: 该回调同时处理中的帧数上限；达到上限时blocking为false则跳过本帧，
+    //                为true则采集线程等待，由此向采集端施加背压
+    // 只要注册了回调，start()就会启动采集线程；未启用环形队列时帧只通过回调交付，tryGetFrames返回空
+    // 采集过程中可以随时注册/注销
+    int registerFrameCallback(FrameCallback cb, FrameExecutor executor = nullptr,
+                              uint32_t max_in_flight = 2, bool blocking = false);
+    // 返回后该回调不会再被调用，并等待其在途任务结束(在回调内部注销时不等待)
+    void unregisterFrameCallback(int id);
+    FrameCallbackStats frameCallbackStats(int id);
+
+    // 设备离线通知，在SDK事件线程中调用
+    void RegisterOfflineEventCallback(EventCallback cb, void* data);
+    bool isOffline() const { return mOffline.load(); }
+
+    // 自动重连：设备离线后，取帧时按缓存的序列号(或IP)重新打开设备，失败时按指数退避重试
+    // 重新打开后一次性恢复已启用的分量，按设置顺序重放通过下面接口写入的参数，
+    // 复用原有帧缓冲区，离线前正在采集则直接恢复采集；采集线程与回调无需重新注册
+    void setAutoReconnect(bool enable, uint32_t initial_backoff_ms = 100, uint32_t max_backoff_ms = 5000);
+    bool autoReconnect() const { return mAutoReconnect; }
+
+    struct ReconnectStats {
+        uint64_t reconnects;            // 成功重连次数
+        uint64_t attempts;              // 重新打开的尝试次数(含失败)
+        uint32_t offline_to_frame_ms;   // 最近一次从检测到离线到重连后第一帧的耗时
+        uint32_t reopen_to_frame_ms;    // 最近一次从重新打开成功到第一帧的耗时
+    };
+    ReconnectStats reconnectStats() const;
+
+    // 参数设置：写入设备的同时记录下来，重连后按原顺序重放；同一参数只保留最后一次的值
+    // 分辨率通过setEnum(comp, TY_ENUM_IMAGE_MODE, mode)设置
+    TY_STATUS setInt(TY_COMPONENT_ID comp, TY_FEATURE_ID feat, int32_t value);
+    TY_STATUS setFloat(TY_COMPONENT_ID comp, TY_FEATURE_ID feat, float value);
+    TY_STATUS setEnum(TY_COMPONENT_ID comp, TY_FEATURE_ID feat, uint32_t value);
+    TY_STATUS setBool(TY_COMPONENT_ID comp, TY_FEATURE_ID feat, bool value);
+
+    // 分流统计：comp为TY_COMPONENT_DEPTH_CAM/RGB_CAM/IR_CAM_LEFT/IR_CAM_RIGHT
+    // 不加锁，任意线程随时可以读取，不影响取帧
+    bool streamStats(TY_COMPONENT_ID comp, StreamStatsSnapshot& out) const;
+    void resetStreamStats();
+
 protected:
     TY_STATUS doStop();
     std::shared_ptr<TYFrame> fetchFrames(uint32_t timeout_ms);
-    
+    std::shared_ptr<TYFrame> wrapFrame(TY_FRAME_DATA& frameData);
+    TY_COMPONENT_ID componentMask() const;
+    void acquisitionLoop();
+    void stopAcquisition();
+    void dispatchFrame(const std::shared_ptr<TYFrame>& frame);
+
+    struct FrameCallbackEntry {
+        int                     id;
+        FrameCallback           cb;
+        FrameExecutor           executor;
+        uint32_t                max_in_flight;
+        bool                    blocking;
+        std::atomic<uint32_t>   in_flight;
+        std::atomic<uint64_t>   delivered;
+        std::atomic<uint64_t>   skipped;
+        std::atomic<bool>       active;
+        std::mutex              lock;
+        std::condition_variable idle;
+    };
+    typedef std::vector<std::shared_ptr<FrameCallbackEntry>> FrameCallbackList;
+    static void finishCallback(FrameCallbackEntry* entry);
+
+    enum FeatureType { FeatureInt, FeatureFloat, FeatureEnum, FeatureBool };
+    struct FeatureRecord {
+        TY_COMPONENT_ID comp;
+        TY_FEATURE_ID   feat;
+        FeatureType     type;
+        int32_t         i;
+        float           f;
+        uint32_t        e;
+        bool            b;
+    };
+    typedef std::chrono::steady_clock Clock;
+
+    void attachDevice();
+    void recordFeature(const FeatureRecord& record);
+    static TY_STATUS applyFeature(TY_DEV_HANDLE handle, const FeatureRecord& record);
+    bool tryReconnect(uint32_t max_wait_ms);
+    TY_STATUS reopen();
+    TY_STATUS restoreState();
+
 protected:
+    // 重连时采集线程会替换device：写入时持有_dev_lock并用std::atomic_store，
+    // 其余线程用std::atomic_load取一份副本后再使用
     std::shared_ptr<TYDevice> device;
     std::mutex _dev_lock;
     bool isRuning;
     uint32_t components; // 已启用的组件位图
     std::string mIfaceId;
+
+    bool mLeaseMode;
+    uint32_t mMinFreeBuffers;
+    std::shared_ptr<FrameBufferPool> mPool; // 与已租出的TYFrame共享
+
+    std::unique_ptr<FrameRing<std::shared_ptr<TYFrame>>> mAcqRing;
+    OverflowPolicy mOverflow;
+    std::thread mAcqThread;
+    std::atomic<bool> mAcqRunning;
+    std::atomic<uint64_t> mDropped;
+
+    // 写时复制：注册/注销时整体替换，采集线程只做原子读取
+    std::shared_ptr<const FrameCallbackList> mCallbacks;
+    std::mutex mCallbackLock;
+    int mNextCallbackId;
+
+    // 重连所需的缓存状态
+    std::string mSerial;
+    std::string mIP;
+    EventCallback mOfflineCallback;
+    void* mOfflineData;
+    std::atomic<bool> mOffline;
+    bool mAutoReconnect;
+    uint32_t mInitialBackoff;
+    uint32_t mMaxBackoff;
+    uint32_t mBackoff;
+    Clock::time_point mNextAttempt;
+    Clock::time_point mOfflineAt;
+    Clock::time_point mReopenedAt;
+    std::atomic<bool> mAwaitFirstFrame;
+    std::vector<FeatureRecord> mFeatures;
+    std::mutex mFeatureLock;
+    mutable std::mutex mReconnectLock;
+    ReconnectStats mReconnectStats;
+
+    std::unique_ptr<StreamStats> mStreamStats;
 };
 
 // 辅助函数
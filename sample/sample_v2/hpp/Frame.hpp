@@ -1,13 +1,21 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 #include <map>
+#include <functional>
 #include <mutex>
 #include <queue>
 #include <thread>
 #include <condition_variable>
+#include <atomic>
 
 #include "common.hpp"
+#include "TYWorkerPool.hpp"
+
+#ifdef OPENCV_DEPENDENCIES
+#include <opencv2/core.hpp>
+#endif
 
 namespace percipio_layer {
 
@@ -16,6 +24,8 @@ class TYImage
   public:
     TYImage();
     TYImage(const TY_IMAGE_DATA& image);
+    // 引用image.buffer而不复制，keeper持有缓冲区的所有者，本对象及其拷贝存活期间数据保持有效
+    TYImage(const TY_IMAGE_DATA& image, std::shared_ptr<void> keeper);
     TYImage(const TYImage& src);
     TYImage(int32_t width, int32_t height, TY_COMPONENT_ID compID, TY_PIXEL_FORMAT_LIST format, int32_t size);
 
@@ -36,27 +46,117 @@ class TYImage
 
     const TY_IMAGE_DATA* image() const { return &image_data; }
 
+    // 缓冲区所有者(租借模式下为SDK缓冲区的租约)，为空表示数据由外部管理
+    const std::shared_ptr<void>& keeper() const { return _keeper; }
+
   private:
-    bool m_isOwner = false;
+    std::shared_ptr<void> _keeper;
     TY_IMAGE_DATA image_data;
 };
 
+// TYImage转funny_Mat视图，视图持有image，image释放后数据仍然有效；不支持的格式返回空矩阵(见imageView)
+inline funny_Mat imageView(const std::shared_ptr<TYImage>& image) {
+    return image ? imageView(*image->image(), image) : funny_Mat();
+}
+
+// funny_Mat转TYImage，不复制数据：mat被移入图像，随图像一起释放
+// format须与mat的类型一致(如CV_8UC1对应TY_PIXEL_FORMAT_MONO)
+inline std::shared_ptr<TYImage> imageFromMat(funny_Mat&& mat, TY_COMPONENT_ID compID, TY_PIXEL_FORMAT format) {
+    if (mat.empty()) {
+        return nullptr;
+    }
+    std::shared_ptr<funny_Mat> owner = std::make_shared<funny_Mat>(std::move(mat));
+    TY_IMAGE_DATA data;
+    memset(&data, 0, sizeof(data));
+    data.width = owner->cols();
+    data.height = owner->rows();
+    data.componentID = compID;
+    data.pixelFormat = format;
+    data.size = static_cast<int32_t>(owner->dataSize());
+    data.buffer = owner->data();
+    return std::make_shared<TYImage>(data, owner);
+}
+
+#ifdef OPENCV_DEPENDENCIES
+// TYImage转cv::Mat视图，不复制数据；cv::Mat不能持有image，调用方须保证image在使用期间存活
+inline cv::Mat imageToCvMat(const std::shared_ptr<TYImage>& image) {
+    funny_Mat view = imageView(image);
+    if (view.empty()) {
+        return cv::Mat();
+    }
+    const FunnyPixelTraits& t = funny_pixel_traits(image->pixelFormat());
+    return cv::Mat(view.rows(), view.cols(), CV_MAKETYPE(t.sample_bits == 16 ? CV_16U : CV_8U, t.channels),
+                   image->buffer());
+}
+
+// cv::Mat转TYImage，不复制数据：图像持有mat的引用计数；mat须为连续存储
+inline std::shared_ptr<TYImage> imageFromCvMat(const cv::Mat& mat, TY_COMPONENT_ID compID, TY_PIXEL_FORMAT format) {
+    if (mat.empty() || !mat.isContinuous()) {
+        return nullptr;
+    }
+    std::shared_ptr<cv::Mat> owner = std::make_shared<cv::Mat>(mat);
+    TY_IMAGE_DATA data;
+    memset(&data, 0, sizeof(data));
+    data.width = mat.cols;
+    data.height = mat.rows;
+    data.componentID = compID;
+    data.pixelFormat = format;
+    data.size = static_cast<int32_t>(mat.total() * mat.elemSize());
+    data.buffer = owner->data;
+    return std::make_shared<TYImage>(data, owner);
+}
+#endif
+
+// 租借模式下将SDK缓冲区归还(重新入队)的回调
+typedef std::function<void(void* buffer, int32_t size)> TYFrameBufferReleaser;
+
 class TYFrame
 {
   public:
     ~TYFrame();
     void operator=(TYFrame const&) = delete;
     TYFrame(TYFrame const&) = delete;
+    // 拷贝模式：复制userBuffer，图像指向帧内部的副本
     TYFrame(const TY_FRAME_DATA& frame);
+    // 租借模式：图像直接指向SDK缓冲区，帧和所有图像(及其视图)都释放后通过releaser归还
+    TYFrame(const TY_FRAME_DATA& frame, TYFrameBufferReleaser releaser);
+    // 组合模式：由多个只含部分分量的帧(异步出流)拼成一帧，图像仍引用原帧的数据，原帧随本帧一起释放
+    explicit TYFrame(const std::vector<std::shared_ptr<TYFrame>>& parts);
  
-    std::shared_ptr<TYImage> depthImage()        { return _images[TY_COMPONENT_DEPTH_CAM];}
-    std::shared_ptr<TYImage> colorImage()        { return _images[TY_COMPONENT_RGB_CAM];}
-    std::shared_ptr<TYImage> leftIRImage()       { return _images[TY_COMPONENT_IR_CAM_LEFT];}
-    std::shared_ptr<TYImage> rightIRImage()      { return _images[TY_COMPONENT_IR_CAM_RIGHT];}
+    // 只读查找，多个线程可以同时取图像
+    std::shared_ptr<TYImage> depthImage()  const { return image(TY_COMPONENT_DEPTH_CAM);}
+    std::shared_ptr<TYImage> colorImage()  const { return image(TY_COMPONENT_RGB_CAM);}
+    std::shared_ptr<TYImage> leftIRImage() const { return image(TY_COMPONENT_IR_CAM_LEFT);}
+    std::shared_ptr<TYImage> rightIRImage() const { return image(TY_COMPONENT_IR_CAM_RIGHT);}
+
+    // 帧内首个有效图像的设备时间戳(微秒)
+    uint64_t timestamp() const { return _timestamp; }
+    // 帧内首个有效图像的序号
+    int32_t  imageIndex() const { return _image_index; }
+    // 帧内包含的分量(TY_COMPONENT_ID位掩码)
+    TY_COMPONENT_ID components() const { return _components; }
+    std::shared_ptr<TYImage> image(TY_COMPONENT_ID comp) const {
+        auto it = _images.find(comp);
+        return it != _images.end() ? it->second : nullptr;
+    }
+
+    bool isLeased()  const { return _lease != nullptr; }
+    // 放弃本帧对图像和SDK缓冲区的引用，已取出的图像和视图全部释放后缓冲区才归还；重复调用无副作用
+    void release();
 
   private:
+    void parseImages(const TY_FRAME_DATA& frame, uint8_t* base);
+
     int32_t               bufferSize = 0;
-    std::vector<uint8_t>  userBuffer;
+    uint64_t              _timestamp = 0;
+    int32_t               _image_index = 0;
+    TY_COMPONENT_ID       _components = 0;
+    std::vector<std::shared_ptr<TYFrame>> _parts;
+    // 拷贝模式下的帧数据副本，由各图像共同持有，帧释放后已取出的图像仍然有效
+    std::shared_ptr<std::vector<uint8_t>> userBuffer;
+
+    // 租借模式下SDK缓冲区的租约，由本帧和各图像共同持有，删除器通过releaser归还缓冲区
+    std::shared_ptr<void> _lease;
 
     typedef std::map<TY_COMPONENT_ID, std::shared_ptr<TYImage>> ty_image;
     ty_image              _images;
@@ -95,10 +195,18 @@ typedef std::map<TY_COMPONENT_ID, std::shared_ptr<ImageProcesser>> ty_stream;
 class TYFrameParser
 {
   public:
+    // 显示队列满时的处理策略
+    enum DropPolicy {
+        DropOldest = 0, // 丢弃队首最旧的帧(默认，与原行为一致)
+        DropNewest,     // 丢弃新到达的帧，已排队的帧保持不变
+        DropNone,       // 不丢帧，update()阻塞直到队列有空位
+    };
+
     TYFrameParser(uint32_t max_queue_size = 4, const TY_ISP_HANDLE isp_handle = nullptr);
     ~TYFrameParser();
 
     void RegisterKeyBoardEventCallback(TYFrameKeyBoardEventCallback cb, void* data) {
+      std::lock_guard<std::mutex> lock(_queue_lock);
       user_data = data;
       func_keyboard_event = cb;
     }
@@ -106,11 +214,31 @@ class TYFrameParser
     virtual int doProcess(const std::shared_ptr<TYFrame>& frame);
     void update(const std::shared_ptr<TYFrame>& frame);
 
+    void setDropPolicy(DropPolicy policy);
+    DropPolicy dropPolicy() const { return _drop_policy; }
+    // 因队列满而丢弃的帧数
+    uint64_t droppedFrames() const { return _dropped; }
+
+    // 停止显示线程，丢弃尚未处理的帧；析构时自动调用，可重复调用
+    void stop();
+
+    // 并行处理：各分量的ImageProcesser作为独立任务在工作线程池上执行，全部完成后才处理下一帧
+    // pool为空时使用TYWorkerPool::shared()
+    void setParallelProcess(bool enable, TYWorkerPool* pool = nullptr);
+    bool parallelProcess() const { return _parallel; }
+
 protected:
     ty_stream stream;
   private:
-    std::mutex      _queue_lock;
-    uint32_t        _max_queue_size;
+    std::mutex              _queue_lock;
+    std::condition_variable _queue_not_empty;
+    std::condition_variable _queue_not_full;
+    uint32_t                _max_queue_size;
+    DropPolicy              _drop_policy;
+    std::atomic<uint64_t>   _dropped;
+
+    bool            _parallel;
+    TYWorkerPool*   _pool;
 
     bool            isRuning;
     std::thread     processThread_;
@@ -120,7 +248,6 @@ protected:
 
     std::queue<std::shared_ptr<TYFrame>> images;
 
-    inline void ImageQueueSizeCheck();
-    inline void display();
+    void display();
 };
 }
\ No newline at end of file
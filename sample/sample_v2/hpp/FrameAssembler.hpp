@@ -0,0 +1,80 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <chrono>
+
+#include "Frame.hpp"
+
+namespace percipio_layer {
+
+// 异步出流帧组装 - TY_STREAM_ASYNC_ALL模式下深度/彩色/IR分别以独立的TY_FRAME_DATA到达，
+// 按imageIndex或时间戳把它们拼回完整的一帧
+// 每个未完成的帧组从第一个分量到达起计时，超过截止时间仍未到齐时按设置输出不完整帧或丢弃
+class FrameAssembler
+{
+  public:
+    enum MatchKey {
+        MatchImageIndex = 0,    // 按imageIndex精确匹配
+        MatchTimestamp,         // 按时间戳匹配，相差不超过容差视为同一帧
+    };
+
+    struct Stats {
+        uint64_t complete;      // 输出的完整帧数
+        uint64_t partial;       // 输出的不完整帧数
+        uint64_t expired;       // 超时或溢出后被丢弃的不完整帧数
+        uint64_t late;          // 所属帧已输出后才到达、被丢弃的分量数
+    };
+
+    // components: 期望的分量(TY_COMPONENT_ID位掩码)，全部到齐即输出
+    FrameAssembler(TY_COMPONENT_ID components, MatchKey key = MatchImageIndex);
+
+    void setTimestampTolerance(uint64_t tolerance_us) { _tolerance_us = tolerance_us; }
+    // 第一个分量到达后等待其余分量的最长时间
+    void setDeadline(uint32_t deadline_ms) { _deadline = std::chrono::milliseconds(deadline_ms); }
+    // 超时或溢出时是否输出不完整帧，否则直接丢弃
+    void setEmitPartial(bool enable) { _emit_partial = enable; }
+    // 同时等待的帧组上限，即每路分量最多缓存的图像数
+    void setMaxPending(uint32_t count) { _max_pending = count ? count : 1; }
+
+    // 输入一个(可能只含部分分量的)帧，把可以输出的帧追加到out，按完成顺序排列
+    void push(const std::shared_ptr<TYFrame>& part, std::vector<std::shared_ptr<TYFrame>>& out);
+    // 处理超时；长时间没有新输入时也需要周期性调用
+    void poll(std::vector<std::shared_ptr<TYFrame>>& out);
+    // 立即把所有未完成的帧组作为不完整帧输出
+    void flush(std::vector<std::shared_ptr<TYFrame>>& out);
+    void reset();
+
+    Stats stats() const;
+
+  private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Group {
+        uint64_t                              key;
+        TY_COMPONENT_ID                       have;
+        Clock::time_point                     first_arrival;
+        std::vector<std::shared_ptr<TYFrame>> parts;
+    };
+
+    bool matches(uint64_t a, uint64_t b) const;
+    uint64_t keyOf(const std::shared_ptr<TYFrame>& frame) const;
+    void emit(Group& group, bool complete, std::vector<std::shared_ptr<TYFrame>>& out);
+    void expire(const Clock::time_point& now, std::vector<std::shared_ptr<TYFrame>>& out);
+
+    mutable std::mutex      _lock;
+    TY_COMPONENT_ID         _expected;
+    MatchKey                _match;
+    uint64_t                _tolerance_us;
+    Clock::duration         _deadline;
+    bool                    _emit_partial;
+    uint32_t                _max_pending;
+
+    std::deque<Group>       _groups;    // 按首个分量到达顺序排列
+    std::deque<uint64_t>    _recent;    // 最近已输出的帧组，用于识别迟到的分量
+    Stats                   _stats;
+};
+
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+
+#include "TYApi.h"
+
+namespace percipio_layer {
+
+// 帧缓冲池 - 由FastCamera持有，负责按TYGetFrameBufferSize分配、入队和回收SDK帧缓冲区
+// 缓冲区在close()后保留，重连时尺寸不变即可直接复用
+class FrameBufferPool
+{
+  public:
+    enum MemoryFlags : uint32_t {
+        MEM_DEFAULT    = 0x00,
+        MEM_HUGE_PAGES = 0x01,  // 优先使用大页内存，失败时退回普通对齐分配
+        MEM_LOCKED     = 0x02,  // 锁定物理内存(mlock/VirtualLock)，避免被换出
+    };
+
+    struct Stats {
+        uint32_t buffer_count;  // 缓冲区总数
+        uint32_t buffer_size;   // 单个缓冲区大小(字节)
+        uint32_t queued;        // 位于SDK队列中、可接收新帧的空闲缓冲区
+        uint32_t in_flight;     // 已被取出、尚未归还的缓冲区
+        uint64_t starved;       // 取帧后SDK队列中空闲缓冲区耗尽的次数
+        uint64_t allocations;   // 累计分配次数
+    };
+
+    static const uint32_t kAlignment = 64;
+
+    FrameBufferPool(uint32_t count = 10, uint32_t flags = MEM_DEFAULT);
+    ~FrameBufferPool();
+
+    FrameBufferPool(const FrameBufferPool&) = delete;
+    FrameBufferPool& operator=(const FrameBufferPool&) = delete;
+
+    // 以下配置在下一次prepare()时生效
+    void setBufferCount(uint32_t count);
+    void setMemoryFlags(uint32_t flags);
+    uint32_t bufferCount() const { return _count; }
+
+    // 按当前流配置查询帧大小，必要时重新分配，并将所有未被占用的缓冲区入队
+    // 启用/关闭流或修改分辨率后，需在开始采集前再次调用
+    TY_STATUS prepare(TY_DEV_HANDLE handle);
+    // 清空SDK队列并与设备解绑，内存保留供下一次prepare()复用
+    void detach();
+
+    // TYFetchFrame返回后登记该缓冲区离开SDK队列
+    // 取走的是最后一个空闲缓冲区时记为一次饥饿并返回true
+    bool onFetched(void* buffer);
+    // 归还缓冲区：仍绑定设备时重新入队，否则留待下一次prepare()
+    void requeue(void* buffer);
+
+    uint32_t freeCount() const { return _queued.load(); }
+    Stats stats() const;
+
+  private:
+    enum BlockState {
+        BLOCK_IDLE = 0,     // 已分配，未入队
+        BLOCK_QUEUED,       // 在SDK队列中
+        BLOCK_IN_FLIGHT,    // 已取出，等待归还
+    };
+
+    struct Block {
+        void*      ptr;
+        size_t     alloc_size;
+        bool       mapped;      // 通过mmap/VirtualAlloc分配
+        bool       locked;
+        uint32_t   flags;       // 分配时使用的MemoryFlags
+        BlockState state;
+    };
+
+    bool allocBlock(Block& block, size_t size);
+    void freeBlock(Block& block);
+    Block* findBlock(void* buffer, bool* retired);
+
+    mutable std::mutex   _lock;
+    TY_DEV_HANDLE        _handle;
+    uint32_t             _count;
+    uint32_t             _flags;
+    uint32_t             _buffer_size;
+
+    std::vector<Block>   _blocks;
+    // 重新分配时仍被占用的旧缓冲区，归还时释放
+    std::vector<Block>   _retired;
+
+    std::atomic<uint32_t> _queued;
+    std::atomic<uint32_t> _in_flight;
+    std::atomic<uint64_t> _starved;
+    std::atomic<uint64_t> _allocations;
+};
+
+}
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+#include <condition_variable>
+
+namespace percipio_layer {
+
+// 有界无锁环形队列 - 单生产者(采集线程)/单消费者(取帧线程)
+// 每个槽位带序号(Vyukov方式)，出队使用CAS，因此生产者在队满时也可以安全地淘汰最旧的元素
+// 快速路径完全无锁；只有在需要阻塞等待时才会用到内部的条件变量
+// 槽位数取不小于capacity的2的幂以便按掩码取模，可容纳的元素数仍严格为capacity
+template <typename T>
+class FrameRing
+{
+  public:
+    explicit FrameRing(size_t capacity)
+        : _limit(capacity > 0 ? capacity : 1), _waiting(0)
+    {
+        size_t n = 2;
+        while (n < capacity) n <<= 1;
+        _mask = n - 1;
+        _slots.reset(new Slot[n]);
+        for (size_t i = 0; i < n; i++) {
+            _slots[i].seq.store(i, std::memory_order_relaxed);
+        }
+        _head.store(0, std::memory_order_relaxed);
+        _tail.store(0, std::memory_order_relaxed);
+    }
+
+    FrameRing(const FrameRing&) = delete;
+    FrameRing& operator=(const FrameRing&) = delete;
+
+    size_t capacity() const { return _limit; }
+
+    size_t size() const {
+        size_t tail = _tail.load(std::memory_order_acquire);
+        size_t head = _head.load(std::memory_order_acquire);
+        return tail > head ? tail - head : 0;
+    }
+
+    bool empty() const { return size() == 0; }
+
+    // 生产者：队满时返回false
+    bool tryPush(T&& value) {
+        if (!push(std::move(value))) {
+            return false;
+        }
+        wake();
+        return true;
+    }
+
+    // 消费者(或淘汰旧元素的生产者)：队空时返回false
+    bool tryPop(T& value) {
+        if (!pop(value)) {
+            return false;
+        }
+        wake();
+        return true;
+    }
+
+    // 等待直到有元素可取，timeout_ms为0时不阻塞
+    bool popWait(T& value, uint32_t timeout_ms) {
+        if (tryPop(value)) {
+            return true;
+        }
+        if (timeout_ms == 0) {
+            return false;
+        }
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+        std::unique_lock<std::mutex> lock(_wait_lock);
+        _waiting++;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        bool ok = false;
+        while (!(ok = pop(value))) {
+            if (_event.wait_until(lock, deadline) == std::cv_status::timeout) {
+                ok = pop(value);
+                break;
+            }
+        }
+        _waiting--;
+        if (ok) {
+            // 可能有生产者在等待空位
+            _event.notify_all();
+        }
+        return ok;
+    }
+
+    // 等待直到有空位，running变为false时放弃
+    bool pushWait(T&& value, const std::atomic<bool>& running) {
+        if (tryPush(std::move(value))) {
+            return true;
+        }
+        std::unique_lock<std::mutex> lock(_wait_lock);
+        _waiting++;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        bool ok = false;
+        while (running && !(ok = push(std::move(value)))) {
+            _event.wait_for(lock, std::chrono::milliseconds(100));
+        }
+        _waiting--;
+        if (ok) {
+            _event.notify_all();
+        }
+        return ok;
+    }
+
+    // 唤醒所有等待者，用于停止时
+    void interrupt() {
+        std::lock_guard<std::mutex> lock(_wait_lock);
+        _event.notify_all();
+    }
+
+  private:
+    struct Slot {
+        std::atomic<size_t> seq;
+        T                   value;
+    };
+
+    bool push(T&& value) {
+        size_t pos = _tail.load(std::memory_order_relaxed);
+        // 只有一个生产者，读到的_head只会偏旧，最多把刚腾出的空位仍判为满
+        if (pos - _head.load(std::memory_order_acquire) >= _limit) {
+            return false;
+        }
+        Slot& slot = _slots[pos & _mask];
+        if (slot.seq.load(std::memory_order_acquire) != pos) {
+            return false;
+        }
+        slot.value = std::move(value);
+        slot.seq.store(pos + 1, std::memory_order_release);
+        _tail.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T& value) {
+        size_t pos = _head.load(std::memory_order_relaxed);
+        Slot* slot = nullptr;
+        for (;;) {
+            slot = &_slots[pos & _mask];
+            size_t seq = slot->seq.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = _head.load(std::memory_order_relaxed);
+            }
+        }
+        value = std::move(slot->value);
+        slot->value = T();
+        slot->seq.store(pos + _mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    void wake() {
+        // 与等待方的_waiting++配对，保证不会错过唤醒
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (_waiting.load() > 0) {
+            std::lock_guard<std::mutex> lock(_wait_lock);
+            _event.notify_all();
+        }
+    }
+
+    std::unique_ptr<Slot[]>  _slots;
+    size_t                   _mask;
+    size_t                   _limit;    // 实际容量，不超过槽位数
+
+    // 头尾指针分处不同缓存行，避免生产者/消费者伪共享
+    // (C++11下对象本身不保证按64字节对齐，用填充代替alignas)
+    char                     _pad0[64];
+    std::atomic<size_t>      _head;
+    char                     _pad1[64 - sizeof(std::atomic<size_t>)];
+    std::atomic<size_t>      _tail;
+    char                     _pad2[64 - sizeof(std::atomic<size_t>)];
+
+    std::atomic<int>         _waiting;
+    std::mutex               _wait_lock;
+    std::condition_variable  _event;
+};
+
+}
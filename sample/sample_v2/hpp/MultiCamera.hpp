@@ -0,0 +1,120 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <string>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+
+#include "Device.hpp"
+#include "FrameRing.hpp"
+
+namespace percipio_layer {
+
+// 同步帧组：frames[i]对应MultiCamera中的第i台相机
+struct TYFrameSet {
+    uint64_t index;       // 帧组序号，从0开始
+    uint64_t timestamp;   // 组内最晚一帧的同步时间(微秒)
+    std::vector<std::shared_ptr<TYFrame>> frames;
+};
+
+// 多相机管理 - 并行打开多台FastCamera，每台相机一个采集线程，
+// 由匹配线程按时间戳把各相机的帧组合成同步帧组
+// 采集线程与匹配线程之间通过各自的无锁环形队列传递帧，热路径上没有全局锁
+class MultiCamera
+{
+  public:
+    enum SyncMode {
+        SyncHostTimestamp = 0,  // 按主机收到帧的时间分组，适用于软/硬触发且相机时钟未同步的情况
+        SyncDeviceTimestamp,    // 按设备时间戳分组，要求相机时钟已同步(如PTP)
+    };
+
+    struct DeviceStats {
+        uint64_t frames;          // 收到的帧数
+        uint64_t dropped;         // 匹配线程来不及处理而丢弃的帧数
+        uint64_t unmatched;       // 超出容差窗口、未能成组而丢弃的帧数
+        uint64_t latency_avg_us;  // 从收到帧到所在帧组输出的平均延迟
+        uint64_t latency_max_us;
+    };
+
+    MultiCamera();
+    ~MultiCamera();
+
+    MultiCamera(const MultiCamera&) = delete;
+    MultiCamera& operator=(const MultiCamera&) = delete;
+
+    // 并行打开所有相机；任意一台失败时关闭已打开的相机并返回该错误
+    TY_STATUS open(const std::vector<std::string>& sns);
+    void close();
+
+    size_t size() const { return mDevices.size(); }
+    // 用于在start()之前配置各相机的流、分辨率等
+    FastCamera* camera(size_t idx);
+    const std::string& serialNumber(size_t idx) const { return mDevices[idx]->sn; }
+
+    // 时间戳相差不超过tolerance_us的帧视为同一组，需在start()之前设置
+    void setSyncMode(SyncMode mode, uint32_t tolerance_us);
+
+    // 并行启动所有相机；queue_size为每台相机与输出帧组的队列深度
+    TY_STATUS start(uint32_t queue_size = 4);
+    TY_STATUS stop();
+
+    // 取一个同步帧组，timeout_ms为0时不阻塞
+    std::shared_ptr<TYFrameSet> tryGetFrameSet(uint32_t timeout_ms = 1000);
+
+    DeviceStats deviceStats(size_t idx) const;
+    // 输出队列满而丢弃的帧组数
+    uint64_t droppedFrameSets() const { return mDroppedSets.load(); }
+
+  private:
+    struct TimedFrame {
+        std::shared_ptr<TYFrame> frame;
+        uint64_t sync_us;   // 用于分组的时间
+        uint64_t host_us;   // 主机收到帧的时间
+    };
+
+    struct Device {
+        std::string                                 sn;
+        std::unique_ptr<FastCamera>                 camera;
+        std::unique_ptr<FrameRing<TimedFrame>>      ring;
+        std::thread                                 thread;
+        std::deque<TimedFrame>                      pending;    // 只由匹配线程访问
+
+        std::atomic<uint64_t> frames;
+        std::atomic<uint64_t> dropped;
+        std::atomic<uint64_t> unmatched;
+        std::atomic<uint64_t> latency_sum;
+        std::atomic<uint64_t> latency_count;
+        std::atomic<uint64_t> latency_max;
+
+        Device() : frames(0), dropped(0), unmatched(0)
+                 , latency_sum(0), latency_count(0), latency_max(0) {}
+    };
+
+    void captureLoop(Device* dev);
+    void matchLoop();
+    bool matchOnce();
+    void notifyMatcher();
+
+    std::vector<std::unique_ptr<Device>>    mDevices;
+    SyncMode                                mSyncMode;
+    uint32_t                                mTolerance;
+    uint32_t                                mQueueSize;
+
+    std::atomic<bool>                       mRunning;
+    std::thread                             mMatchThread;
+
+    // 仅在匹配线程无事可做时使用
+    std::atomic<int>                        mMatcherWaiting;
+    std::mutex                              mWakeLock;
+    std::condition_variable                 mWake;
+
+    std::unique_ptr<FrameRing<std::shared_ptr<TYFrameSet>>> mOutput;
+    uint64_t                                mSetIndex;
+    std::atomic<uint64_t>                   mDroppedSets;
+};
+
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "common.hpp"
+
+namespace percipio_layer {
+
+// 延迟直方图(微秒) - 0~7线性分桶，其后每个2的幂区间再分4个子桶，相对误差不超过25%
+// 记录只有几次无锁原子加法，读取方随时可以取快照
+class LatencyHistogram
+{
+  public:
+    static const int kBuckets = 124;    // 覆盖0 ~ 2^32-1微秒
+
+    struct Snapshot {
+        uint64_t count;
+        uint64_t sum;
+        uint64_t max;
+        uint64_t buckets[kBuckets];
+
+        uint64_t mean() const { return count ? sum / count : 0; }
+        // p取0~1，返回所在桶的上界
+        uint64_t percentile(double p) const;
+    };
+
+    LatencyHistogram() { reset(); }
+
+    void record(uint64_t us);
+    void reset();
+    void snapshot(Snapshot& out) const;
+
+  private:
+    std::atomic<uint64_t> _sum;
+    std::atomic<uint64_t> _max;
+    std::atomic<uint64_t> _buckets[kBuckets];
+};
+
+// 单路流(深度/彩色/左右IR)的统计快照
+struct StreamStatsSnapshot {
+    TY_COMPONENT_ID component;
+    uint64_t frames;            // 收到的图像数
+    uint64_t lost;              // 按imageIndex跳变推算的丢失图像数(设备或链路上丢失)
+    uint64_t index_resets;      // imageIndex回退的次数(设备重启/重连)
+    uint64_t starved;           // 该流启用期间SDK缓冲区饥饿的次数
+    // 设备时间戳到主机取到帧的时间差，扣除观测到的最小值(即两边时钟的偏差)后的部分，
+    // 反映链路与SDK中的排队延迟；两边时钟存在漂移时只适合观察短时间内的抖动
+    LatencyHistogram::Snapshot transit_us;
+    // TYFetchFrame返回到帧交付(拷贝或租借)的耗时，即本层处理的开销
+    LatencyHistogram::Snapshot deliver_us;
+};
+
+// FastCamera的分流统计 - 只在取帧路径上写入，读取不加锁
+// 各计数器分别原子更新，快照中的字段之间可能相差一帧
+class StreamStats
+{
+  public:
+    enum { kMaxStreams = 4 };
+
+    StreamStats() { reset(); }
+
+    StreamStats(const StreamStats&) = delete;
+    StreamStats& operator=(const StreamStats&) = delete;
+
+    // host_us: TYFetchFrame返回时的主机时间；deliver_us: 帧交付前的处理耗时(不含TYFetchFrame的等待)
+    void onFrame(const TY_FRAME_DATA& frame, uint64_t host_us, uint64_t deliver_us);
+    // 空闲缓冲区耗尽，计入components中的每一路流
+    void onStarved(TY_COMPONENT_ID components);
+    void reset();
+
+    // comp不是深度/彩色/IR分量时返回false
+    bool snapshot(TY_COMPONENT_ID comp, StreamStatsSnapshot& out) const;
+
+  private:
+    struct Stream {
+        std::atomic<uint64_t> frames;
+        std::atomic<uint64_t> lost;
+        std::atomic<uint64_t> index_resets;
+        std::atomic<uint64_t> starved;
+        std::atomic<int64_t>  last_index;
+        std::atomic<int64_t>  min_offset;
+        LatencyHistogram      transit;
+        LatencyHistogram      deliver;
+    };
+
+    static int slotOf(TY_COMPONENT_ID comp);
+
+    Stream _streams[kMaxStreams];
+};
+
+}
@@ -1,4 +1,5 @@
 #include "Device.hpp"
+#include "TYAutoExposure.hpp"
 
 using namespace percipio_layer;
 
@@ -58,13 +59,16 @@ int main(int argc, char* argv[])
 {
     std::string ID;
     int val = -1;
+    bool auto_exp = false;
     for(int i = 1; i < argc; i++) {
         if(strcmp(argv[i], "-id") == 0) {
             ID = argv[++i];
         }  else if(strcmp(argv[i], "-exp") == 0) {
             val = atoi(argv[++i]);
+        } else if(strcmp(argv[i], "-auto") == 0) {
+            auto_exp = true;
         } else if(strcmp(argv[i], "-h") == 0) {
-            std::cout << "Usage: " << argv[0] << "   [-h] [-id <ID>]  [-exp <exposure>]" << std::endl;
+            std::cout << "Usage: " << argv[0] << "   [-h] [-id <ID>]  [-exp <exposure>] [-auto]" << std::endl;
             return 0;
         }
     }
@@ -75,8 +79,16 @@ int main(int argc, char* argv[])
         return -1;
     }
 
-    TY_STATUS status = camera.SetRGBExposureTime(val);
-    std::cout << "set rgb exposure time : " << val << ",  ret = " << status << std::endl;
+    //-auto: host side auto exposure/gain/white balance, computed from color frame statistics
+    TYAutoExposure ae;
+    if(auto_exp) {
+        TY_STATUS status = ae.attach(camera.handle(), TY_COMPONENT_RGB_CAM);
+        std::cout << "host auto exposure attach, ret = " << status << std::endl;
+        if(status != TY_STATUS_OK) auto_exp = false;
+    } else {
+        TY_STATUS status = camera.SetRGBExposureTime(val);
+        std::cout << "set rgb exposure time : " << val << ",  ret = " << status << std::endl;
+    }
     
     bool process_exit = false;
     TYFrameParser parser;
@@ -99,7 +111,14 @@ int main(int argc, char* argv[])
     
     while(!process_exit) {
         auto frame = camera.tryGetFrames(2000);
-        if(frame) parser.update(frame);
+        if(!frame) continue;
+        if(auto_exp && frame->colorImage()) {
+            bool changed = false;
+            if(ae.update(*frame->colorImage()->image(), &changed) == TY_STATUS_OK && changed) {
+                std::cout << "luma " << ae.measured() << " -> exposure " << ae.exposure() << ", gain " << ae.gain() << std::endl;
+            }
+        }
+        parser.update(frame);
     }
     
     std::cout << "Main done!" << std::endl;
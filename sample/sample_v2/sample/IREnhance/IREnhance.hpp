@@ -60,8 +60,7 @@ public:
             cv::Rect roi = cv::Rect(int(cols * ratiocut), int(rows * ratiocut), int(cols - cols * ratiocut * 2), int(rows - rows * ratiocut * 2));
             cv::minMaxLoc(grayIR(roi), &minVal, &maxVal);
             grayIR.convertTo(result, CV_8UC1, 255.0 / (maxVal - minVal), -minVal * 255.0 / (maxVal - minVal));
-            _image = std::shared_ptr<TYImage>(new TYImage(grayIR.cols, grayIR.rows, comp_id, TY_PIXEL_FORMAT_MONO, result.size().area()));
-            memcpy(_image->buffer(), result.data, result.size().area());
+            _image = imageFromCvMat(result, comp_id, TY_PIXEL_FORMAT_MONO);
         }
         else {
             LOGD("linearStretch support CV_8UC1 or CV_16UC1 gray,not support others type,please check grayIR type");
@@ -93,13 +92,11 @@ public:
         cv::Mat result;
         if (type_ir == CV_16UC1) {
             grayIR.convertTo(result, CV_8UC1, multi_expandratio / 255.0);
-            _image = std::shared_ptr<TYImage>(new TYImage(grayIR.cols, grayIR.rows, comp_id, TY_PIXEL_FORMAT_MONO, result.size().area()));
-            memcpy(_image->buffer(), result.data, result.size().area());
+            _image = imageFromCvMat(result, comp_id, TY_PIXEL_FORMAT_MONO);
         }
         else if (type_ir == CV_8UC1) {
-            grayIR.convertTo(result, CV_8UC1, multi_expandratio);
-            //image size not changed, use org buffer and _image
-            memcpy(_image->buffer(), result.data, _image->size());
+            //image size not changed, convert in place on org buffer and _image
+            grayIR.convertTo(grayIR, CV_8UC1, multi_expandratio);
         }
         else {
             LOGD("linearStretch_multi support CV_8UC1 or CV_16UC1 gray,not support others type,please check grayIR type");
@@ -141,8 +138,7 @@ public:
             double minVal, maxVal;
             cv::minMaxLoc(grayIR, &minVal, &maxVal);
             grayIR.convertTo(result, CV_8UC1, 255.0 / use_norm);
-            _image = std::shared_ptr<TYImage>(new TYImage(grayIR.cols, grayIR.rows, comp_id, TY_PIXEL_FORMAT_MONO, result.size().area()));
-            memcpy(_image->buffer(), result.data, result.size().area());
+            _image = imageFromCvMat(result, comp_id, TY_PIXEL_FORMAT_MONO);
         }
         else {
             LOGD("GrayIR_linearStretch_std support CV_8UC1 or CV_16UC1 gray,not support others type,please check grayIR type");
@@ -209,8 +205,7 @@ public:
             LOGD("GrayIR_linearStretch_std support CV_8UC1 or CV_16UC1 gray,not support others type,please check grayIR type");
             return -1;
         }
-        _image = std::shared_ptr<TYImage>(new TYImage(grayIR.cols, grayIR.rows, comp_id, TY_PIXEL_FORMAT_MONO, result.size().area()));
-        memcpy(_image->buffer(), result.data, result.size().area());
+        _image = imageFromCvMat(result, comp_id, TY_PIXEL_FORMAT_MONO);
         return 0;
     }
     double log_expandratio = 6;
@@ -247,8 +242,7 @@ public:
             LOGD("GrayIR_linearStretch_std support CV_8UC1 or CV_16UC1 gray,not support others type,please check grayIR type");
             return -1;
         }
-        _image = std::shared_ptr<TYImage>(new TYImage(grayIR.cols, grayIR.rows, comp_id, TY_PIXEL_FORMAT_MONO, result.size().area()));
-        memcpy(_image->buffer(), result.data, result.size().area());
+        _image = imageFromCvMat(result, comp_id, TY_PIXEL_FORMAT_MONO);
         return 0;
     }
 };
@@ -14,6 +14,7 @@
 #endif
 
 #include "TYApi.h"
+#include "funny_jpeg.hpp"
 
 inline void ensure_directory_exists(const std::string &path) {
 	if (path.empty()) {
@@ -108,7 +109,8 @@ inline bool dump_rgb_bgr_txt(const std::string &file_path, const uint8_t *data,
 	return true;
 }
 
-inline bool convert_to_bgr_buffer(const uint8_t *src, int width, int height, TY_PIXEL_FORMAT format, std::vector<uint8_t> &dst) {
+// src_size只有JPEG/MJPG需要(压缩数据长度)，未知时为0，此时不解码
+inline bool convert_to_bgr_buffer(const uint8_t *src, int width, int height, TY_PIXEL_FORMAT format, std::vector<uint8_t> &dst, size_t src_size = 0) {
 	if (!src || width <= 0 || height <= 0) {
 		return false;
 	}
@@ -153,6 +155,14 @@ inline bool convert_to_bgr_buffer(const uint8_t *src, int width, int height, TY_
 			}
 			return true;
 		}
+		case TY_PIXEL_FORMAT_JPEG:
+		case TY_PIXEL_FORMAT_MJPG: {
+			FunnyJpegInfo info;
+			if (!src_size || !funny_jpeg_info(src, src_size, info) || info.width != width || info.height != height) {
+				return false;
+			}
+			return funny_jpeg_decode(src, src_size, 1, dst.data(), width * 3);
+		}
 		default:
 			break;
 	}
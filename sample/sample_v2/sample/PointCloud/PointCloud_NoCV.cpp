@@ -6,6 +6,7 @@
 #include "TYImageProc.h"
 #include "TyIsp.h"
 #include "DebugDump.h"
+#include "TYColorStage.hpp"
 #include <cstring>
 
 // RGBD配准函数：将彩色图像映射到深度坐标系
@@ -504,7 +505,7 @@ static bool processRgbImage(TY_DEV_HANDLE device, TY_ISP_HANDLE colorISP,
     // 简化处理：直接使用或转换RGB数据
     TY_STATUS status = TY_STATUS_OK;
     std::vector<uint8_t> tempBgr;
-    if (convert_to_bgr_buffer(static_cast<uint8_t*>(rgbImage->buffer), rgbImage->width, rgbImage->height, rgbImage->pixelFormat, tempBgr)) {
+    if (convert_to_bgr_buffer(static_cast<uint8_t*>(rgbImage->buffer), rgbImage->width, rgbImage->height, rgbImage->pixelFormat, tempBgr, rgbImage->size)) {
         memcpy(*rgbData, tempBgr.data(), tempBgr.size());
     } else if (colorISP) {
         // 尝试使用ISP进行简单处理
@@ -540,10 +541,28 @@ static bool processRgbImage(TY_DEV_HANDLE device, TY_ISP_HANDLE colorISP,
 
 
 
+// 融合处理不可用时的回退：先在原始格式上去畸变(colorCalib非空时)，再转换为BGR
+static bool decodeUndistortedColor(TY_DEV_HANDLE device, TY_ISP_HANDLE colorISP, TY_IMAGE_DATA* rgbImage,
+                                   const TY_CAMERA_CALIB_INFO* colorCalib, uint8_t** rgbData) {
+    if (!colorCalib) {
+        return processRgbImage(device, colorISP, rgbImage, rgbData);
+    }
+    TY_IMAGE_DATA undistortedRgb = *rgbImage;
+    std::vector<uint8_t> undistortedBuffer(rgbImage->size);
+    undistortedRgb.buffer = undistortedBuffer.data();
+    TY_STATUS status = TYUndistortImage(colorCalib, rgbImage, NULL, &undistortedRgb);
+    if (status != TY_STATUS_OK) {
+        printf("Color image undistortion failed: %d (%s)\n", status, TYErrorString(status));
+        return false;
+    }
+    return processRgbImage(device, colorISP, &undistortedRgb, rgbData);
+}
+
 // 处理深度图像并生成点云
+// colorStage按数据流持有，查找表跨帧复用，标定或去畸变开关变化时自动重建
 static bool processDepthImageAndGeneratePointCloud(TY_DEV_HANDLE device, TY_IMAGE_DATA* depthImage, 
                                                   TY_IMAGE_DATA* rgbImage, bool colorEnabled, 
-                                                  TY_ISP_HANDLE colorISP) {
+                                                  TY_ISP_HANDLE colorISP, TYColorStage& colorStage) {
     if (!depthImage) {
         printf("No depth image found in the frame\n");
         return false;
@@ -579,20 +598,24 @@ static bool processDepthImageAndGeneratePointCloud(TY_DEV_HANDLE device, TY_IMAG
         
         if (rgbImage && colorEnabled) {
             std::vector<uint8_t> rawCameraBgr;
-            if (convert_to_bgr_buffer(static_cast<uint8_t*>(rgbImage->buffer), rgbImage->width, rgbImage->height, rgbImage->pixelFormat, rawCameraBgr)) {
+            if (convert_to_bgr_buffer(static_cast<uint8_t*>(rgbImage->buffer), rgbImage->width, rgbImage->height, rgbImage->pixelFormat, rawCameraBgr, rgbImage->size)) {
                 dump_rgb_bgr_txt(debugDir + "/rgb_sensor_input" + frameSuffix + ".txt",
                     rawCameraBgr.data(), rgbImage->width, rgbImage->height,
                     "RGB sensor data converted to BGR (before processing)");
             }
-            if (processRgbImage(device, colorISP, rgbImage, &rgbData)) {
+            // YUYV/YVYU/RGB/BGR的解码、去畸变与缩放放到后面的TYColorStage中一次完成，这里不做全分辨率解码
+            bool fusedColor = TYColorStage::supports(rgbImage->pixelFormat);
+            if (fusedColor || processRgbImage(device, colorISP, rgbImage, &rgbData)) {
                 // 检查图像尺寸对齐
                 checkImageAlignment(depthImage, rgbImage, "before_registration");
                 
-                // 验证初始RGB数据
-                validateRgbData(rgbData, rgbImage->width, rgbImage->height, "initial_rgb");
-                dump_rgb_bgr_txt(debugDir + "/rgb_after_initial_convert" + frameSuffix + ".txt",
-                    rgbData, rgbImage->width, rgbImage->height,
-                    "RGB data after initial conversion (before undistort)");
+                if (rgbData) {
+                    // 验证初始RGB数据
+                    validateRgbData(rgbData, rgbImage->width, rgbImage->height, "initial_rgb");
+                    dump_rgb_bgr_txt(debugDir + "/rgb_after_initial_convert" + frameSuffix + ".txt",
+                        rgbData, rgbImage->width, rgbImage->height,
+                        "RGB data after initial conversion (before undistort)");
+                }
             // 获取深度和彩色相机校准信息
             TY_CAMERA_CALIB_INFO depthCalib, colorCalib;
             status = TYGetStruct(device, TY_COMPONENT_DEPTH_CAM, TY_STRUCT_CAM_CALIB_DATA, &depthCalib, sizeof(depthCalib));
@@ -651,7 +674,7 @@ static bool processDepthImageAndGeneratePointCloud(TY_DEV_HANDLE device, TY_IMAG
             TY_IMAGE_DATA* finalRgbImage = rgbImage;
             bool colorUndistortionSuccess = false;
             
-            if (colorNeedUndistort) {
+            if (colorNeedUndistort && !fusedColor) {
                 TY_IMAGE_DATA undistortedRgb = *rgbImage;
                 undistortedRgbBuffer = (uint8_t*)malloc(rgbImage->size);
                 if (undistortedRgbBuffer) {
@@ -808,24 +831,40 @@ static bool processDepthImageAndGeneratePointCloud(TY_DEV_HANDLE device, TY_IMAG
             }
             
             // 将RGB数据从rgbImage尺寸调整到点云尺寸（dstW x dstH）
-            // 使用双线性插值或最近邻插值
-            for (int y = 0; y < dstH; y++) {
-                for (int x = 0; x < dstW; x++) {
-                    // 计算源RGB图像中的坐标
-                    int srcX = (x * rgbImage->width) / dstW;
-                    int srcY = (y * rgbImage->height) / dstH;
+            // 原始格式可直接处理时，解码、去畸变和缩放在一次遍历中完成，查找表跨帧复用
+            colorStage.configure(colorNeedUndistort ? &colorCalib : NULL, dstW, dstH);
+            if (fusedColor && colorStage.process(*rgbImage, registeredRgbData) == TY_STATUS_OK) {
+                printf("Color image decoded, undistorted and resized in one pass\n");
+            } else {
+                // 融合处理失败时前面没有解码，按原流程去畸变后再解码
+                if (!rgbData && !decodeUndistortedColor(device, colorISP, rgbImage,
+                                                        colorNeedUndistort ? &colorCalib : NULL, &rgbData)) {
+                    printf("Failed to process RGB image\n");
+                    free(pointCloud);
+                    free(registeredRgbData);
+                    free(undistortedRgbBuffer);
+                    free(registeredDepthBuffer);
+                    return false;
+                }
+                // 最近邻缩放已转换好的BGR数据
+                for (int y = 0; y < dstH; y++) {
+                    for (int x = 0; x < dstW; x++) {
+                        // 计算源RGB图像中的坐标
+                        int srcX = (x * rgbImage->width) / dstW;
+                        int srcY = (y * rgbImage->height) / dstH;
                     
-                    // 确保坐标在有效范围内
-                    if (srcX >= rgbImage->width) srcX = rgbImage->width - 1;
-                    if (srcY >= rgbImage->height) srcY = rgbImage->height - 1;
+                        // 确保坐标在有效范围内
+                        if (srcX >= rgbImage->width) srcX = rgbImage->width - 1;
+                        if (srcY >= rgbImage->height) srcY = rgbImage->height - 1;
                     
-                    int srcIdx = (srcY * rgbImage->width + srcX) * 3;
-                    int dstIdx = (y * dstW + x) * 3;
+                        int srcIdx = (srcY * rgbImage->width + srcX) * 3;
+                        int dstIdx = (y * dstW + x) * 3;
                     
-                    // 复制BGR数据
-                    registeredRgbData[dstIdx] = rgbData[srcIdx];     // Blue
-                    registeredRgbData[dstIdx + 1] = rgbData[srcIdx + 1]; // Green
-                    registeredRgbData[dstIdx + 2] = rgbData[srcIdx + 2]; // Red
+                        // 复制BGR数据
+                        registeredRgbData[dstIdx] = rgbData[srcIdx];     // Blue
+                        registeredRgbData[dstIdx + 1] = rgbData[srcIdx + 1]; // Green
+                        registeredRgbData[dstIdx + 2] = rgbData[srcIdx + 2]; // Red
+                    }
                 }
             }
             
@@ -922,7 +961,8 @@ static bool processDepthImageAndGeneratePointCloud(TY_DEV_HANDLE device, TY_IMAG
 }
 
 // 处理捕获的帧数据
-static bool processCapturedFrame(TY_DEV_HANDLE device, bool colorEnabled, TY_ISP_HANDLE colorISP) {
+static bool processCapturedFrame(TY_DEV_HANDLE device, bool colorEnabled, TY_ISP_HANDLE colorISP,
+                                 TYColorStage& colorStage) {
     // 获取一帧数据
     TY_FRAME_DATA frame;
     TY_STATUS status = TYFetchFrame(device, &frame, 3000); // 增加超时时间到3秒
@@ -945,7 +985,7 @@ static bool processCapturedFrame(TY_DEV_HANDLE device, bool colorEnabled, TY_ISP
     }
     
     // 处理深度图像并生成点云
-    processDepthImageAndGeneratePointCloud(device, depthImage, rgbImage, colorEnabled, colorISP);
+    processDepthImageAndGeneratePointCloud(device, depthImage, rgbImage, colorEnabled, colorISP, colorStage);
     
     // 释放帧数据
     TYEnqueueBuffer(device, frame.userBuffer, frame.bufferSize);
@@ -1042,8 +1082,9 @@ int main() {
         }
         printf("Capture started\n");
         
-        // 7. 处理捕获的帧数据
-        processCapturedFrame(device, colorEnabled, colorISP);
+        // 7. 处理捕获的帧数据；彩色融合处理的查找表随本数据流保存
+        TYColorStage colorStage;
+        processCapturedFrame(device, colorEnabled, colorISP, colorStage);
         
         // 8. 停止采集
         status = TYStopCapture(device);
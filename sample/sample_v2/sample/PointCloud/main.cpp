@@ -7,6 +7,7 @@
 #include "Device.hpp"
 #include "TYImageProc.h"
 #include "TyIsp.h"
+#include "TYColorStage.hpp"
 #include "../../../include/TYDefs.h"
 #include "../../../include/TYApi.h"
 #include "../../../include/TYCoordinateMapper.h"
@@ -62,6 +63,8 @@ class P3DCamera : public FastCamera
         TY_CAMERA_CALIB_INFO depth_calib, color_calib;
         std::shared_ptr<ImageProcesser> depth_processer;
         std::shared_ptr<ImageProcesser> color_processer;
+        TYColorStage color_stage;
+        std::shared_ptr<TYImage> undistortColor(const std::shared_ptr<TYImage>& color);
         void savePointsToPly(const std::vector<TY_VECT_3F>& p3d, const std::shared_ptr<TYImage>& color, const char* fileName);
         void processDepth16(const std::shared_ptr<TYImage>&  depth, std::vector<TY_VECT_3F>& p3d);
         void processXYZ48(const std::shared_ptr<TYImage>&  depth, std::vector<TY_VECT_3F>& p3d);
@@ -245,6 +248,29 @@ void P3DCamera::processXYZ48(const std::shared_ptr<TYImage>&  depth, std::vector
     }
 }
 
+std::shared_ptr<TYImage> P3DCamera::undistortColor(const std::shared_ptr<TYImage>& color)
+{
+    if(!color_processer) return nullptr;
+
+    if(TYColorStage::supports(color->pixelFormat())) {
+        // 解码与去畸变合并为一次遍历，不产生中间图
+        if(color_stage.width() != color->width() || color_stage.height() != color->height())
+            color_stage.configure(&color_calib, color->width(), color->height());
+        std::shared_ptr<TYImage> bgr = std::shared_ptr<TYImage>(new TYImage(color->width(), color->height(),
+                                                            color->componentID(),
+                                                            TY_PIXEL_FORMAT_BGR,
+                                                            3 * color->width() * color->height()));
+        if(TY_STATUS_OK == color_stage.process(*color->image(), static_cast<uint8_t*>(bgr->buffer())))
+            return bgr;
+        return nullptr;
+    }
+
+    color_processer->parse(color);
+    if(TY_STATUS_OK == color_processer->doUndistortion())
+        return color_processer->image();
+    return nullptr;
+}
+
 void P3DCamera::processDepth16ToPoint3D(const std::shared_ptr<TYImage>&  depth, const std::shared_ptr<TYImage>&  color, std::vector<TY_VECT_3F>& p3d, std::shared_ptr<TYImage>& registration_color)
 {
     if(!depth) return;
@@ -253,33 +279,28 @@ void P3DCamera::processDepth16ToPoint3D(const std::shared_ptr<TYImage>&  depth,
     if(depth_needUndistort)
         depth_processer->doUndistortion();
         
-    if(color) {
-        color_processer->parse(color);
-        if(TY_STATUS_OK == color_processer->doUndistortion()) {
-            //do rgbd registration
-            const std::shared_ptr<TYImage>& depth_image = depth_processer->image();
-            const std::shared_ptr<TYImage>& color_image = color_processer->image();
-            int dstW = depth_image->width();
-            int dstH = depth_image->width() * color_image->height() / color_image->width();
-            std::shared_ptr<TYImage> registration_depth = std::shared_ptr<TYImage>(new TYImage(dstW, dstH, 
-                                                                depth_image->componentID(), 
-                                                                static_cast<TY_PIXEL_FORMAT>(TY_PIXEL_FORMAT_DEPTH16), 
-                                                                sizeof(uint16_t) * dstW * dstH));
-
-            TYMapDepthImageToColorCoordinate(
-                &depth_calib,
-                depth_image->width(), depth_image->height(), static_cast<const uint16_t*>(depth_image->buffer()),
-                &color_calib,
-                registration_depth->width(), registration_depth->height(), static_cast<uint16_t*>(registration_depth->buffer()), f_depth_scale_unit
-            );
-            registration_depth->resize(color_image->width(), color_image->height());
-            registration_color = color_image;
-            p3d.resize(registration_depth->width() * registration_depth->height());
-            TYMapDepthImageToPoint3d(&color_calib, registration_depth->width(), registration_depth->height()
-                , (uint16_t*)registration_depth->buffer(), &p3d[0], f_depth_scale_unit);
-        } else {
-            processDepth16(depth_processer->image(), p3d);
-        }
+    std::shared_ptr<TYImage> color_image = color ? undistortColor(color) : nullptr;
+    if(color_image) {
+        //do rgbd registration
+        const std::shared_ptr<TYImage>& depth_image = depth_processer->image();
+        int dstW = depth_image->width();
+        int dstH = depth_image->width() * color_image->height() / color_image->width();
+        std::shared_ptr<TYImage> registration_depth = std::shared_ptr<TYImage>(new TYImage(dstW, dstH, 
+                                                            depth_image->componentID(), 
+                                                            static_cast<TY_PIXEL_FORMAT>(TY_PIXEL_FORMAT_DEPTH16), 
+                                                            sizeof(uint16_t) * dstW * dstH));
+
+        TYMapDepthImageToColorCoordinate(
+            &depth_calib,
+            depth_image->width(), depth_image->height(), static_cast<const uint16_t*>(depth_image->buffer()),
+            &color_calib,
+            registration_depth->width(), registration_depth->height(), static_cast<uint16_t*>(registration_depth->buffer()), f_depth_scale_unit
+        );
+        registration_depth->resize(color_image->width(), color_image->height());
+        registration_color = color_image;
+        p3d.resize(registration_depth->width() * registration_depth->height());
+        TYMapDepthImageToPoint3d(&color_calib, registration_depth->width(), registration_depth->height()
+            , (uint16_t*)registration_depth->buffer(), &p3d[0], f_depth_scale_unit);
     } else {
         processDepth16(depth_processer->image(), p3d);
     }
@@ -289,25 +310,19 @@ void P3DCamera::processXYZ48ToPoint3D(const std::shared_ptr<TYImage>&  depth, co
 {
     if(!depth) return;
     
-    if(color) {
-        color_processer->parse(color);
-        if(TY_STATUS_OK == color_processer->doUndistortion()) {
-            registration_color = color_processer->image();
-
-            processXYZ48(depth, p3d);
-
-            TY_CAMERA_EXTRINSIC extri_inv;
-            TYInvertExtrinsic(&color_calib.extrinsic, &extri_inv);
-            TYMapPoint3dToPoint3d(&extri_inv, p3d.data(), p3d.size(), p3d.data());
-
-            std::vector<uint16_t> mappedDepth(registration_color->width() * registration_color->height());
-            TYMapPoint3dToDepthImage(&color_calib, p3d.data(), depth->width() * depth->height(),  registration_color->width(), registration_color->height(), mappedDepth.data(), f_depth_scale_unit);
-            p3d.resize(registration_color->width() * registration_color->height());
-            TYMapDepthImageToPoint3d(&color_calib, registration_color->width(), registration_color->height()
-                , mappedDepth.data(), &p3d[0], f_depth_scale_unit);
-        } else {
-            processXYZ48(depth, p3d);
-        }
+    registration_color = color ? undistortColor(color) : nullptr;
+    if(registration_color) {
+        processXYZ48(depth, p3d);
+
+        TY_CAMERA_EXTRINSIC extri_inv;
+        TYInvertExtrinsic(&color_calib.extrinsic, &extri_inv);
+        TYMapPoint3dToPoint3d(&extri_inv, p3d.data(), p3d.size(), p3d.data());
+
+        std::vector<uint16_t> mappedDepth(registration_color->width() * registration_color->height());
+        TYMapPoint3dToDepthImage(&color_calib, p3d.data(), depth->width() * depth->height(),  registration_color->width(), registration_color->height(), mappedDepth.data(), f_depth_scale_unit);
+        p3d.resize(registration_color->width() * registration_color->height());
+        TYMapDepthImageToPoint3d(&color_calib, registration_color->width(), registration_color->height()
+            , mappedDepth.data(), &p3d[0], f_depth_scale_unit);
     } else {
         processXYZ48(depth, p3d);
     }
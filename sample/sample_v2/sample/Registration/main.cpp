@@ -1,10 +1,28 @@
 #include "Device.hpp"
 #include "TYCoordinateMapper.h"
+#include "TYImageProc.h"
 
 #define MAP_DEPTH_TO_COLOR  1
 
 using namespace percipio_layer;
 
+// 内参按图像尺寸缩放(畸变系数与尺寸无关)，用于缩小解码后的彩色图
+static TY_CAMERA_CALIB_INFO scaledCalib(const TY_CAMERA_CALIB_INFO& calib, int w, int h)
+{
+    TY_CAMERA_CALIB_INFO out = calib;
+    if (calib.intrinsicWidth > 0 && calib.intrinsicHeight > 0) {
+        float sx = static_cast<float>(w) / calib.intrinsicWidth;
+        float sy = static_cast<float>(h) / calib.intrinsicHeight;
+        out.intrinsic.data[0] *= sx;
+        out.intrinsic.data[2] *= sx;
+        out.intrinsic.data[4] *= sy;
+        out.intrinsic.data[5] *= sy;
+        out.intrinsicWidth = w;
+        out.intrinsicHeight = h;
+    }
+    return out;
+}
+
 class RegistrationParser: public TYFrameParser {
 public:
     int setCalibInfo(TY_CAMERA_CALIB_INFO &dep, TY_CAMERA_CALIB_INFO &rgb)
@@ -28,7 +46,8 @@ public:
             stream[TY_COMPONENT_IR_CAM_RIGHT]->parse(right_ir);
         }
         
-        if (color) {
+        // 配准结果会替换彩色显示图时，不需要的全分辨率解码和去畸变直接跳过
+        if (color && needFullColor(color)) {
             stream[TY_COMPONENT_RGB_CAM]->parse(color);
             if (color_needUndistort) {
                 stream[TY_COMPONENT_RGB_CAM]->doUndistortion();
@@ -47,6 +66,7 @@ public:
         return 0;
     }
     virtual int doRegistration(const std::shared_ptr<TYImage>& dep, const std::shared_ptr<TYImage>& rgb) = 0;
+    virtual bool needFullColor(const std::shared_ptr<TYImage>&) { return true; }
 
     TY_CAMERA_CALIB_INFO depth_calib, color_calib;
     float f_depth_scale_unit = 1.f;
@@ -56,6 +76,22 @@ public:
 
 class RGB2DepParser: public RegistrationParser {
 public:
+    // 需要解码的彩色格式在doRegistration中按深度图分辨率缩小解码
+    bool needFullColor(const std::shared_ptr<TYImage>& color)
+    {
+        switch(color->pixelFormat())
+        {
+            case TY_PIXEL_FORMAT_RGB:
+            case TY_PIXEL_FORMAT_BGR:
+            case TY_PIXEL_FORMAT_RGB48:
+            case TY_PIXEL_FORMAT_MONO:
+            case TY_PIXEL_FORMAT_MONO16:
+                return true;
+            default:
+                return false;
+        }
+    }
+
     int doRegistration(const std::shared_ptr<TYImage>& depth, const std::shared_ptr<TYImage>& color)
     {
         TY_PIXEL_FORMAT color_fmt = color->pixelFormat();
@@ -103,8 +139,40 @@ public:
                     static_cast<uint16_t*>(dst->buffer()),
                     f_depth_scale_unit);
                 break;
-            default:
+            default: {
+                //only depth resolution color is sampled, decode yuv/bayer/jpeg color directly at reduced size
+                funny_Mat bgr;
+                int scale = reducedScaleFor(color->width(), color->height(), depth->width(), depth->height());
+                if (parseColorFrameReduced(color->image(), &bgr, scale) != 0) {
+                    break;
+                }
+                if (color_needUndistort) {
+                    // 缩小后的图像用按比例缩放的内参去畸变
+                    TY_CAMERA_CALIB_INFO calib = scaledCalib(color_calib, bgr.cols(), bgr.rows());
+                    funny_Mat undistorted(bgr.rows(), bgr.cols(), CV_8UC3);
+                    TY_IMAGE_DATA src, out;
+                    memset(&src, 0, sizeof(src));
+                    src.width = bgr.cols();
+                    src.height = bgr.rows();
+                    src.size = static_cast<int32_t>(bgr.dataSize());
+                    src.pixelFormat = TY_PIXEL_FORMAT_BGR;
+                    src.buffer = bgr.data();
+                    out = src;
+                    out.buffer = undistorted.data();
+                    if (TYUndistortImage(&calib, &src, NULL, &out) == TY_STATUS_OK) {
+                        bgr = std::move(undistorted);
+                    }
+                }
+                dst = std::shared_ptr<TYImage>(new TYImage(depth->width(), depth->height(), color->componentID(), TY_PIXEL_FORMAT_BGR, 3 * depth->width() * depth->height()));
+                TYMapRGBImageToDepthCoordinate(
+                    &depth_calib,
+                    depth->width(), depth->height(), static_cast<const uint16_t*>(depth->buffer()),
+                    &color_calib,
+                    bgr.cols(), bgr.rows(), bgr.data(),
+                    static_cast<uint8_t*>(dst->buffer()),
+                    f_depth_scale_unit);
                 break;
+            }
         }
         stream[TY_COMPONENT_RGB_CAM]->parse(dst);
         return 0;
@@ -1,4 +1,5 @@
 #include "Device.hpp"
+#include "FrameAssembler.hpp"
 
 using namespace percipio_layer;
 
@@ -11,25 +12,30 @@ class StreamAsyncCamera : public FastCamera
         TY_STATUS Init(bool color_en, bool depth_en, bool ir_en, bool resend_en);
 
         uint32_t streams = 0;
+        TY_COMPONENT_ID components = 0;
 };
 
 TY_STATUS StreamAsyncCamera::Init(bool color_en, bool depth_en, bool ir_en, bool resend_en)
 {
     TY_COMPONENT_ID allComps;
     streams = 0;
+    components = 0;
     ASSERT_OK( TYGetComponentIDs(handle(), &allComps) );
     if(allComps & TY_COMPONENT_RGB_CAM  && color_en) {
         streams |= FastCamera::stream_idx::stream_color;
+        components |= TY_COMPONENT_RGB_CAM;
         stream_enable(FastCamera::stream_idx::stream_color);
     }
     
     if (depth_en) {
         streams |= FastCamera::stream_idx::stream_depth;
+        components |= TY_COMPONENT_DEPTH_CAM;
         stream_enable(FastCamera::stream_idx::stream_depth);
     }
 
     if (ir_en) {
         streams |= FastCamera::stream_idx::stream_ir_left;
+        components |= TY_COMPONENT_IR_CAM_LEFT;
         stream_enable(FastCamera::stream_idx::stream_ir_left);
     }
 
@@ -102,7 +108,11 @@ int main(int argc, char* argv[])
         return -1;
     }
 
-    int32_t stream_expect = sync_cam.streams;
+    // 各分量异步到达，按imageIndex拼成完整帧；超时未到齐的分量以不完整帧输出
+    FrameAssembler assembler(sync_cam.components, FrameAssembler::MatchImageIndex);
+    assembler.setDeadline(1000);
+    assembler.setEmitPartial(true);
+
     std::cout << "=== Send Soft Trigger" << std::endl;
     int err = TY_STATUS_OK;
     while(TY_STATUS_BUSY == (err = TYSendSoftTrigger(sync_cam.handle())));
@@ -120,11 +130,20 @@ int main(int argc, char* argv[])
     }
 
     int index = 0;
+    std::vector<std::shared_ptr<TYFrame>> frames;
     
     while(!process_exit) {
-        auto frame = sync_cam.tryGetFrames(2000);
-        if(frame) {
-            std::cout << "=== Get frame " << ++index << std::endl;
+        frames.clear();
+        auto part = sync_cam.tryGetFrames(2000);
+        if(part) {
+            assembler.push(part, frames);
+        } else {
+            assembler.poll(frames);
+        }
+
+        for (auto& frame : frames) {
+            bool complete = (frame->components() & sync_cam.components) == sync_cam.components;
+            std::cout << "=== Get frame " << ++index << (complete ? "" : " (partial)") << std::endl;
             parser.update(frame);
             auto color = frame->colorImage();
             auto depth = frame->depthImage();
@@ -132,40 +151,35 @@ int main(int argc, char* argv[])
             if(color) {
                 void *  image_pos  = color->buffer();
                 int32_t image_size = color->height() * TYPixelLineSize(color->width(), color->pixelFormat());
-                stream_expect &= ~FastCamera::stream_idx::stream_color;
                 std::cout << "===   Image (RGB   , " <<  color->timestamp() << ", " << image_pos << ", "<<  image_size << ")" << std::endl;
             }
 
             if(depth) {
                 void *  image_pos  = depth->buffer();
                 int32_t image_size = depth->height() * TYPixelLineSize(depth->width(), depth->pixelFormat());
-                stream_expect &= ~FastCamera::stream_idx::stream_depth;
                 std::cout << "===   Image (DEPTH   , " <<  depth->timestamp() << ", " << image_pos << ", "<<  image_size << ")" << std::endl;
             }
 
             if(ir) {
                 void *  image_pos  = ir->buffer();
                 int32_t image_size = ir->height() * TYPixelLineSize(ir->width(), ir->pixelFormat());
-                stream_expect &= ~FastCamera::stream_idx::stream_ir_left;
                 std::cout << "===   Image (LEFT_IR   , " <<  ir->timestamp() << ", " << image_pos << ", "<<  image_size << ")" << std::endl;
             }
 
-            if (stream_expect == 0) {
-                stream_expect = sync_cam.streams;
-                std::cout << "=== Send Soft Trigger" << std::endl;
-                while(TY_STATUS_BUSY == (err = TYSendSoftTrigger(sync_cam.handle())));
-                if (err != TY_STATUS_OK) {
-                    /*
-                     * Sometime we got other errors
-                     *     -1005 before 3.6.53 indicate trigger cmd timeout
-                     *     new sdk will return -1014 when trigger cmd timeout
-                     * If we got a timeout err, we do not know whether the
-                     * deivce missed the cmd or the app missied the ack.
-                     * We'd better restart the capture
-                     */
-                    LOGD("SendSoftTrigger failed with err(%d):%s\n", err, TYErrorString(err));
-                    break;
-                }
+            std::cout << "=== Send Soft Trigger" << std::endl;
+            while(TY_STATUS_BUSY == (err = TYSendSoftTrigger(sync_cam.handle())));
+            if (err != TY_STATUS_OK) {
+                /*
+                 * Sometime we got other errors
+                 *     -1005 before 3.6.53 indicate trigger cmd timeout
+                 *     new sdk will return -1014 when trigger cmd timeout
+                 * If we got a timeout err, we do not know whether the
+                 * deivce missed the cmd or the app missied the ack.
+                 * We'd better restart the capture
+                 */
+                LOGD("SendSoftTrigger failed with err(%d):%s\n", err, TYErrorString(err));
+                process_exit = true;
+                break;
             }
         }
     }